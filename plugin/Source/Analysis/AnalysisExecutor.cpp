@@ -0,0 +1,162 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "Analysis/AnalysisExecutor.h"
+
+namespace nvs::analysis {
+
+namespace {
+constexpr const char *coreBudgetEnvVar = "TSN_ANALYSIS_THREADS";
+constexpr juce::uint32 audioActivityHoldMs = 500;  // how long after the last audio callback we keep backing off
+constexpr auto idleRecheckInterval = std::chrono::milliseconds(50);
+}
+
+class AnalysisExecutor::Worker final : public juce::Thread {
+public:
+    Worker(AnalysisExecutor &owner, const int index)
+    :   juce::Thread("AnalysisExecutor " + juce::String(index))
+    ,   _owner(owner)
+    ,   _index(index)
+    {}
+    void run() override { _owner.workerLoop(_index, *this); }
+private:
+    AnalysisExecutor &_owner;
+    const int _index;
+};
+//=============================================================================================================================
+int AnalysisExecutor::defaultCoreBudget() {
+    if (const auto env = juce::SystemStats::getEnvironmentVariable(coreBudgetEnvVar, {}); env.getIntValue() > 0) {
+        return env.getIntValue();
+    }
+    return std::max(1, juce::SystemStats::getNumPhysicalCpus() - 1);
+}
+
+AnalysisExecutor::AnalysisExecutor()
+:   _coreBudget(defaultCoreBudget())
+{}
+AnalysisExecutor::~AnalysisExecutor() {
+    {
+        const std::scoped_lock sl(_mutex);
+        jassert(_batches.empty());     // every runBatch caller must have returned
+        _stopping = true;
+        for (auto &w : _workers) {
+            w->signalThreadShouldExit();
+        }
+    }
+    _cv.notify_all();
+    for (auto &w : _workers) {
+        w->stopThread(5000);
+    }
+}
+
+void AnalysisExecutor::setCoreBudget(const int numWorkers) {
+    _coreBudget.store(std::max(1, numWorkers), std::memory_order_relaxed);
+    _cv.notify_all();
+}
+void AnalysisExecutor::setWorkerPriority(const juce::Thread::Priority priority) {
+    const std::scoped_lock sl(_mutex);
+    _workerPriority = priority;
+}
+void AnalysisExecutor::noteAudioCallback(const bool isOfflineRender) noexcept {
+    const auto now = juce::Time::getMillisecondCounter();
+    (isOfflineRender ? _lastOfflineCallbackMs : _lastRealtimeCallbackMs).store(now, std::memory_order_relaxed);
+}
+int AnalysisExecutor::getNumAllowedWorkers() const noexcept {
+    const auto now = juce::Time::getMillisecondCounter();
+    const int budget = getCoreBudget();
+    if (now - _lastOfflineCallbackMs.load(std::memory_order_relaxed) < audioActivityHoldMs) {
+        return 1;   // the host wants every core it can get for the bounce
+    }
+    if (now - _lastRealtimeCallbackMs.load(std::memory_order_relaxed) < audioActivityHoldMs) {
+        return std::max(1, budget / 2);
+    }
+    return budget;
+}
+//=============================================================================================================================
+void AnalysisExecutor::ensureWorkers(const int numWorkers) {
+    while (static_cast<int>(_workers.size()) < numWorkers) {
+        auto &w = _workers.emplace_back(std::make_unique<Worker>(*this, static_cast<int>(_workers.size())));
+        // in the plugin, analysis is background work: never compete with the host's audio threads on priority
+        w->startThread(_workerPriority);
+    }
+}
+bool AnalysisExecutor::claimNextTask(Batch *&batch, size_t &taskIndex) {
+    const auto n = _batches.size();
+    for (size_t k = 0; k < n; ++k) {
+        auto *b = _batches[(_roundRobinCursor + k) % n];
+        if (b->next < b->numTasks && b->running < b->maxConcurrency) {
+            batch = b;
+            taskIndex = b->next++;
+            ++b->running;
+            _roundRobinCursor = (_roundRobinCursor + k + 1) % n;   // the next claim starts with the following client
+            return true;
+        }
+    }
+    return false;
+}
+
+void AnalysisExecutor::runBatch(const void *client, const size_t numTasks, const size_t maxConcurrency,
+                                const std::function<void(size_t)> &task)
+{
+    if (numTasks == 0) {
+        return;
+    }
+    Batch batch {
+        .client = client,
+        .task = &task,
+        .numTasks = numTasks,
+        .maxConcurrency = std::max<size_t>(1, maxConcurrency),
+        .remaining = numTasks
+    };
+    std::unique_lock lock(_mutex);
+    jassert(std::ranges::none_of(_batches, [client](const Batch *b){ return b->client == client; }));
+    ensureWorkers(getCoreBudget());
+    _batches.push_back(&batch);
+    _cv.notify_all();
+
+    _cv.wait(lock, [&batch]{ return batch.remaining == 0; });
+    std::erase(_batches, &batch);
+    if (batch.firstException) {
+        std::rethrow_exception(batch.firstException);
+    }
+}
+
+void AnalysisExecutor::workerLoop(const int workerIndex, const juce::Thread &thread) {
+    std::unique_lock lock(_mutex);
+    while (!_stopping && !thread.threadShouldExit()) {
+        Batch *batch {nullptr};
+        size_t taskIndex {0};
+        if (workerIndex >= getNumAllowedWorkers()) {
+            // the allowance changes with audio activity, not with anything guarded by the mutex, so it is polled on a
+            // timeout; but only while there is work it holds back. otherwise new work, or the end, notifies.
+            if (std::ranges::any_of(_batches, [](const Batch *b){ return b->next < b->numTasks; })) {
+                _cv.wait_for(lock, idleRecheckInterval);
+            } else {
+                _cv.wait(lock);
+            }
+            continue;
+        }
+        if (!claimNextTask(batch, taskIndex)) {
+            _cv.wait(lock);     // a new batch, a finished task (freeing up a batch's maxConcurrency), or the end notifies
+            continue;
+        }
+        lock.unlock();
+        std::exception_ptr exception;
+        try {
+            (*batch->task)(taskIndex);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        lock.lock();
+
+        if (exception && !batch->firstException) {
+            batch->firstException = exception;
+        }
+        --batch->running;
+        --batch->remaining;
+        _cv.notify_all();   // wakes the batch owner if this was the last task, and any worker held back by maxConcurrency
+    }
+}
+
+}   // namespace nvs::analysis
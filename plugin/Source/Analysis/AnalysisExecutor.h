@@ -0,0 +1,73 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include <condition_variable>
+#include <mutex>
+
+namespace nvs::analysis {
+
+/**
+ * Process-wide pool for the parallel parts of analysis, shared by every plugin instance.
+ * Obtain it through juce::SharedResourcePointer<AnalysisExecutor>; it lives as long as any instance holds one.
+ *
+ * Work is submitted as batches of indexed tasks. Workers serve the batches of different clients round-robin, one task
+ * at a time, so one instance analysing a long file cannot starve another. The number of workers allowed to run at once
+ * (the core budget) defaults to one less than the physical core count, may be overridden with the TSN_ANALYSIS_THREADS
+ * environment variable or setCoreBudget(), and is reduced while any instance is processing audio: halved during
+ * realtime playback, and down to a single worker during an offline render.
+ */
+class AnalysisExecutor {
+public:
+    AnalysisExecutor();
+    ~AnalysisExecutor();
+
+    // runs task(0) ... task(numTasks - 1) on the pool, at most maxConcurrency of them at once, and blocks until all have
+    // returned. tasks wanting to be cancellable must check for it themselves. the first exception thrown by any task is
+    // rethrown here once the rest of the batch has finished.
+    void runBatch(const void *client, size_t numTasks, size_t maxConcurrency, const std::function<void(size_t)> &task);
+
+    void setCoreBudget(int numWorkers);
+    // applies to workers started after the call; the plugin keeps the default (low), a standalone process may raise it
+    void setWorkerPriority(juce::Thread::Priority priority);
+    int getCoreBudget() const noexcept { return _coreBudget.load(std::memory_order_relaxed); }
+    // realtime-safe; call from every processBlock
+    void noteAudioCallback(bool isOfflineRender) noexcept;
+
+    static int defaultCoreBudget();
+private:
+    struct Batch {
+        const void *client;
+        const std::function<void(size_t)> *task;
+        size_t numTasks;
+        size_t maxConcurrency;
+        size_t next {0};
+        size_t running {0};
+        size_t remaining;
+        std::exception_ptr firstException {};
+    };
+    class Worker;
+
+    void workerLoop(int workerIndex, const juce::Thread &thread);
+    int getNumAllowedWorkers() const noexcept;
+    bool claimNextTask(Batch *&batch, size_t &taskIndex);   // _mutex must be held
+    void ensureWorkers(int numWorkers);                     // _mutex must be held
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<Batch *> _batches;
+    size_t _roundRobinCursor {0};
+    std::vector<std::unique_ptr<Worker>> _workers;
+    bool _stopping {false};
+    juce::Thread::Priority _workerPriority {juce::Thread::Priority::low};
+
+    std::atomic<int> _coreBudget;
+    std::atomic<juce::uint32> _lastRealtimeCallbackMs {0};
+    std::atomic<juce::uint32> _lastOfflineCallbackMs {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisExecutor)
+};
+
+}   // namespace nvs::analysis
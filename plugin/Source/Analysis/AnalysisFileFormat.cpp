@@ -0,0 +1,174 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "AnalysisFileFormat.h"
+#include "FeatureOperations.h"
+#include "TsnStringAxiom.h"
+
+namespace nvs::analysis {
+
+void addEventwiseStatistics(juce::ValueTree& tree, const EventwiseStatistics<Real>& stats) {
+	tree.setProperty(axiom::mean, stats.mean, nullptr);
+	tree.setProperty(axiom::median, stats.median, nullptr);
+	tree.setProperty(axiom::variance, stats.variance, nullptr);
+	tree.setProperty(axiom::skewness, stats.skewness, nullptr);
+	tree.setProperty(axiom::kurtosis, stats.kurtosis, nullptr);
+}
+EventwiseStatistics<Real> toEventwiseStatistics(juce::ValueTree const &vt){
+	return {
+		.mean = vt.getProperty(axiom::mean),
+		.median = vt.getProperty(axiom::median),
+		.variance = vt.getProperty(axiom::variance),
+		.skewness = vt.getProperty(axiom::skewness),
+		.kurtosis = vt.getProperty(axiom::kurtosis)
+	};
+}
+
+juce::ValueTree timbreSpaceReprToVT(std::vector<FeatureContainer<EventwiseStatisticsF>> const &fullTimbreSpace,
+									std::vector<float> const &normalizedOnsets,
+									const juce::String& waveformHash,
+									const juce::String& audioAbsPath,
+									const FeatureStorage storage){
+	juce::ValueTree vt(axiom::TimbreAnalysis);
+	{
+		juce::ValueTree md(axiom::Metadata);
+		md.setProperty(axiom::Version, ProjectInfo::versionString, nullptr);
+		md.setProperty(axiom::audioHash, waveformHash, nullptr);
+		md.setProperty(axiom::AudioFilePathAbsolute, audioAbsPath, nullptr);
+		md.setProperty(axiom::CreationTime, {}, nullptr);
+		md.setProperty(axiom::AnalysisSettings, {}, nullptr);
+		vt.addChild(md, 0, nullptr);
+	}
+	{
+		juce::var onsetArray;
+		for (auto const &o : normalizedOnsets) {
+			onsetArray.append(o);
+		}
+		vt.setProperty(axiom::NormalizedOnsets, onsetArray, nullptr);
+	}
+	if (storage != nvs::analysis::FeatureStorage::Float32) {
+		// column-quantized; no per-frame children at all
+		vt.addChild(nvs::analysis::QuantizedFeatureStore::fromTimbreSpace(fullTimbreSpace, storage).toValueTree(), 1, nullptr);
+		return vt;
+	}
+	{
+		juce::ValueTree timbreMeasurements("TimbreMeasurements");
+		
+		for (int frameIdx = 0; frameIdx < static_cast<int>(fullTimbreSpace.size()); ++frameIdx){
+			const auto &timbreFrame = fullTimbreSpace[frameIdx];
+			
+			juce::ValueTree frameTree(axiom::Frame);
+			
+			juce::ValueTree bfccsTree(axiom::BFCCs);
+		    {
+			    const auto &bfccs = timbreFrame.bfccs();
+		        for (int bfccIdx = 0; bfccIdx < static_cast<int>(bfccs.size()); ++bfccIdx){
+		            juce::ValueTree bfccTree("BFCC" + juce::String(bfccIdx));
+		            addEventwiseStatistics(bfccTree, bfccs[bfccIdx]);
+		            bfccsTree.addChild(bfccTree, bfccIdx, nullptr);
+		        }
+		    }
+			frameTree.addChild(bfccsTree, -1, nullptr);
+			
+			// Add single-value features
+		    for (auto feature : nvs::util::Iterator<analysis::Feature_e, static_cast<analysis::Feature_e>(analysis::NumBFCC), analysis::Feature_e::f0>()) {
+		        juce::ValueTree featureTree(analysis::toString(feature));
+		        addEventwiseStatistics(featureTree, timbreFrame[feature]);
+		        frameTree.addChild(featureTree, -1, nullptr);
+		    }
+
+			timbreMeasurements.addChild(frameTree, frameIdx, nullptr);
+			
+			vt.addChild(timbreMeasurements, 1, nullptr);
+		}
+	}
+
+	return vt;
+}
+std::vector<FeatureContainer<EventwiseStatisticsF>> valueTreeToTimbreSpace(juce::ValueTree const &vt)
+{
+    using namespace analysis;
+
+	std::vector<FeatureContainer<EventwiseStatisticsF>> timbreSpace;
+	
+	auto timbreMeasurements = vt.getChildWithName(axiom::TimbreMeasurements);
+	if (!timbreMeasurements.isValid())
+		return timbreSpace;
+	
+	// Reserve space for efficiency
+	timbreSpace.reserve(timbreMeasurements.getNumChildren());
+
+    static_assert(static_cast<Feature_e>(0) == Feature_e::bfcc0); // we will be casting ints to Features for the BFCCs
+    static_assert(static_cast<Feature_e>(12) == Feature_e::bfcc12);
+	for (int frameIdx = 0; frameIdx < timbreMeasurements.getNumChildren(); ++frameIdx)
+	{
+		auto frameTree = timbreMeasurements.getChild(frameIdx);
+		FeatureContainer<EventwiseStatisticsF> frame;
+		
+		// Extract BFCCs
+		if (auto bfccsTree = frameTree.getChildWithName(axiom::BFCCs);
+		    bfccsTree.isValid())
+		{
+			for (int bfccIdx = 0; bfccIdx < bfccsTree.getNumChildren(); ++bfccIdx)
+			{
+				auto bfccTree = bfccsTree.getChild(bfccIdx);
+				frame[static_cast<Feature_e>(bfccIdx)] = (toEventwiseStatistics(bfccTree));
+			}
+		}
+		
+		// Extract single-value features
+	    for (auto const feature :  nvs::util::Iterator<Feature_e, static_cast<Feature_e>(NumBFCC), Feature_e::f0>()) {
+	        if (auto featureTree = frameTree.getChildWithName(toString(feature));
+                featureTree.isValid())
+	        {
+	            frame[feature] = toEventwiseStatistics(featureTree);
+	        }
+	    }
+
+		timbreSpace.push_back(std::move(frame));
+	}
+	
+	return timbreSpace;
+}
+
+std::vector<float> valueTreeToNormalizedOnsets(juce::ValueTree const &vt)
+{
+	std::vector<float> normalizedOnsets;
+
+	const auto onsetArray = vt.getProperty(axiom::NormalizedOnsets);
+	if (!onsetArray.isArray())
+		return normalizedOnsets;
+	
+	auto* array = onsetArray.getArray();
+	if (!array)
+		return normalizedOnsets;
+	
+	normalizedOnsets.reserve(array->size());
+	
+	for (auto && e : *array)
+	{
+		normalizedOnsets.push_back(static_cast<float>(e));
+	}
+	
+	return normalizedOnsets;
+}
+
+//=============================================================================================================================
+juce::ValueTree makeAnalysisFileTree(const juce::ValueTree &timbreSpaceTree, const AnalysisFileMetadata &metadata) {
+    auto md = timbreSpaceTree.getChildWithName(axiom::Metadata);
+    jassert(md.isValid());
+    md.setProperty(axiom::sampleFilePath, metadata.sampleFilePath, nullptr);
+    md.setProperty(axiom::sampleRate, metadata.sampleRate, nullptr);
+    md.setProperty(axiom::audioHash, metadata.audioHash, nullptr);
+    md.setProperty(axiom::settingsHash, metadata.settingsHash, nullptr);
+
+    juce::ValueTree analysisVT("super");
+    analysisVT.addChild(timbreSpaceTree, 1, nullptr);
+    return analysisVT;
+}
+juce::ValueTree getAnalysisFileMetadata(const juce::ValueTree &analysisFileTree) {
+    return analysisFileTree.getChildWithName(axiom::TimbreAnalysis).getChildWithName(axiom::Metadata);
+}
+
+}   // namespace nvs::analysis
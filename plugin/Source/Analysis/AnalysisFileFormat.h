@@ -0,0 +1,45 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "Features.h"
+#include "Statistics.h"
+#include "QuantizedFeatureStore.h"
+
+/**
+ * The analysis tree and the .tsb analysis file built around it, independent of TimbreSpace and the processor so that
+ * standalone tools (see tools/batch_analyzer) write exactly what TSNGranularAudioProcessor::loadAnalysisFileFromState
+ * reads.
+ *
+ * An analysis file is a "super" tree holding the TimbreAnalysis tree, whose Metadata child carries the audio and
+ * settings hashes the processor checks before accepting it.
+ */
+namespace nvs::analysis {
+
+using EventwiseStatisticsF = EventwiseStatistics<float>;
+
+void addEventwiseStatistics(juce::ValueTree &tree, const EventwiseStatistics<Real> &stats);
+EventwiseStatistics<Real> toEventwiseStatistics(const juce::ValueTree &vt);
+
+juce::ValueTree timbreSpaceReprToVT(const std::vector<FeatureContainer<EventwiseStatisticsF>> &fullTimbreSpace,
+                                    const std::vector<float> &normalizedOnsets,
+                                    const juce::String &waveformHash,
+                                    const juce::String &audioAbsPath,
+                                    FeatureStorage storage);
+std::vector<FeatureContainer<EventwiseStatisticsF>> valueTreeToTimbreSpace(const juce::ValueTree &vt);
+std::vector<float> valueTreeToNormalizedOnsets(const juce::ValueTree &vt);
+
+struct AnalysisFileMetadata {
+    juce::var sampleFilePath;
+    juce::var sampleRate;
+    juce::String audioHash;
+    juce::String settingsHash;
+};
+// stamps the metadata into timbreSpaceTree (shared, not copied) and wraps it for saving
+juce::ValueTree makeAnalysisFileTree(const juce::ValueTree &timbreSpaceTree, const AnalysisFileMetadata &metadata);
+// the Metadata child of a loaded analysis file; invalid if the file is not one
+juce::ValueTree getAnalysisFileMetadata(const juce::ValueTree &analysisFileTree);
+
+}   // namespace nvs::analysis
@@ -0,0 +1,109 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "Analysis/AnalysisFileWorker.h"
+#include "../../slicer_granular/Source/misc_util_juce.h"
+
+namespace nvs::analysis {
+
+AnalysisFileWorker::AnalysisFileWorker()
+:   juce::Thread("AnalysisFileIO")
+{
+    startThread(juce::Thread::Priority::background);
+}
+AnalysisFileWorker::~AnalysisFileWorker() {
+    signalThreadShouldExit();
+    _wakeUp.signal();
+    stopThread(5000);
+
+    // never silently drop a save the user asked for; loads are pointless once the owner is gone.
+    // completion callbacks are not delivered from here (the weak reference is about to die anyway).
+    const juce::ScopedLock sl(_queueLock);
+    for (auto &request : _queue) {
+        if (request.kind == Request::Kind::Save) {
+            request.onSaved = nullptr;
+            service(request);
+        }
+    }
+    _queue.clear();
+}
+//===============================================================================
+void AnalysisFileWorker::requestSave(const juce::ValueTree &tree, const juce::File &file, const bool useBinary, SaveCallback onComplete) {
+    Request request {Request::Kind::Save, file};
+    request.tree = tree.createCopy();
+    request.useBinary = useBinary;
+    request.onSaved = std::move(onComplete);
+    enqueue(std::move(request));
+}
+void AnalysisFileWorker::requestLoad(const juce::File &file, LoadCallback onComplete) {
+    Request request {Request::Kind::Load, file};
+    request.onLoaded = std::move(onComplete);
+    enqueue(std::move(request));
+}
+int AnalysisFileWorker::getNumPendingRequests() const {
+    const juce::ScopedLock sl(_queueLock);
+    return static_cast<int>(_queue.size());
+}
+void AnalysisFileWorker::enqueue(Request request) {
+    {
+        const juce::ScopedLock sl(_queueLock);
+        _queue.push_back(std::move(request));
+    }
+    _wakeUp.signal();
+}
+//===============================================================================
+void AnalysisFileWorker::run() {
+    while (!threadShouldExit()) {
+        std::optional<Request> request;
+        {
+            const juce::ScopedLock sl(_queueLock);
+            if (!_queue.empty()) {
+                request.emplace(std::move(_queue.front()));
+                _queue.pop_front();
+            }
+        }
+        if (!request.has_value()) {
+            _wakeUp.wait(-1);
+            continue;
+        }
+        service(*request);
+    }
+}
+void AnalysisFileWorker::service(Request &request) {
+    switch (request.kind) {
+        case Request::Kind::Save: {
+            const bool success = request.useBinary
+                ? nvs::util::saveValueTreeToBinary(request.tree, request.file)
+                : nvs::util::saveValueTreeToJSON(request.tree, request.file);
+            if (request.onSaved) {
+                juce::MessageManager::callAsync([weakThis = juce::WeakReference<AnalysisFileWorker>(this),
+                                                 cb = std::move(request.onSaved), success]() {
+                    if (weakThis != nullptr) {
+                        cb(success);
+                    }
+                });
+            }
+            break;
+        }
+        case Request::Kind::Load: {
+            juce::ValueTree loaded {};
+            if (juce::FileInputStream stream(request.file); stream.openedOk()) {
+                loaded = juce::ValueTree::readFromStream(stream);
+            }
+            else {
+                DBG("AnalysisFileWorker: failed to open " << request.file.getFullPathName() << "; "
+                    << stream.getStatus().getErrorMessage());
+            }
+            juce::MessageManager::callAsync([weakThis = juce::WeakReference<AnalysisFileWorker>(this),
+                                             cb = std::move(request.onLoaded), loaded]() {
+                if (weakThis != nullptr && cb) {
+                    cb(loaded);
+                }
+            });
+            break;
+        }
+    }
+}
+
+} // namespace nvs::analysis
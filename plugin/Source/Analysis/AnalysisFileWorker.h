@@ -0,0 +1,54 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include <deque>
+#include <functional>
+
+namespace nvs::analysis {
+
+/**
+ * Background thread that owns all analysis file I/O (.tsb save and load), so that serializing, writing, opening and
+ * parsing never happen on the message thread. Requests are queued in FIFO order and serviced one at a time;
+ * completion callbacks are always delivered on the message thread, and are dropped if the worker has been destroyed
+ * in the meantime.
+ */
+class AnalysisFileWorker final : public juce::Thread
+{
+public:
+    using SaveCallback = std::function<void(bool success)>;
+    using LoadCallback = std::function<void(juce::ValueTree loadedTree)>;  // invalid tree on failure
+
+    AnalysisFileWorker();
+    ~AnalysisFileWorker() override;
+    //===============================================================================
+    /** The tree is deep-copied here, on the calling thread, so the caller is free to keep mutating the original. */
+    void requestSave(const juce::ValueTree &tree, const juce::File &file, bool useBinary, SaveCallback onComplete);
+    void requestLoad(const juce::File &file, LoadCallback onComplete);
+
+    int getNumPendingRequests() const;
+    //===============================================================================
+    void run() override;
+private:
+    struct Request {
+        enum class Kind { Save, Load } kind;
+        juce::File file;
+        juce::ValueTree tree {};    // save only
+        bool useBinary {true};      // save only
+        SaveCallback onSaved {};
+        LoadCallback onLoaded {};
+    };
+    void enqueue(Request request);
+    void service(Request &request);
+
+    juce::CriticalSection _queueLock;
+    std::deque<Request> _queue;
+    juce::WaitableEvent _wakeUp;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(AnalysisFileWorker)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisFileWorker)
+};
+
+} // namespace nvs::analysis
@@ -10,16 +10,21 @@
 
 #include "Analysis/Analyzer.h"
 #include "Analysis/OnsetAnalysis/OnsetAnalysis.h"
+#include "Analysis/OnsetAnalysis/OnsetProcessing.h"
+#include "Analysis/Tracing.h"
 #include "../plugin/slicer_granular/Source/algo_util.h"
 #include "../plugin/slicer_granular/Source/misc_util_juce.h"
 #include <concepts>
+#include <numeric>
 
 namespace nvs::analysis {
 
-Analyzer::Analyzer()
-:	ess_init()  // don't delete this seemingly unnecessary construction-it is a good reminder that ess_init MUST be initialized first
-,	ess_hold(ess_init)
-{}
+Analyzer::Analyzer() = default;
+
+const nvs::ess::EssentiaHolder &Analyzer::getEssentia() const {
+    std::call_once(_essentiaOnce, [this]{ _essentia.emplace(); });
+    return *_essentia;
+}
 
 bool Analyzer::updateSettings(juce::ValueTree &newSettings, const bool attemptFix){
     // verify tree structure
@@ -41,6 +46,10 @@ bool Analyzer::updateSettings(juce::ValueTree &newSettings, const bool attemptFi
     }
     return valid;
 }
+void Analyzer::applySettings(const AnalyzerSettings &newSettings, const juce::String &settingsHash) {
+    settings = newSettings;
+    _settingsHash = settingsHash;
+}
 AnalyzerSettings const &Analyzer::getSettings() const {
     return settings;
 }
@@ -49,28 +58,36 @@ float Analyzer::getAnalyzedFileSampleRate() const {
     return static_cast<float>(settings.analysis.sampleRate);
 }
 
-std::optional<vecReal> Analyzer::calculateOnsetsInSeconds(const vecReal &wave, RunLoopStatus& rls, const ShouldExitFn &shouldExit) const {
+std::optional<vecReal> Analyzer::calculateOnsetsInSeconds(const vecReal &wave, RunLoopStatus& rls, const ShouldExitFn &shouldExit,
+                                                          FeatureContainer<vecReal> *frameTimbresOut,
+                                                          std::vector<size_t> *silentEventIndicesOut) const {
     if (wave.empty()){
         return std::nullopt;
     }
+    if (settings.onset.segmentation == AnalyzerSettings::Onset::Segmentation::Bic) {
+        // the BFCC frames SBic needs are the ones the timbre stage would compute anyway, so they are computed once here
+        auto frameTimbres = calculateFrameTimbres(wave, rls, shouldExit);
+        if (!frameTimbres.has_value()) {
+            return std::nullopt;
+        }
+        auto onsetsInSeconds = bicOnsetsInSeconds(*frameTimbres, rls, shouldExit);
+        if (frameTimbresOut != nullptr) {
+            *frameTimbresOut = std::move(*frameTimbres);
+        }
+        return onsetsInSeconds;
+    }
 
     if (settings.onset.segmentation == AnalyzerSettings::Onset::Segmentation::Uniform) {
-        // make a vecReal of evenly distributed onsets
-        const float dt = 0.05f;
-        const auto L_sec = getLengthInSeconds(wave.size(), settings.analysis.sampleRate);
-        vecReal onsets (static_cast<size_t>(L_sec / dt));
-        for (size_t i = 0; i < onsets.size(); ++i) {
-            onsets[i] = static_cast<Real>(i) * dt;
-        }
-        return onsets;
+        return uniformOnsets(wave, silentEventIndicesOut);
     }
 
-    const analysis::array2dReal onsets2d = calculateOnsetsMatrix(wave, ess_hold.factory, settings, rls, shouldExit);
+    const analysis::array2dReal onsets2d = calculateOnsetsMatrix(wave, getEssentia().factory, settings, rls, shouldExit);
     std::cout << "analyzed onsets\n";
-    const essentia::standard::AlgorithmFactory &tmpStFac = essentia::standard::AlgorithmFactory::instance();
+    const essentia::standard::AlgorithmFactory &tmpStFac = getEssentia().standardFactory;
 
 #pragma message("it is a problem that we have not the ability to inject a runLoopCallback here, since onsetsInSeconds uses StandardFactory instead of StreamingFactory")
 
+    rls.beginStage(RunLoopStatus::Stage::OnsetsInSeconds);
     std::vector<float> onsetsInSeconds = analysis::calculateOnsetsInSeconds(onsets2d, tmpStFac, settings);	// explicit namespace qualifier for clarity
     std::cout << "calculated onsets in seconds\n";
 
@@ -117,8 +134,26 @@ static std::vector<T> weightedMeanFrames(const std::vector<std::vector<T>>& fram
 }
 
 
-void Analyzer::calculateEventwisePitchDescription(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features) const {
-    const auto [pitches, confidences] = calculatePitchesAndConfidences(waveEvent, settings);
+// the frames of a whole wave's frame timbres that start within range, but at least one
+static FeatureContainer<vecReal> framesStartingIn(const FeatureContainer<vecReal> &frameTimbres,
+                                                  const std::pair<size_t, size_t> range, const size_t hop) {
+    const size_t numFrames = frameTimbres.features[0].size();
+    const size_t first = std::min((range.first + hop - 1) / hop, numFrames - 1);
+    const size_t last = std::clamp((range.second + hop - 1) / hop, first + 1, numFrames);
+    FeatureContainer<vecReal> frames;
+    for (size_t f = 0; f < static_cast<size_t>(NumTimbralFeatures); ++f) {
+        const auto &src = frameTimbres.features[f];
+        frames.features[f].assign(src.begin() + static_cast<std::ptrdiff_t>(first), src.begin() + static_cast<std::ptrdiff_t>(last));
+    }
+    return frames;
+}
+
+void Analyzer::calculateEventwisePitchDescription(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features,
+                                                  const ShouldExitFn &shouldExit) const {
+    const auto [pitches, confidences] = calculatePitchesAndConfidences(waveEvent, settings, shouldExit);
+    if (shouldExit && shouldExit()) {
+        return;
+    }
 #pragma message("not using confidences yet")
 
     const auto p_mean = mean(pitches);
@@ -144,8 +179,12 @@ void Analyzer::calculateEventwisePitchDescription(const vecReal &waveEvent, Feat
     };
 }
 
-void Analyzer::calculateEventwiseLoudness(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features) const {
-    const vecReal l_tmp = calculateLoudnesses(waveEvent, settings);
+void Analyzer::calculateEventwiseLoudness(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features,
+                                          const ShouldExitFn &shouldExit) const {
+    const vecReal l_tmp = calculateLoudnesses(waveEvent, settings, shouldExit);
+    if (shouldExit && shouldExit()) {
+        return;
+    }
 
     const auto l_mean = mean(l_tmp);
 
@@ -158,9 +197,16 @@ void Analyzer::calculateEventwiseLoudness(const vecReal &waveEvent, FeatureConta
     };
 }
 
-void Analyzer::calculateEventwiseTimbreDescription(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features) const {
-    const FeatureContainer<vecReal> timbres_tmp = calculateTimbres(waveEvent, settings);
+void Analyzer::calculateEventwiseTimbreDescription(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features,
+                                                   const ShouldExitFn &shouldExit) const {
+    const FeatureContainer<vecReal> timbres_tmp = calculateTimbres(waveEvent, settings, shouldExit);
+    if (shouldExit && shouldExit()) {
+        return;
+    }
+    describeTimbreFrames(timbres_tmp, features);
+}
 
+void Analyzer::describeTimbreFrames(const FeatureContainer<vecReal> &timbres_tmp, FeatureContainer<EventwiseStats> &features) const {
     // const vecReal means = essentia::meanFrames(b_tmp);	// get mean per bfcc across all frames
     vecReal frameWeights;
     frameWeights.reserve(timbres_tmp.features.size());
@@ -202,75 +248,361 @@ void Analyzer::calculateEventwiseTimbreDescription(const vecReal &waveEvent, Fea
 
 auto Analyzer::calculateOnsetwiseTimbreSpace(const vecReal &wave,
                                         const std::vector<float> &onsetsInSeconds,
-                                        RunLoopStatus& rls, const ShouldExitFn &shouldExit)
+                                        const vecVecReal &events,
+                                        RunLoopStatus& rls, const ShouldExitFn &shouldExit,
+                                        const DescriptorGroups groups,
+                                        const FeatureContainer<vecReal> *frameTimbres)
 const -> std::optional<std::vector<FeatureContainer<EventwiseStats>>>
 {
     if ((wave.empty()) || (onsetsInSeconds.empty())){
         return std::nullopt;
     }
+    TSN_TRACE_SPAN("calculateOnsetwiseTimbreSpace");
 
     const double startMs = juce::Time::getMillisecondCounterHiRes();
     const auto   startTimeStr = juce::Time::getCurrentTime().toString (true, true, true, true);
     std::cout << "calculateOnsetwiseTimbreSpace start: " << startTimeStr << "\n";
 
-    rls.set("Splitting Wave into Events...");
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> timbre_points;
+    if (!calculateDescriptorGroups(wave, onsetsInSeconds, events, groups, timbre_points, rls, shouldExit, frameTimbres)) {
+        return std::nullopt;
+    }
+
+    const double endMs   = juce::Time::getMillisecondCounterHiRes();
+    const auto   endTimeStr   = juce::Time::getCurrentTime().toString (true, true);
+    const double elapsed = (endMs - startMs) * 0.001f;  // in seconds
+
+    std::cout << "calculateOnsetwiseTimbreSpace end:   " << endTimeStr << "\n";
+    std::cout << "\t\t\t Elapsed time:   " << juce::String (elapsed, 3) << " seconds\n";
 
-    const vecVecReal events = splitWaveIntoEvents(wave, onsetsInSeconds, ess_hold.factory, settings, rls, shouldExit);
+    return timbre_points;
+}
+
+auto Analyzer::splitIntoEvents(const vecReal &wave, const vecReal &onsetsInSeconds,
+                               const std::span<const size_t> silentEventIndices,
+                               RunLoopStatus &rls, const ShouldExitFn &shouldExit) const -> std::optional<vecVecReal>
+{
+    TSN_TRACE_SPAN("splitIntoEvents");
+    rls.beginStage(RunLoopStatus::Stage::SplittingEvents);
+
+    vecVecReal events = splitWaveIntoEvents(wave, onsetsInSeconds, getEssentia().factory, settings, rls, shouldExit);
 #pragma message("probably could benefit from some normalization, possibly based on variance")
+    if (shouldExit()) {
+        return std::nullopt;
+    }
+    const auto maxSilentEventLength = static_cast<size_t>(2 * settings.analysis.frameSize);
+    for (const size_t i : silentEventIndices) {
+        if (i < events.size() && events[i].size() > maxSilentEventLength) {
+            events[i].resize(maxSilentEventLength);
+        }
+    }
+    return events;
+}
 
+bool Analyzer::calculateDescriptorGroups(const vecReal &wave, const vecReal &onsetsInSeconds, const vecVecReal &events,
+                                         const DescriptorGroups groups,
+                                         std::vector<FeatureContainer<EventwiseStats>> &timbreSpace,
+                                         RunLoopStatus &rls, const ShouldExitFn &shouldExit,
+                                         const FeatureContainer<vecReal> *frameTimbres) const
+{
+    TSN_TRACE_SPAN("calculateDescriptorGroups");
     const size_t numEvents = events.size();
-    std::vector<FeatureContainer<EventwiseStatistics<Real>>> timbre_points(numEvents);
+    jassert(numEvents == onsetsInSeconds.size());
+    // written back only once every event is done, so that a cancelled pass leaves timbreSpace as it was
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> timbre_points(timbreSpace);
+    jassert(timbre_points.empty() || timbre_points.size() == numEvents);
+    timbre_points.resize(numEvents);
+
+    const bool doTimbre = groups.test(static_cast<size_t>(DescriptorGroup::Timbre));
+    const bool doPitch = groups.test(static_cast<size_t>(DescriptorGroup::Pitch));
+    const bool doLoudness = groups.test(static_cast<size_t>(DescriptorGroup::Loudness));
+    std::atomic<bool> cancelled {false};
+
+    const bool useFrameTimbres = frameTimbres != nullptr && !frameTimbres->features[0].empty();
+    const auto ranges = useFrameTimbres
+        ?   eventSampleRanges(wave.size(), onsetsInSeconds, settings.analysis.sampleRate)
+        :   std::vector<std::pair<size_t, size_t>>{};
+    jassert(!useFrameTimbres || ranges.size() == numEvents);
+
+    rls.beginStage(RunLoopStatus::Stage::EventDescriptors, numEvents);
+    // the pool is shared by all instances; settings.analysis.numThreads caps this instance's share of it
+    _executor->runBatch(this, numEvents, static_cast<size_t>(settings.analysis.numThreads), [&](const size_t i) {
+        if (cancelled.load(std::memory_order_relaxed) || shouldExit()) {
+            return;
+        }
+        const auto &e = events[i];
+        FeatureContainer<EventwiseStats> f = timbre_points[i];
+        if (doTimbre && useFrameTimbres) {
+            TSN_TRACE_SPAN("eventTimbreFromFrames");
+            describeTimbreFrames(framesStartingIn(*frameTimbres, ranges[i], static_cast<size_t>(settings.analysis.hopSize)), f);
+        } else if (doTimbre) {
+            TSN_TRACE_SPAN("eventTimbre");
+            calculateEventwiseTimbreDescription(e, f, shouldExit);
+        }
+        if (doPitch) {
+            TSN_TRACE_SPAN("eventPitch");
+            calculateEventwisePitchDescription(e, f, shouldExit);
+        }
+        if (doLoudness) {
+            TSN_TRACE_SPAN("eventLoudness");
+            calculateEventwiseLoudness(e, f, shouldExit);
+        }
+        if (shouldExit()) {
+            cancelled.store(true, std::memory_order_relaxed);
+            return;
+        }
+        timbre_points[i] = f;
+
+        rls.advance(1, e.size() * sizeof(Real));
+    });
+
+    std::cout << "calculated all BFCCs\n";
 
-    const auto threadPoolOptions = ThreadPoolOptions()
-        .withNumberOfThreads(settings.analysis.numThreads)
-        .withDesiredThreadPriority(Thread::Priority::high)
-        .withThreadName("TimbreAnalysis")
-        .withThreadStackSizeBytes(Thread::osDefaultStackSize);
-    ThreadPool pool(threadPoolOptions);
+    if (cancelled.load() || shouldExit()) {
+        return false;
+    }
+    timbreSpace = std::move(timbre_points);
+    return true;
+}
 
-    std::atomic<size_t> completed {0};
+auto Analyzer::calculateFrameTimbres(const vecReal &wave, RunLoopStatus &rls, const ShouldExitFn &shouldExit) const
+-> std::optional<FeatureContainer<vecReal>>
+{
+    if (wave.empty()) {
+        return std::nullopt;
+    }
+    TSN_TRACE_SPAN("calculateFrameTimbres");
+    getEssentia();
+    const auto hop = static_cast<size_t>(settings.analysis.hopSize);
+    const auto frameSize = static_cast<size_t>(settings.analysis.frameSize);
+    const auto numThreads = static_cast<size_t>(std::max(1, settings.analysis.numThreads));
+
+    // FrameCutter starts frame i at i * hop, so a chunk starting on a multiple of the hop yields the same frames as the
+    // whole wave would, as long as it runs frameSize - hop samples past its last frame
+    constexpr size_t minFramesPerChunk {256};
+    const size_t numFrameStarts = (wave.size() + hop - 1) / hop;
+    const size_t framesPerChunk = std::max(minFramesPerChunk, (numFrameStarts + numThreads - 1) / numThreads);
+    const size_t numChunks = (numFrameStarts + framesPerChunk - 1) / framesPerChunk;
+    std::vector<FeatureContainer<vecReal>> chunks(numChunks);
     std::atomic<bool> cancelled {false};
 
-    rls.set("Calculating timbre descriptions per event...");
-    for (size_t i = 0; i < numEvents; ++i) {
-        pool.addJob([&, i] {
-            if (cancelled.load(std::memory_order_relaxed) || shouldExit()) {
-                return;
-            }
-            const auto &e = events[i];
-            FeatureContainer<EventwiseStats> f;
-            calculateEventwiseTimbreDescription(e, f);
-            calculateEventwisePitchDescription(e, f);
-            calculateEventwiseLoudness(e, f);
-            timbre_points[i] = f;
-
-            if (const auto numDone = ++completed;
-                numDone % 4 == 0)
-            {
-                rls.set(static_cast<double>(numDone) / numEvents);
+    rls.beginStage(RunLoopStatus::Stage::FrameDescriptors, numChunks);
+    _executor->runBatch(this, numChunks, numThreads, [&](const size_t k) {
+        if (cancelled.load(std::memory_order_relaxed) || shouldExit()) {
+            return;
+        }
+        TSN_TRACE_SPAN("frameTimbreChunk");
+        const bool isLast = k + 1 == numChunks;
+        const size_t start = k * framesPerChunk * hop;
+        const size_t end = isLast ? wave.size() : std::min(wave.size(), ((k + 1) * framesPerChunk - 1) * hop + frameSize);
+        auto timbres = calculateTimbres(std::span(wave).subspan(start, end - start), settings, shouldExit);
+        if (shouldExit()) {
+            cancelled.store(true, std::memory_order_relaxed);
+            return;
+        }
+        if (!isLast) {
+            // the rest run off the end of the chunk; the next chunk has them whole
+            for (auto &feature : timbres.features) {
+                if (feature.size() > framesPerChunk) {
+                    feature.resize(framesPerChunk);
+                }
             }
-            if (shouldExit()) {
-                cancelled.store(true, std::memory_order_relaxed);
+        }
+        chunks[k] = std::move(timbres);
+        rls.advance(1, (end - start) * sizeof(Real));
+    });
+    if (cancelled.load() || shouldExit()) {
+        return std::nullopt;
+    }
+
+    FeatureContainer<vecReal> frameTimbres;
+    for (auto &chunk : chunks) {
+        for (size_t f = 0; f < frameTimbres.features.size(); ++f) {
+            auto &dst = frameTimbres.features[f];
+            dst.insert(dst.end(), chunk.features[f].begin(), chunk.features[f].end());
+        }
+    }
+    return frameTimbres;
+}
+
+vecReal Analyzer::bicOnsetsInSeconds(const FeatureContainer<vecReal> &frameTimbres, RunLoopStatus &rls,
+                                     const ShouldExitFn &shouldExit) const {
+    TSN_TRACE_SPAN("bicOnsetsInSeconds");
+    const vecVecReal frames = transpose(frameTimbres.bfccs());     // one BFCC vector per frame
+    const size_t numFrames = frames.size();
+    if (numFrames < 2) {
+        return {0.f};
+    }
+    const auto numThreads = static_cast<size_t>(std::max(1, settings.analysis.numThreads));
+    const auto windowFrames = static_cast<size_t>(std::max(1, settings.sBic.sizeFirstPass));
+
+    // each chunk also sees a first-pass window beyond either side of its core, so that a change near the edge of a core
+    // is judged with as much context as one pass over everything would give it. only boundaries within the core count.
+    const size_t coreFrames = std::max(4 * windowFrames, (numFrames + numThreads - 1) / numThreads);
+    const size_t numChunks = (numFrames + coreFrames - 1) / coreFrames;
+    std::vector<std::vector<size_t>> chunkBoundaries(numChunks);
+    const auto &factory = getEssentia().standardFactory;
+
+    rls.beginStage(RunLoopStatus::Stage::BicSegmentation, numChunks);
+    _executor->runBatch(this, numChunks, numThreads, [&](const size_t k) {
+        if (shouldExit()) {
+            return;
+        }
+        TSN_TRACE_SPAN("bicChunk");
+        const size_t coreBegin = k * coreFrames;
+        const size_t coreEnd = std::min(numFrames, coreBegin + coreFrames);
+        const size_t begin = coreBegin - std::min(coreBegin, windowFrames);
+        const size_t end = std::min(numFrames, coreEnd + windowFrames);
+        try {
+            const vecVecReal chunk(frames.begin() + static_cast<std::ptrdiff_t>(begin), frames.begin() + static_cast<std::ptrdiff_t>(end));
+            for (const auto b : sBic(vecVecToArray2dReal(chunk), factory, settings)) {
+                const auto local = static_cast<size_t>(b);
+                // SBic always reports the first and last frames it was given, which are not changes
+                if (local == 0 || local + 1 >= end - begin) {
+                    continue;
+                }
+                if (const auto global = begin + local; coreBegin <= global && global < coreEnd) {
+                    chunkBoundaries[k].push_back(global);
+                }
             }
-        });
+        } catch (const EssentiaException &e) {
+            // the chunk just contributes no boundaries
+            DBG("SBic failed on frames " << (int) begin << " to " << (int) end << ": " << e.what());
+        }
+        rls.advance(1, (end - begin) * NumBFCC * sizeof(Real));
+    });
+    if (shouldExit()) {
+        return {};
     }
-    while (pool.getNumJobs() > 0) {
-        Thread::sleep(10);  // sleep between checks
+
+    std::vector<size_t> found;
+    for (const auto &boundaries : chunkBoundaries) {
+        found.insert(found.end(), boundaries.begin(), boundaries.end());
+    }
+    std::ranges::sort(found);
+    // neighbouring chunks may both report a change straddling their shared edge
+    const auto minSegmentFrames = static_cast<size_t>(std::max(1, settings.sBic.minSegmentLengthFrames));
+    std::vector<size_t> boundaries {0};
+    for (const auto b : found) {
+        if (b >= boundaries.back() + minSegmentFrames) {
+            boundaries.push_back(b);
+        }
     }
 
-    std::cout << "calculated all BFCCs\n";
+    const auto secondsPerFrame = static_cast<double>(settings.analysis.hopSize) / settings.analysis.sampleRate;
+    vecReal onsetsInSeconds;
+    onsetsInSeconds.reserve(boundaries.size());
+    for (const auto b : boundaries) {
+        onsetsInSeconds.push_back(static_cast<Real>(static_cast<double>(b) * secondsPerFrame));
+    }
+    return onsetsInSeconds;
+}
 
-    if (cancelled.load() || shouldExit()) {
+std::vector<std::pair<size_t, size_t>> Analyzer::findGatedSilences(const vecReal &wave) const {
+    if (settings.onset.segmentation != AnalyzerSettings::Onset::Segmentation::Uniform || !settings.onset.silenceGate) {
+        return {};
+    }
+    TSN_TRACE_SPAN("findGatedSilences");
+    return findSilentRegions(wave, settings.analysis.sampleRate, settings.onset.silenceGateThreshold,
+                             settings.onset.silenceGateHangover * 0.001);
+}
+
+vecReal Analyzer::uniformOnsets(const vecReal &wave, std::vector<size_t> *silentEventIndices) const {
+    // make a vecReal of evenly distributed onsets
+    const float dt = 0.05f;
+    const auto L_sec = getLengthInSeconds(wave.size(), settings.analysis.sampleRate);
+    return uniformOnsetsInSeconds(L_sec, dt, settings.analysis.sampleRate, findGatedSilences(wave), silentEventIndices);
+}
+
+vecReal Analyzer::provisionalOnsetsInSeconds(const double lengthInSeconds) {
+    constexpr double minEventSeconds {0.25};
+    constexpr double maxNumEvents {256.0};
+    const double eventSeconds = std::max(minEventSeconds, lengthInSeconds / maxNumEvents);
+    vecReal onsets;
+    for (double t = 0.0; t < lengthInSeconds; t += eventSeconds) {
+        onsets.push_back(static_cast<Real>(t));
+    }
+    return onsets;
+}
+
+auto Analyzer::calculateProvisionalTimbreSpace(const vecReal &wave,
+                                               const vecReal &onsetsInSeconds,
+                                               const std::vector<Feature_e> &features,
+                                               RunLoopStatus &rls, const ShouldExitFn &shouldExit)
+const -> std::optional<std::vector<FeatureContainer<EventwiseStats>>>
+{
+    if (wave.empty() || onsetsInSeconds.empty() || features.empty()) {
+        return std::nullopt;
+    }
+    TSN_TRACE_SPAN("calculateProvisionalTimbreSpace");
+    const auto groups = descriptorGroupsFor(features);
+    const bool needsTimbre = groups.test(static_cast<size_t>(DescriptorGroup::Timbre));
+    const bool needsPitch = groups.test(static_cast<size_t>(DescriptorGroup::Pitch));
+    const bool needsLoudness = groups.test(static_cast<size_t>(DescriptorGroup::Loudness));
+
+    // power-of-two decimation keeps frame and hop sizes powers of two while covering the same time spans
+    const double sampleRate = settings.analysis.sampleRate;
+    if (sampleRate <= 0.0) {
         return std::nullopt;
     }
+    const int decimation = std::max(1, juce::nextPowerOfTwo(static_cast<int>(sampleRate / provisionalSampleRate) + 1) / 2);
+    vecReal decimated(wave.size() / static_cast<size_t>(decimation));
+    for (size_t i = 0; i < decimated.size(); ++i) {
+        // box average as a cheap anti-aliasing filter; good enough for a sketch
+        const auto *src = wave.data() + i * static_cast<size_t>(decimation);
+        decimated[i] = std::accumulate(src, src + decimation, Real{0}) / static_cast<Real>(decimation);
+    }
 
-    const double endMs   = juce::Time::getMillisecondCounterHiRes();
-    const auto   endTimeStr   = juce::Time::getCurrentTime().toString (true, true);
-    const double elapsed = (endMs - startMs) * 0.001f;  // in seconds
+    AnalyzerSettings sketchSettings = settings;
+    sketchSettings.analysis.sampleRate = sampleRate / decimation;
+    sketchSettings.analysis.frameSize = std::max(128, settings.analysis.frameSize / decimation);
+    sketchSettings.analysis.hopSize = std::max(32, settings.analysis.hopSize / decimation);
+    const double nyquist = sketchSettings.analysis.sampleRate * 0.5;
+    sketchSettings.bfcc.highFrequencyBound = std::min(sketchSettings.bfcc.highFrequencyBound, nyquist * 0.95);
+    sketchSettings.bfcc.lowFrequencyBound = std::min(sketchSettings.bfcc.lowFrequencyBound, sketchSettings.bfcc.highFrequencyBound * 0.5);
+    sketchSettings.pitch.maxFrequency = std::min(sketchSettings.pitch.maxFrequency, nyquist * 0.9);
+    if (decimated.size() < static_cast<size_t>(sketchSettings.analysis.frameSize)) {
+        return std::nullopt;
+    }
+    Analyzer sketcher;
+    sketcher.applySettings(sketchSettings, _settingsHash);
+    sketcher.getEssentia();
 
-    std::cout << "calculateOnsetwiseTimbreSpace end:   " << endTimeStr << "\n";
-    std::cout << "\t\t\t Elapsed time:   " << juce::String (elapsed, 3) << " seconds\n";
+    const auto ranges = eventSampleRanges(decimated.size(), onsetsInSeconds, sketchSettings.analysis.sampleRate);
+    const size_t numEvents = ranges.size();
+    std::vector<FeatureContainer<EventwiseStats>> timbre_points(numEvents);
+    std::atomic<bool> cancelled {false};
 
+    rls.beginStage(RunLoopStatus::Stage::ProvisionalMap, numEvents);
+    _executor->runBatch(this, numEvents, static_cast<size_t>(settings.analysis.numThreads), [&](const size_t i) {
+        if (cancelled.load(std::memory_order_relaxed) || shouldExit()) {
+            return;
+        }
+        // descriptors need at least one full frame
+        const auto [start, end] = ranges[i];
+        const auto length = std::max(end - start, static_cast<size_t>(sketchSettings.analysis.frameSize));
+        const auto first = decimated.begin() + static_cast<std::ptrdiff_t>(std::min(start, decimated.size() - length));
+        const vecReal e(first, first + static_cast<std::ptrdiff_t>(length));
+        FeatureContainer<EventwiseStats> f;
+        if (needsTimbre) {
+            sketcher.calculateEventwiseTimbreDescription(e, f, shouldExit);
+        }
+        if (needsPitch) {
+            sketcher.calculateEventwisePitchDescription(e, f, shouldExit);
+        }
+        if (needsLoudness) {
+            sketcher.calculateEventwiseLoudness(e, f, shouldExit);
+        }
+        if (shouldExit()) {
+            cancelled.store(true, std::memory_order_relaxed);
+            return;
+        }
+        timbre_points[i] = f;
+        rls.advance(1, e.size() * sizeof(Real));
+    });
+    if (cancelled.load() || shouldExit()) {
+        return std::nullopt;
+    }
     return timbre_points;
 }
 
@@ -325,80 +657,4 @@ vecVecReal transpose(const vecVecReal &V){
     return transpose(std::span(V));
 }
 
-void writeEventsToWav(const vecReal &wave,
-                      const std::vector<float> &onsetsInSeconds,
-                      std::string_view ogPath,
-                      const Analyzer &analyzer,
-                      RunLoopStatus& rls,
-                      ShouldExitFn shouldExit)
-{
-    if ( wave.empty() or onsetsInSeconds.empty() ){
-        std::cerr << "unsuccessful write; wave or onsets of size 0\n";
-        return;
-    }
-    const auto base_name = [ogPath]() -> juce::String {
-        const juce::String s(ogPath.data());
-        return s.dropLastCharacters(4);
-    }();
-
-    const auto& settings = analyzer.getSettings();
-    const vecVecReal events = splitWaveIntoEvents(wave, onsetsInSeconds,
-                                            analyzer.ess_hold.factory,
-                                            settings,
-                                            rls,
-                                            std::move(shouldExit));
-    juce::WavAudioFormat format;
-    std::unique_ptr<juce::AudioFormatWriter> writer;
-
-
-    juce::File directory(base_name + analyzer.getSettingsHash());
-    if (!directory.isDirectory()) {
-        // If base_name has an extension, remove it to make it a directory
-        directory = directory.getParentDirectory().getChildFile(directory.getFileNameWithoutExtension());
-    }
-    if (!directory.exists()) {
-        if (const auto result = directory.createDirectory(); !result) {
-            std::cerr << "Failed to create directory: " << result.getErrorMessage() << "\n";
-            jassertfalse;
-            return;
-        }
-    }
-    std::cout << "Directory created at: " << directory.getFullPathName() << "\n";
-    const juce::String filePrefix = juce::File(base_name).getFileName();
-
-    int idx = 0;
-    for (const auto &e : events){
-
-        juce::String evName = filePrefix;
-        evName << "_" << idx++ << ".wav";
-
-        const juce::File outFile = directory.getChildFile(evName);
-
-        juce::AudioBuffer<float> buffer(1, static_cast<int>(e.size()));
-        buffer.clear();
-        buffer.addFrom(0, 0, e.data(), static_cast<int>(e.size()));
-        //			buffer.applyGainRamp(0, 0, 									5, 0.f, 1.f);	// fade in 5 samps
-        //			buffer.applyGainRamp(0, static_cast<int>(e.size())-10, 10, 1.f, 0.f);	// fade out 10 samps
-
-
-        const auto options = juce::AudioFormatWriterOptions()
-                        .withSampleRate(analyzer.getAnalyzedFileSampleRate()) // sr
-                        .withNumChannels(buffer.getNumChannels()) // numChans
-                        .withBitsPerSample(24) // bitsPerSample
-                        .withMetadataValues({}) // metadataValues
-                        .withQualityOptionIndex(0) // qualityOptionIndex
-                        .withSampleFormat(AudioFormatWriterOptions::SampleFormat::integral); // sampleFormat
-
-        std::unique_ptr<OutputStream> outputStream = std::make_unique<FileOutputStream>(outFile);
-        writer = format.createWriterFor(outputStream, options);
-
-        if (writer != nullptr){
-            writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
-            std::cout << "File " << outFile.getFileName() << " written\n";
-        } else {
-            std::cerr << "File write " << outFile.getFileName() << " fail\n";
-        }
-    }
-}
-
 }
@@ -12,6 +12,7 @@
 #include <optional>
 #include <algorithm>
 #include <JuceHeader.h>
+#include "AnalysisExecutor.h"
 #include "RunLoopStatus.h"
 #include "TimbreAnalysis/TimbreAnalysis.h"
 #include "Features.h"
@@ -101,28 +102,86 @@ extractFeatures(FeatureContainer<EventwiseStatistics<Real>> const & allFeatures,
 }
 
 class Analyzer {
-private:
-	nvs::ess::EssentiaInitializer ess_init;	  // this MUST be initialized before EssentiaHolder.
 public:
 	Analyzer();
 	using EventwiseStats = EventwiseStatistics<Real>;
 
+	// with Bic segmentation, the frame-level timbres the segmentation was found from are moved into frameTimbresOut (if
+	// given), so that calculateOnsetwiseTimbreSpace can describe the events from them instead of analysing them again.
+	// with Uniform segmentation and the silence gate on, the indices of the events that are gated silences go to
+	// silentEventIndicesOut (if given), for splitIntoEvents.
 	std::optional<vecReal>
     calculateOnsetsInSeconds(
         vecReal const &wave,
         RunLoopStatus& rls,
+	    const ShouldExitFn &shouldExit,
+	    FeatureContainer<vecReal> *frameTimbresOut = nullptr,
+	    std::vector<size_t> *silentEventIndicesOut = nullptr) const;
+	// the wave cut into its events at onsetsInSeconds, once per analysis, for every descriptor pass over it. the events
+	// of silentEventIndices (from calculateOnsetsInSeconds, if the onsets are still the ones it returned) are cut short,
+	// since a couple of frames describe a silence as well as all of it would. nullopt if shouldExit fired.
+	std::optional<vecVecReal>
+	splitIntoEvents(
+	    const vecReal &wave,
+	    const vecReal &onsetsInSeconds,
+	    std::span<const size_t> silentEventIndices,
+	    RunLoopStatus& rls,
+	    const ShouldExitFn &shouldExit) const;
+	// the calculateTimbres frames of the whole wave, frame i starting at sample i * hopSize, computed in hop-aligned
+	// chunks in parallel. nullopt if shouldExit fired.
+	std::optional<FeatureContainer<vecReal>>
+	calculateFrameTimbres(
+	    const vecReal &wave,
+	    RunLoopStatus& rls,
 	    const ShouldExitFn &shouldExit) const;
 	
-	void calculateEventwisePitchDescription(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features) const;
-	void calculateEventwiseTimbreDescription(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features) const;
-	void calculateEventwiseLoudness(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features) const;
-
+	// each of these leaves features untouched if shouldExit fires partway through the event
+	void calculateEventwisePitchDescription(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features,
+	                                        const ShouldExitFn &shouldExit = nullptr) const;
+	void calculateEventwiseTimbreDescription(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features,
+	                                         const ShouldExitFn &shouldExit = nullptr) const;
+	// the same, from frames already calculated by calculateTimbres
+	void describeTimbreFrames(const FeatureContainer<vecReal> &timbres, FeatureContainer<EventwiseStats> &features) const;
+	void calculateEventwiseLoudness(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features,
+	                                const ShouldExitFn &shouldExit = nullptr) const;
+
+	// events: of wave at onsetsInSeconds, from splitIntoEvents. only the features of `groups` are computed; the others
+	// are left at zero. if frameTimbres (of the whole wave, from calculateFrameTimbres) is given, the Timbre group is
+	// summarized from the frames starting within each event.
 	std::optional<std::vector<FeatureContainer<EventwiseStats>>>
     calculateOnsetwiseTimbreSpace(
         const vecReal &wave,
         const vecReal &onsetsInSeconds,
+        const vecVecReal &events,
         RunLoopStatus& rls,
-        const ShouldExitFn &shouldExit) const;
+        const ShouldExitFn &shouldExit,
+        DescriptorGroups groups = allDescriptorGroups(),
+        const FeatureContainer<vecReal> *frameTimbres = nullptr) const;
+	// computes the features of `groups` into a timbre space calculated earlier from the same wave and onsets, leaving
+	// its other features as they are. returns false, with timbreSpace untouched, if shouldExit fired.
+	bool calculateDescriptorGroups(
+	    const vecReal &wave,
+	    const vecReal &onsetsInSeconds,
+	    const vecVecReal &events,
+	    DescriptorGroups groups,
+	    std::vector<FeatureContainer<EventwiseStats>> &timbreSpace,
+	    RunLoopStatus& rls,
+	    const ShouldExitFn &shouldExit,
+	    const FeatureContainer<vecReal> *frameTimbres = nullptr) const;
+
+	// a fast, coarse sketch of the timbre space to show and play while calculateOnsetwiseTimbreSpace runs. the wave is
+	// decimated to around provisionalSampleRate, and only the analysis passes that `features` need are run; the other
+	// features are left at zero. onsetsInSeconds would normally come from provisionalOnsetsInSeconds().
+	std::optional<std::vector<FeatureContainer<EventwiseStats>>>
+	calculateProvisionalTimbreSpace(
+	    const vecReal &wave,
+	    const vecReal &onsetsInSeconds,
+	    const std::vector<Feature_e> &features,
+	    RunLoopStatus& rls,
+	    const ShouldExitFn &shouldExit) const;
+	// uniform segmentation into few, long events
+	static vecReal provisionalOnsetsInSeconds(double lengthInSeconds);
+	static constexpr double provisionalSampleRate {11025.0};
 
     static std::optional<vecVecReal> calculatePCA(
 	    const std::vector<FeatureContainer<EventwiseStats>> &allFeatures,
@@ -132,16 +191,32 @@ public:
 	float getAnalyzedFileSampleRate() const;
 
 	bool updateSettings(juce::ValueTree &newSettings, bool attemptFix);
+	// for settings already parsed (and hashed) elsewhere, e.g. on the message thread by ThreadedAnalyzer::requestAnalysis
+	void applySettings(const AnalyzerSettings &newSettings, const juce::String &settingsHash);
 	AnalyzerSettings const &getSettings() const;
     juce::String getSettingsHash() const {
         return _settingsHash;
     }
 
     //====================================================================================
-	nvs::ess::EssentiaHolder ess_hold;
+	// Essentia is only started (or joined, if another instance already started it) the first time this is called,
+	// so that merely constructing the plugin, e.g. during a host's plugin scan, never pays for it.
+	// the analysis entry points call it themselves; call it up front to take the startup cost at a time of your choosing.
+	const nvs::ess::EssentiaHolder &getEssentia() const;
 private:
+	// silent regions of the wave if the silence gate applies (Uniform segmentation with silenceGate on), else none
+	std::vector<std::pair<size_t, size_t>> findGatedSilences(const vecReal &wave) const;
+	// Uniform segmentation's onsets; the indices of the events that are gated silences go to silentEventIndices, if given
+	vecReal uniformOnsets(const vecReal &wave, std::vector<size_t> *silentEventIndices = nullptr) const;
+	// SBic over the BFCC frames, in overlapping chunks in parallel; boundaries in seconds, starting with 0
+	vecReal bicOnsetsInSeconds(const FeatureContainer<vecReal> &frameTimbres, RunLoopStatus& rls, const ShouldExitFn &shouldExit) const;
+
+	mutable std::once_flag _essentiaOnce;
+	mutable std::optional<nvs::ess::EssentiaHolder> _essentia;
+
 	AnalyzerSettings settings;
     juce::String _settingsHash {};
+    juce::SharedResourcePointer<AnalysisExecutor> _executor;
 };
 
 double getLengthInSeconds(auto lengthInSamples, auto sampleRate){
@@ -169,6 +244,4 @@ vecReal binwiseStatistic(vecVecReal const &V, Func statisticFunc) {
 	return results;
 }
 
-void writeEventsToWav(vecReal const &wave, std::vector<float> const &onsetsInSeconds, std::string_view ogPath, const Analyzer &analyzer, RunLoopStatus& rls, ShouldExitFn shouldExit);
-
 }	// namespace nvs::analysis
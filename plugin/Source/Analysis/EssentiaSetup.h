@@ -10,27 +10,65 @@
 
 #pragma once
 #include "essentia/algorithmfactory.h"
+#include <mutex>
 
 namespace nvs {
 namespace ess {
 
+// Essentia's algorithm factories are process-global, so every plugin instance has to share a single essentia::init().
+// The first acquire initializes, the last release shuts down; use EssentiaInitializer rather than calling these directly.
+class EssentiaRuntime {
+public:
+	static void acquire() {
+		auto &s = state();
+		const std::scoped_lock sl(s.mutex);
+		if (s.refCount++ == 0) {
+			essentia::init();
+		}
+	}
+	static void release() {
+		auto &s = state();
+		const std::scoped_lock sl(s.mutex);
+		jassert(s.refCount > 0);
+		if (--s.refCount == 0) {
+			essentia::shutdown();
+		}
+	}
+	static int getRefCount() {
+		auto &s = state();
+		const std::scoped_lock sl(s.mutex);
+		return s.refCount;
+	}
+private:
+	struct State {
+		std::mutex mutex;
+		int refCount {0};
+	};
+	static State &state() {
+		static State s;
+		return s;
+	}
+};
+
+// RAII reference to the process-wide runtime
 struct EssentiaInitializer {
 	EssentiaInitializer(){
-		essentia::init();
+		EssentiaRuntime::acquire();
 	}
 	~EssentiaInitializer(){
-		essentia::shutdown();
+		EssentiaRuntime::release();
 	}
+	EssentiaInitializer(const EssentiaInitializer&) = delete;
+	EssentiaInitializer &operator=(const EssentiaInitializer&) = delete;
 };
 
-// instantiates Essentia
+// instantiates Essentia (or joins the instance another plugin already started)
 struct EssentiaHolder {
-	EssentiaInitializer &initializer;
+	EssentiaInitializer initializer;	// must stay the first member: the factories below require an initialized runtime
 	essentia::streaming::AlgorithmFactory& factory;
 	essentia::standard::AlgorithmFactory& standardFactory;
 
-    explicit EssentiaHolder(EssentiaInitializer &init) :
-		initializer(init),
+    EssentiaHolder() :
 		factory(essentia::streaming::AlgorithmFactory::instance()),
 		standardFactory(essentia::standard::AlgorithmFactory::instance())
 	{}
@@ -0,0 +1,171 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "Analysis/EventExporter.h"
+#include "Analysis/Tracing.h"
+#include "Analysis/OnsetAnalysis/OnsetProcessing.h"
+
+namespace nvs::analysis {
+
+namespace {
+constexpr size_t writeBlockSize = 4096;     // samples faded and handed to the writer at a time
+}
+
+EventExporter::EventExporter()
+:   juce::Thread("EventExporter")
+{}
+EventExporter::~EventExporter() {
+    cancel();
+    signalThreadShouldExit();
+    _requestAvailable.signal();
+    stopThread(5000);
+}
+
+void EventExporter::requestExport(Request request) {
+    {
+        const juce::ScopedLock sl(_jobLock);
+        _requestedGeneration.fetch_add(1, std::memory_order_acq_rel);    // cancels the export in flight
+        _pendingRequest = std::move(request);
+    }
+    _requestAvailable.signal();
+    if (!isThreadRunning()) {
+        startThread(juce::Thread::Priority::low);
+    }
+}
+void EventExporter::cancel() {
+    const juce::ScopedLock sl(_jobLock);
+    _pendingRequest.reset();
+    _requestedGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+auto EventExporter::getLastOutcome() const -> Outcome {
+    const juce::ScopedLock sl(_outcomeLock);
+    return _lastOutcome;
+}
+
+void EventExporter::run() {
+    while (!threadShouldExit()) {
+        std::optional<Request> request;
+        std::uint64_t generation {0};
+        {
+            const juce::ScopedLock sl(_jobLock);
+            request = std::exchange(_pendingRequest, std::nullopt);
+            generation = _requestedGeneration.load(std::memory_order_acquire);
+            _busy.store(request.has_value(), std::memory_order_relaxed);
+        }
+        if (!request.has_value()) {
+            _requestAvailable.wait(-1);
+            continue;
+        }
+        runExport(*request, generation);
+        _busy.store(false, std::memory_order_relaxed);
+        sendChangeMessage();
+    }
+}
+//=============================================================================================================================
+juce::File EventExporter::getExportDirectory(const juce::String &sampleFilePath, const juce::String &settingsHash) {
+    const auto baseName = sampleFilePath.dropLastCharacters(4);
+    juce::File directory(baseName + settingsHash);
+    if (!directory.isDirectory()) {
+        // If baseName has an extension, remove it to make it a directory
+        directory = directory.getParentDirectory().getChildFile(directory.getFileNameWithoutExtension());
+    }
+    return directory;
+}
+//=============================================================================================================================
+bool EventExporter::writeEvent(const Request &request, const std::pair<size_t, size_t> range, const juce::File &outFile) {
+    const auto [start, end] = range;
+    const auto length = end - start;
+
+    outFile.deleteFile();   // FileOutputStream appends; a re-export must replace the old event
+    auto fileStream = std::make_unique<juce::FileOutputStream>(outFile);
+    if (!fileStream->openedOk()) {
+        return false;
+    }
+    std::unique_ptr<juce::OutputStream> outputStream = std::move(fileStream);
+    const auto options = juce::AudioFormatWriterOptions()
+        .withSampleRate(request.sampleRate)
+        .withNumChannels(1)
+        .withBitsPerSample(24)
+        .withMetadataValues({})
+        .withQualityOptionIndex(0)
+        .withSampleFormat(juce::AudioFormatWriterOptions::SampleFormat::integral);
+    const auto writer = juce::WavAudioFormat().createWriterFor(outputStream, options);
+    if (writer == nullptr) {
+        return false;
+    }
+
+    // the same linear fades splitWaveIntoEvents applies, computed per block rather than on a copy of the event
+    const auto fadeIn = std::min(static_cast<size_t>(std::max(0, request.fadeInSamps)), length);
+    const auto fadeOut = std::min(static_cast<size_t>(std::max(0, request.fadeOutSamps)), length);
+    std::array<float, writeBlockSize> block {};
+    const float *src = request.wave.data() + start;
+    for (size_t pos = 0; pos < length; pos += writeBlockSize) {
+        const auto n = std::min(writeBlockSize, length - pos);
+        for (size_t j = 0; j < n; ++j) {
+            const auto k = pos + j;
+            const auto fromEnd = length - 1 - k;
+            float gain = 1.f;
+            if (k < fadeIn) {
+                gain *= static_cast<float>(k) / static_cast<float>(fadeIn);
+            }
+            if (fromEnd < fadeOut) {
+                gain *= static_cast<float>(fromEnd) / static_cast<float>(fadeOut);
+            }
+            block[j] = src[k] * gain;
+        }
+        const float *channels[] = { block.data() };
+        if (!writer->writeFromFloatArrays(channels, 1, static_cast<int>(n))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void EventExporter::runExport(const Request &request, const std::uint64_t generation) {
+    TSN_TRACE_SPAN("EventExporter::runExport");
+    const auto ranges = eventSampleRanges(request.wave.size(), request.onsetsInSeconds, request.sampleRate);
+    Outcome outcome { .directory = request.directory };
+
+    const auto statusFinisher = juce::ScopeGuard{ [this, &outcome]{
+        _rls.finish();
+        const juce::ScopedLock sl(_outcomeLock);
+        _lastOutcome = outcome;
+    } };
+    if (ranges.empty()) {
+        return;
+    }
+    if (const auto result = request.directory.createDirectory(); result.failed()) {
+        DBG("EventExporter: failed to create directory: " << result.getErrorMessage());
+        outcome.numFailed = ranges.size();
+        return;
+    }
+    const auto shouldExit = [this, generation] {
+        return threadShouldExit() || _requestedGeneration.load(std::memory_order_relaxed) != generation;
+    };
+
+    _rls.beginStage(RunLoopStatus::Stage::WritingEvents, ranges.size());
+    std::atomic<size_t> numWritten {0};
+    std::atomic<size_t> numFailed {0};
+    // mostly waiting on the disk, so the few writers in flight barely compete with analysis for the pool
+    _executor->runBatch(this, ranges.size(), request.maxConcurrentWrites, [&](const size_t i) {
+        if (shouldExit()) {
+            return;
+        }
+        TSN_TRACE_SPAN("writeEvent");
+        juce::String evName = request.filePrefix;
+        evName << "_" << static_cast<int>(i) << ".wav";
+        if (writeEvent(request, ranges[i], request.directory.getChildFile(evName))) {
+            numWritten.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            DBG("EventExporter: writing " << evName << " failed");
+            numFailed.fetch_add(1, std::memory_order_relaxed);
+        }
+        _rls.advance(1, (ranges[i].second - ranges[i].first) * sizeof(float));
+    });
+    outcome.numWritten = numWritten.load();
+    outcome.numFailed = numFailed.load();
+    outcome.cancelled = shouldExit();
+}
+
+}   // namespace nvs::analysis
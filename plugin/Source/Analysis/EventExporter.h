@@ -0,0 +1,76 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "Analysis/AnalysisUsing.h"
+#include "Analysis/AnalysisExecutor.h"
+#include "Analysis/RunLoopStatus.h"
+
+namespace nvs::analysis {
+
+/**
+ * Writes each onset-delimited event of a sample to its own .wav, off the message thread.
+ *
+ * Events are never materialized: each writer streams its slice of the source wave to disk in small blocks, applying
+ * the split fades on the way, and several events are written at once on the shared AnalysisExecutor. As with
+ * ThreadedAnalyzer, a new request cancels the export in flight and only the latest pending one is kept. Progress is
+ * published through getStatus() under Stage::WritingEvents, and a change message is sent when an export ends.
+ */
+class EventExporter final : public juce::Thread
+,                           public juce::ChangeBroadcaster
+{
+public:
+    struct Request {
+        vecReal wave;
+        std::vector<float> onsetsInSeconds;
+        double sampleRate;
+        int fadeInSamps;
+        int fadeOutSamps;
+        juce::File directory;
+        juce::String filePrefix;                // events are written as <prefix>_<index>.wav
+        size_t maxConcurrentWrites {4};
+    };
+    struct Outcome {
+        juce::File directory {};
+        size_t numWritten {0};
+        size_t numFailed {0};
+        bool cancelled {false};
+    };
+
+    EventExporter();
+    ~EventExporter() override;
+
+    // message thread
+    void requestExport(Request request);
+    void cancel();
+    bool isBusy() const noexcept { return _busy.load(std::memory_order_relaxed); }
+    RunLoopStatus &getStatus() noexcept { return _rls; }
+    // of the most recently finished export (message thread, e.g. from the change callback)
+    Outcome getLastOutcome() const;
+
+    // where the events of sampleFilePath, split with settings hashed to settingsHash, are written
+    static juce::File getExportDirectory(const juce::String &sampleFilePath, const juce::String &settingsHash);
+    //===============================================================================
+    void run() override;
+private:
+    void runExport(const Request &request, std::uint64_t generation);
+    static bool writeEvent(const Request &request, std::pair<size_t, size_t> range, const juce::File &outFile);
+
+    juce::CriticalSection _jobLock;
+    std::optional<Request> _pendingRequest;
+    juce::WaitableEvent _requestAvailable;
+    std::atomic<std::uint64_t> _requestedGeneration {0};
+    std::atomic<bool> _busy {false};
+
+    mutable juce::CriticalSection _outcomeLock;
+    Outcome _lastOutcome {};
+
+    RunLoopStatus _rls;
+    juce::SharedResourcePointer<AnalysisExecutor> _executor;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventExporter)
+};
+
+}   // namespace nvs::analysis
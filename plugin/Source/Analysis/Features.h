@@ -11,6 +11,7 @@
 #pragma once
 #include <span>
 #include <set>
+#include <bitset>
 
 namespace nvs::analysis {
 
@@ -69,6 +70,34 @@ inline bool isBFCC(Feature_e f) {
 }
 
 
+// the analysis passes features come out of. a pass always yields all of its features, so this is the granularity at
+// which features can be left uncomputed.
+enum class DescriptorGroup {
+	Timbre,		// bfccs and spectral descriptors
+	Pitch,		// Periodicity, f0
+	Loudness,
+
+	NumGroups
+};
+using DescriptorGroups = std::bitset<static_cast<size_t>(DescriptorGroup::NumGroups)>;
+
+inline DescriptorGroup descriptorGroupOf(Feature_e f) {
+	if (static_cast<int>(f) <= NumTimbralFeatures) {
+		return DescriptorGroup::Timbre;
+	}
+	return (f == Feature_e::Loudness) ? DescriptorGroup::Loudness : DescriptorGroup::Pitch;
+}
+inline DescriptorGroups descriptorGroupsFor(std::span<const Feature_e> features) {
+	DescriptorGroups groups;
+	for (const auto f : features) {
+		groups.set(static_cast<size_t>(descriptorGroupOf(f)));
+	}
+	return groups;
+}
+inline DescriptorGroups allDescriptorGroups() {
+	return DescriptorGroups{}.set();
+}
+
 template <typename T>	// T can foreseeably be either single Real, vecReal, or EventwiseStatistics
 struct FeatureContainer {
     std::array<T, static_cast<size_t>(Feature_e::NumFeatures)> features {};
@@ -9,6 +9,7 @@
 */
 
 #include "OnsetAnalysis.h"
+#include "Analysis/Tracing.h"
 
 /** TODO:
  consolidate onsetsInSeconds with onsetAnalysis.
@@ -41,6 +42,7 @@ array2dReal calculateOnsetsMatrix(std::vector<Real> const &waveform,
 						  RunLoopStatus& rls,
 						  const ShouldExitFn &shouldExit)
 {
+	TSN_TRACE_SPAN("calculateOnsetsMatrix");
 	const auto input_sr     = settings.analysis.sampleRate;
 	assert(0.0 < input_sr);
     constexpr auto internal_sr  = 44100.0f;
@@ -157,14 +159,14 @@ array2dReal calculateOnsetsMatrix(std::vector<Real> const &waveform,
 	
 	Network n(inVec);
 	n.runPrepare();
-	rls.set(0.0);
-	rls.set("Computing onset matrix...");
+	// the streaming network doesn't expose how many steps it will take, so this stage is indeterminate until done
+	rls.beginStage(RunLoopStatus::Stage::OnsetMatrix, 1);
 	while (n.runStep()){
 		if (shouldExit()) {
 			break;
 		}
 	}
-	rls.set(1.0);
+	rls.advance(1, waveform.size() * sizeof(Real));
 	n.clear();
 
     // this bit just takes all the detection outputs and makes them constant-size (which should only not happen if some of them had a weight of 0)
@@ -199,6 +201,7 @@ vecReal calculateOnsetsInSeconds(const array2dReal &onsetAnalysisMatrix,
 								 const standardFactory &factory,
 								 const AnalyzerSettings &settings)
 {
+	TSN_TRACE_SPAN("calculateOnsetsInSeconds");
 	/* assuming that the onsetAnalysisMatrix was derived from the above onsetAnalysis,
 	 (which is beyond likely in this codebase because it's not so trivial to construct that array2dReal),
 	 the sample rate of the signal will have already been converted to 44100 before the analysis.
@@ -320,7 +323,7 @@ vecVecReal featuresForSbic(const vecReal &waveform,
 vecReal sBic(const array2dReal &featureMatrix, const standardFactory &factory,
 			 const AnalyzerSettings &settings){
 
-	standard::Algorithm* sbic = factory.create (
+	const auto sbic = std::unique_ptr<standard::Algorithm>(factory.create (
 		"SBic",
 		  "cpw",       settings.sBic.complexityPenaltyWeight,
 		  "inc1",      settings.sBic.incrementFirstPass,
@@ -328,7 +331,7 @@ vecReal sBic(const array2dReal &featureMatrix, const standardFactory &factory,
 		  "minLength", settings.sBic.minSegmentLengthFrames,
 		  "size1",     settings.sBic.sizeFirstPass,
 		  "size2",     settings.sBic.sizeSecondPass
-	);
+	));
 	// "cpw" 1.5, "inc1" 60, "inc2" 20, "minLength" 10, "size1" 300, size2" 200
 	vecReal segmentationVec;
 	sbic->input("features").set(featureMatrix);
@@ -341,6 +344,7 @@ vecVecReal splitWaveIntoEvents(const vecReal&wave, const vecReal&onsetsInSeconds
 							   const streamingFactory &factory,
 							   const AnalyzerSettings &settings,
 							   RunLoopStatus& rls, const ShouldExitFn &shouldExit){
+	TSN_TRACE_SPAN("splitWaveIntoEvents");
 	size_t const numOnsets {onsetsInSeconds.size()};
 	assert(numOnsets);
 	if (numOnsets == 1){	// only 1 event
@@ -30,6 +30,8 @@ vecReal calculateOnsetsInSeconds(const array2dReal &onsetAnalysisMatrix, standar
 
 vecVecReal featuresForSbic(vecReal const &waveform, AlgorithmFactory const &factory,  AnalyzerSettings const &settings,
 						   RunLoopStatus& rls, const ShouldExitFn &shouldExit);
+// featureMatrix has a row per coefficient and a column per frame (see vecVecToArray2dReal). returns the segment
+// boundaries as frame indices, including the first and last frames.
 vecReal sBic(const array2dReal &featureMatrix, standardFactory const &factory, AnalyzerSettings const &settings);
 
 vecVecReal splitWaveIntoEvents(vecReal const &wave, vecReal const &onsetsInSeconds, streamingFactory const &factory, AnalyzerSettings const &settings,
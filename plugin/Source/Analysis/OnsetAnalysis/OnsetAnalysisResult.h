@@ -15,6 +15,8 @@ struct OnsetAnalysisResult {
 
     String waveformHash {};
     String audioFileAbsPath {};
+    std::uint64_t generation {0};   // ThreadedAnalyzer request that produced this; stale results are never handed out
+    bool provisional {false};       // a coarse sketch that the full analysis of the same request will replace
 };
 
 } // namespace nvs::analysis
\ No newline at end of file
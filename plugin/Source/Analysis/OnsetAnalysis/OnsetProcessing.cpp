@@ -4,6 +4,8 @@
 
 #include "OnsetProcessing.h"
 #include <ranges>
+#include <cmath>
+#include <optional>
 #include "essentia/essentiamath.h"
 
 namespace nvs::analysis {
@@ -160,5 +162,98 @@ void denormalizeOnsets(std::vector<float> &normalizedOnsets, const double length
                           });
 }
 
+std::vector<std::pair<size_t, size_t>> eventSampleRanges(const size_t numSamples, const std::vector<float> &onsetsInSeconds,
+                                                         const double sampleRate)
+{
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (numSamples == 0 || onsetsInSeconds.empty()) {
+        return ranges;
+    }
+    if (onsetsInSeconds.size() == 1) {
+        ranges.emplace_back(0, numSamples);   // only 1 event: the whole wave
+        return ranges;
+    }
+    const auto toSample = [numSamples, sampleRate](const double seconds) {
+        return std::min(numSamples, static_cast<size_t>(std::max(0.0, std::round(seconds * sampleRate))));
+    };
+    ranges.reserve(onsetsInSeconds.size());
+    for (size_t i = 0; i < onsetsInSeconds.size(); ++i) {
+        const auto start = toSample(onsetsInSeconds[i]);
+        // the last event ends at the final sample, as in splitWaveIntoEvents
+        const auto end = i + 1 < onsetsInSeconds.size() ? toSample(onsetsInSeconds[i + 1]) : numSamples - 1;
+        ranges.emplace_back(start, std::max(start, end));
+    }
+    return ranges;
+}
+
+std::vector<std::pair<size_t, size_t>> findSilentRegions(const std::span<const float> wave, const double sampleRate,
+                                                         const double thresholdDb, const double hangoverSeconds,
+                                                         const size_t blockSize)
+{
+    std::vector<std::pair<size_t, size_t>> regions;
+    if (wave.empty() || blockSize == 0 || sampleRate <= 0.0) {
+        return regions;
+    }
+    const double thresholdGain = std::pow(10.0, thresholdDb / 20.0);
+    const double thresholdMeanSquare = thresholdGain * thresholdGain;
+    const auto hangoverBlocks = static_cast<size_t>(std::ceil(std::max(0.0, hangoverSeconds) * sampleRate / static_cast<double>(blockSize)));
+
+    size_t quietBlocks = hangoverBlocks;    // as if preceded by silence
+    std::optional<size_t> regionStart;
+    for (size_t begin = 0; begin < wave.size(); begin += blockSize) {
+        const auto end = std::min(begin + blockSize, wave.size());
+        double sumOfSquares = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            sumOfSquares += static_cast<double>(wave[i]) * static_cast<double>(wave[i]);
+        }
+        if (sumOfSquares / static_cast<double>(end - begin) < thresholdMeanSquare) {
+            if (++quietBlocks > hangoverBlocks && !regionStart.has_value()) {
+                regionStart = begin;
+            }
+        } else {
+            if (regionStart.has_value()) {
+                regions.emplace_back(*regionStart, begin);
+                regionStart.reset();
+            }
+            quietBlocks = 0;
+        }
+    }
+    if (regionStart.has_value()) {
+        regions.emplace_back(*regionStart, wave.size());
+    }
+    return regions;
+}
+
+std::vector<float> uniformOnsetsInSeconds(const double lengthInSeconds, const double dt, const double sampleRate,
+                                          const std::vector<std::pair<size_t, size_t>> &silentRegions,
+                                          std::vector<size_t> *silentEventIndices)
+{
+    std::vector<float> onsets;
+    if (lengthInSeconds <= 0.0 || dt <= 0.0) {
+        return onsets;
+    }
+    // events of at least dt from `from` up to `to`, the last one taking up the remainder
+    const auto fill = [&onsets, dt](const double from, const double to) {
+        if (from >= to) {
+            return;
+        }
+        onsets.push_back(static_cast<float>(from));
+        for (double t = from + dt; t + dt <= to; t += dt) {
+            onsets.push_back(static_cast<float>(t));
+        }
+    };
+    double soundStart = 0.0;
+    for (const auto &[begin, end] : silentRegions) {
+        const double silenceStart = static_cast<double>(begin) / sampleRate;
+        fill(soundStart, silenceStart);
+        if (silentEventIndices != nullptr) {
+            silentEventIndices->push_back(onsets.size());
+        }
+        onsets.push_back(static_cast<float>(silenceStart));
+        soundStart = static_cast<double>(end) / sampleRate;
+    }
+    fill(soundStart, lengthInSeconds);
+    return onsets;
+}
 
 }
@@ -4,6 +4,9 @@
 
 #pragma once
 #include <vector>
+#include <cstddef>
+#include <utility>
+#include <span>
 
 namespace nvs::analysis {
 
@@ -17,5 +20,23 @@ void normalizeOnsets(std::vector<float> &onsetsInSeconds, const double lengthInS
 
 void denormalizeOnsets(std::vector<float> &normalizedOnsets, const double lengthInSeconds);
 
+// [start, end) sample range of every event, matching how splitWaveIntoEvents slices the wave
+std::vector<std::pair<size_t, size_t>> eventSampleRanges(size_t numSamples, const std::vector<float> &onsetsInSeconds,
+                                                         double sampleRate);
+
+// [start, end) sample ranges where the RMS of every blockSize block stays below thresholdDb (dBFS). a region only
+// starts hangoverSeconds after the last louder block, so that decays stay with the sound they belong to; silence at
+// the very start of the wave needs no hangover. a cheap pre-pass: one sum of squares per sample.
+std::vector<std::pair<size_t, size_t>> findSilentRegions(std::span<const float> wave, double sampleRate,
+                                                         double thresholdDb, double hangoverSeconds,
+                                                         size_t blockSize = 512);
+
+// onsets every dt seconds, except that each of silentRegions (sorted, as from findSilentRegions) becomes one event of
+// its own: the sound before it ends where the silence starts, and no onsets fall inside it. the indices of those
+// silent events go to silentEventIndices, if given.
+std::vector<float> uniformOnsetsInSeconds(double lengthInSeconds, double dt, double sampleRate,
+                                          const std::vector<std::pair<size_t, size_t>> &silentRegions = {},
+                                          std::vector<size_t> *silentEventIndices = nullptr);
+
 }
 
@@ -0,0 +1,237 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "QuantizedFeatureStore.h"
+#include "TimbreAnalysis/TimbreAnalysis.h"
+#include "TsnStringAxiom.h"
+#include <Eigen/Core>
+
+namespace nvs::analysis {
+
+FeatureStorage toFeatureStorage(const juce::String &s) {
+    if (s == axiom::int16) return FeatureStorage::Int16;
+    if (s == axiom::int8)  return FeatureStorage::Int8;
+    return FeatureStorage::Float32;
+}
+juce::String toString(const FeatureStorage storage) {
+    switch (storage) {
+        case FeatureStorage::Int16: return axiom::int16;
+        case FeatureStorage::Int8:  return axiom::int8;
+        case FeatureStorage::Float32:
+        default:                    return axiom::float32;
+    }
+}
+
+namespace {
+
+float getStatistic(const EventwiseStatistics<float> &stats, const Statistic statistic) {
+    switch (statistic) {
+        case Statistic::Mean:     return stats.mean;
+        case Statistic::Median:   return stats.median;
+        case Statistic::Variance: return stats.variance;
+        case Statistic::Skewness: return stats.skewness;
+        case Statistic::Kurtosis: return stats.kurtosis;
+        default: jassertfalse;    return 0.f;
+    }
+}
+
+template<typename CodeT>
+void dequantize(const std::vector<CodeT> &codes, const size_t numEvents, const float scale, const float offset, float *dst) {
+    jassert(codes.size() == numEvents);
+    // Eigen vectorizes the widening cast and the fused multiply-add over the whole column
+    const Eigen::Map<const Eigen::Array<CodeT, Eigen::Dynamic, 1>> in(codes.data(), static_cast<Eigen::Index>(numEvents));
+    Eigen::Map<Eigen::ArrayXf> out(dst, static_cast<Eigen::Index>(numEvents));
+    out = in.template cast<float>() * scale + offset;
+}
+
+// on disk, multi-byte codes are split into byte planes (all low bytes, then all high bytes). this is endian-agnostic
+// and compresses noticeably better, since neighbouring high bytes of a smooth feature column are mostly equal.
+template<typename CodeT>
+juce::MemoryBlock compressColumn(const std::vector<CodeT> &codes) {
+    const size_t n = codes.size();
+    std::vector<uint8_t> planes(n * sizeof(CodeT));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t b = 0; b < sizeof(CodeT); ++b) {
+            planes[b * n + i] = static_cast<uint8_t>(codes[i] >> (8 * b));
+        }
+    }
+    juce::MemoryOutputStream compressed;
+    {
+        juce::GZIPCompressorOutputStream gzip(compressed, 9);
+        gzip.write(planes.data(), planes.size());
+    }
+    return compressed.getMemoryBlock();
+}
+template<typename CodeT>
+std::optional<std::vector<CodeT>> decompressColumn(const juce::MemoryBlock &block, const size_t numEvents) {
+    juce::MemoryInputStream compressed(block, false);
+    juce::GZIPDecompressorInputStream gunzip(compressed);
+    std::vector<uint8_t> planes(numEvents * sizeof(CodeT));
+    if (gunzip.read(planes.data(), static_cast<int>(planes.size())) != static_cast<int>(planes.size())) {
+        return std::nullopt;
+    }
+    std::vector<CodeT> codes(numEvents, 0);
+    for (size_t i = 0; i < numEvents; ++i) {
+        for (size_t b = 0; b < sizeof(CodeT); ++b) {
+            codes[i] |= static_cast<CodeT>(planes[b * numEvents + i] << (8 * b));
+        }
+    }
+    return codes;
+}
+template<typename CodeT>
+bool decompressInto(const juce::MemoryBlock &block, const size_t numEvents, std::vector<CodeT> &dst) {
+    auto codes = decompressColumn<CodeT>(block, numEvents);
+    if (!codes.has_value()) {
+        return false;
+    }
+    dst = std::move(*codes);
+    return true;
+}
+
+}   // anonymous namespace
+//=============================================================================================================================
+QuantizedFeatureStore QuantizedFeatureStore::fromTimbreSpace(const std::vector<FeatureContainer<EventwiseStatistics<float>>> &timbreSpace,
+                                                             const FeatureStorage storage)
+{
+    jassert(storage != FeatureStorage::Float32);
+    QuantizedFeatureStore store;
+    store._bitsPerValue = storage == FeatureStorage::Int8 ? 8 : 16;
+    store._numEvents = timbreSpace.size();
+
+    const bool wide = store._bitsPerValue == 16;
+    const auto maxCode = static_cast<float>((1 << store._bitsPerValue) - 1);
+
+    vecVecReal featureRows(store._numEvents, vecReal(static_cast<size_t>(Statistic::NumStatistics)));
+    for (int f = 0; f < static_cast<int>(Feature_e::NumFeatures); ++f) {
+        const auto feature = static_cast<Feature_e>(f);
+        // rows of (mean, median, variance, skewness, kurtosis) so that each statistic is one 'dimension'
+        for (size_t e = 0; e < store._numEvents; ++e) {
+            for (auto stat : statisticIterator()) {
+                auto v = getStatistic(timbreSpace[e][feature], stat);
+                featureRows[e][static_cast<size_t>(stat)] = std::isfinite(v) ? v : 0.f;
+            }
+        }
+        for (auto stat : statisticIterator()) {
+            auto &column = store._columns[columnIndex(feature, stat)];
+            if (wide) {
+                column.codes16.assign(store._numEvents, 0);
+            } else {
+                column.codes8.assign(store._numEvents, 0);
+            }
+            if (store._numEvents == 0) {
+                continue;
+            }
+            const auto [lo, hi] = calculateRangeOfDimension(featureRows, static_cast<size_t>(stat));
+            column.offset = lo;
+            column.scale = (hi - lo) / maxCode;
+            const float invScale = column.scale > 0.f ? 1.f / column.scale : 0.f;
+
+            for (size_t e = 0; e < store._numEvents; ++e) {
+                const auto q = juce::jlimit(0.f, maxCode, std::round((featureRows[e][static_cast<size_t>(stat)] - lo) * invScale));
+                if (wide) {
+                    column.codes16[e] = static_cast<uint16_t>(q);
+                } else {
+                    column.codes8[e] = static_cast<uint8_t>(q);
+                }
+            }
+        }
+    }
+    return store;
+}
+
+std::vector<float> QuantizedFeatureStore::getColumn(const Feature_e feature, const Statistic statistic) const {
+    std::vector<float> out(_numEvents);
+    if (_numEvents == 0) {
+        return out;
+    }
+    const auto &column = _columns[columnIndex(feature, statistic)];
+    if (_bitsPerValue == 8) {
+        dequantize(column.codes8, _numEvents, column.scale, column.offset, out.data());
+    } else {
+        dequantize(column.codes16, _numEvents, column.scale, column.offset, out.data());
+    }
+    return out;
+}
+float QuantizedFeatureStore::getValue(const size_t eventIdx, const Feature_e feature, const Statistic statistic) const {
+    jassert(eventIdx < _numEvents);
+    const auto &column = _columns[columnIndex(feature, statistic)];
+    const float code = _bitsPerValue == 8
+        ? static_cast<float>(column.codes8[eventIdx])
+        : static_cast<float>(column.codes16[eventIdx]);
+    return code * column.scale + column.offset;
+}
+size_t QuantizedFeatureStore::getResidentBytes() const noexcept {
+    size_t total = sizeof(*this);
+    for (auto const &c : _columns) {
+        total += c.codes8.capacity() * sizeof(uint8_t) + c.codes16.capacity() * sizeof(uint16_t);
+    }
+    return total;
+}
+//=============================================================================================================================
+juce::ValueTree QuantizedFeatureStore::toValueTree() const {
+    juce::ValueTree vt(axiom::QuantizedMeasurements);
+    vt.setProperty(axiom::quantBits, _bitsPerValue, nullptr);
+    vt.setProperty(axiom::quantNumEvents, static_cast<juce::int64>(_numEvents), nullptr);
+
+    for (int f = 0; f < static_cast<int>(Feature_e::NumFeatures); ++f) {
+        for (auto stat : statisticIterator()) {
+            auto const &column = _columns[columnIndex(static_cast<Feature_e>(f), stat)];
+            juce::ValueTree columnTree(axiom::QuantizedColumn);
+            columnTree.setProperty(axiom::quantFeature, f, nullptr);
+            columnTree.setProperty(axiom::quantStatistic, static_cast<int>(stat), nullptr);
+            columnTree.setProperty(axiom::quantScale, column.scale, nullptr);
+            columnTree.setProperty(axiom::quantOffset, column.offset, nullptr);
+            columnTree.setProperty(axiom::quantData, _bitsPerValue == 8 ? compressColumn(column.codes8)
+                                                                            : compressColumn(column.codes16), nullptr);
+            vt.appendChild(columnTree, nullptr);
+        }
+    }
+    return vt;
+}
+std::optional<QuantizedFeatureStore> QuantizedFeatureStore::fromValueTree(const juce::ValueTree &quantizedMeasurementsTree) {
+    if (!quantizedMeasurementsTree.hasType(axiom::QuantizedMeasurements)) {
+        return std::nullopt;
+    }
+    QuantizedFeatureStore store;
+    store._bitsPerValue = quantizedMeasurementsTree.getProperty(axiom::quantBits, 0);
+    store._numEvents = static_cast<size_t>(static_cast<juce::int64>(quantizedMeasurementsTree.getProperty(axiom::quantNumEvents, 0)));
+    if (store._bitsPerValue != 8 && store._bitsPerValue != 16) {
+        DBG("QuantizedFeatureStore: unsupported bit depth " << store._bitsPerValue);
+        return std::nullopt;
+    }
+    const bool wide = store._bitsPerValue == 16;
+    for (auto &column : store._columns) {
+        // any column missing from the file reads back as 0
+        if (wide) {
+            column.codes16.assign(store._numEvents, 0);
+        } else {
+            column.codes8.assign(store._numEvents, 0);
+        }
+    }
+
+    for (const auto &columnTree : quantizedMeasurementsTree) {
+        const int f = columnTree.getProperty(axiom::quantFeature, -1);
+        const int s = columnTree.getProperty(axiom::quantStatistic, -1);
+        if (f < 0 || f >= static_cast<int>(Feature_e::NumFeatures) || s < 0 || s >= static_cast<int>(Statistic::NumStatistics)) {
+            jassertfalse;
+            return std::nullopt;
+        }
+        const auto *block = columnTree.getProperty(axiom::quantData).getBinaryData();
+        if (block == nullptr) {
+            return std::nullopt;
+        }
+        auto &column = store._columns[columnIndex(static_cast<Feature_e>(f), static_cast<Statistic>(s))];
+        const bool decoded = wide ? decompressInto(*block, store._numEvents, column.codes16)
+                                  : decompressInto(*block, store._numEvents, column.codes8);
+        if (!decoded) {
+            DBG("QuantizedFeatureStore: truncated column " << f << "/" << s);
+            return std::nullopt;
+        }
+        column.scale = columnTree.getProperty(axiom::quantScale);
+        column.offset = columnTree.getProperty(axiom::quantOffset);
+    }
+    return store;
+}
+
+}   // namespace nvs::analysis
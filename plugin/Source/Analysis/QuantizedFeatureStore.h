@@ -0,0 +1,58 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include "Features.h"
+#include "Statistics.h"
+#include <JuceHeader.h>
+
+namespace nvs::analysis {
+
+enum class FeatureStorage {
+    Float32,    // one float per (event, feature, statistic); the original TimbreMeasurements tree
+    Int16,
+    Int8
+};
+FeatureStorage toFeatureStorage(const juce::String &s);
+juce::String toString(FeatureStorage storage);
+
+/**
+ * Column-major, quantized store of every (feature, statistic) pair for every event.
+ * Each column gets its own scale and offset derived from its range, so the codes span the full integer range of the
+ * chosen bit depth. On disk (as a ValueTree) each column is gzip-compressed as its own block; in memory the codes stay
+ * uncompressed and are only dequantized, column by column, when a view asks for them.
+ */
+class QuantizedFeatureStore {
+public:
+    static constexpr size_t NumColumns = static_cast<size_t>(Feature_e::NumFeatures) * static_cast<size_t>(Statistic::NumStatistics);
+
+    static QuantizedFeatureStore fromTimbreSpace(const std::vector<FeatureContainer<EventwiseStatistics<float>>> &timbreSpace,
+                                                 FeatureStorage storage);
+    static std::optional<QuantizedFeatureStore> fromValueTree(const juce::ValueTree &quantizedMeasurementsTree);
+    juce::ValueTree toValueTree() const;
+    //=============================================================================================================================
+    std::vector<float> getColumn(Feature_e feature, Statistic statistic) const;
+    float getValue(size_t eventIdx, Feature_e feature, Statistic statistic) const;
+
+    size_t getNumEvents() const noexcept { return _numEvents; }
+    int getBitsPerValue() const noexcept { return _bitsPerValue; }
+    size_t getResidentBytes() const noexcept;
+private:
+    struct Column {
+        float scale {0.f};
+        float offset {0.f};
+        // _numEvents codes, in whichever of these matches _bitsPerValue; the other stays empty
+        std::vector<uint8_t> codes8;
+        std::vector<uint16_t> codes16;
+    };
+    static size_t columnIndex(Feature_e feature, Statistic statistic) {
+        return static_cast<size_t>(feature) * static_cast<size_t>(Statistic::NumStatistics) + static_cast<size_t>(statistic);
+    }
+
+    int _bitsPerValue {16};
+    size_t _numEvents {0};
+    std::array<Column, NumColumns> _columns {};
+};
+
+}   // namespace nvs::analysis
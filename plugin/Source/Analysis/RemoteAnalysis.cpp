@@ -0,0 +1,325 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "Analysis/RemoteAnalysis.h"
+
+namespace nvs::analysis::remote {
+
+namespace {
+// message types
+const juce::Identifier AnalysisRequestType {"AnalysisRequest"};
+const juce::Identifier CancelRequestType {"CancelRequest"};
+const juce::Identifier ProgressType {"Progress"};
+const juce::Identifier OnsetResultType {"OnsetResult"};
+const juce::Identifier TimbreResultType {"TimbreResult"};
+const juce::Identifier FinishedType {"Finished"};
+// properties
+const juce::Identifier generationProp {"generation"};
+const juce::Identifier waveFileProp {"waveFile"};
+const juce::Identifier numSamplesProp {"numSamples"};
+const juce::Identifier audioFileAbsPathProp {"audioFileAbsPath"};
+const juce::Identifier waveformHashProp {"waveformHash"};
+const juce::Identifier dataProp {"data"};
+const juce::Identifier numEventsProp {"numEvents"};
+const juce::Identifier stageProp {"stage"};
+const juce::Identifier completedProp {"completed"};
+const juce::Identifier totalProp {"total"};
+const juce::Identifier errorProp {"error"};
+
+constexpr size_t valuesPerEvent = static_cast<size_t>(Feature_e::NumFeatures) * 5;     // mean, median, variance, skewness, kurtosis
+constexpr int pollIntervalMs = 20;
+
+juce::ValueTree makeMessage(const juce::Identifier &type, const std::uint64_t generation) {
+    juce::ValueTree vt(type);
+    setGeneration(vt, generation);
+    return vt;
+}
+juce::MemoryBlock toBlock(const std::vector<float> &v) {
+    return {v.data(), v.size() * sizeof(float)};
+}
+std::vector<float> fromBlock(const juce::var &v) {
+    const auto *block = v.getBinaryData();
+    if (block == nullptr) {
+        return {};
+    }
+    std::vector<float> out(block->getSize() / sizeof(float));
+    block->copyTo(out.data(), 0, out.size() * sizeof(float));
+    return out;
+}
+}   // anonymous namespace
+//=============================================================================================================================
+juce::MemoryBlock encode(const juce::ValueTree &message) {
+    juce::MemoryOutputStream mos;
+    message.writeToStream(mos);
+    return mos.getMemoryBlock();
+}
+juce::ValueTree decode(const juce::MemoryBlock &block) {
+    return juce::ValueTree::readFromData(block.getData(), block.getSize());
+}
+
+juce::ValueTree makeAnalysisRequest(const std::uint64_t generation, const juce::File &waveFile, const size_t numSamples,
+                                    const juce::String &audioFileAbsPath, const juce::ValueTree &settingsAndFileInfo)
+{
+    auto vt = makeMessage(AnalysisRequestType, generation);
+    vt.setProperty(waveFileProp, waveFile.getFullPathName(), nullptr);
+    vt.setProperty(numSamplesProp, static_cast<juce::int64>(numSamples), nullptr);
+    vt.setProperty(audioFileAbsPathProp, audioFileAbsPath, nullptr);
+    vt.appendChild(settingsAndFileInfo.createCopy(), nullptr);
+    return vt;
+}
+juce::ValueTree makeCancelRequest(const std::uint64_t generation) {
+    return makeMessage(CancelRequestType, generation);
+}
+juce::ValueTree makeProgress(const std::uint64_t generation, const RunLoopStatus::Snapshot &snapshot) {
+    auto vt = makeMessage(ProgressType, generation);
+    vt.setProperty(stageProp, static_cast<int>(snapshot.stage), nullptr);
+    vt.setProperty(completedProp, static_cast<juce::int64>(snapshot.completed), nullptr);
+    vt.setProperty(totalProp, static_cast<juce::int64>(snapshot.total), nullptr);
+    return vt;
+}
+juce::ValueTree makeOnsetResult(const OnsetAnalysisResult &result) {
+    auto vt = makeMessage(OnsetResultType, result.generation);
+    vt.setProperty(waveformHashProp, result.waveformHash, nullptr);
+    vt.setProperty(audioFileAbsPathProp, result.audioFileAbsPath, nullptr);
+    vt.setProperty(dataProp, toBlock(result.onsets), nullptr);
+    return vt;
+}
+juce::ValueTree makeTimbreResult(const TimbreAnalysisResult &result) {
+    auto vt = makeMessage(TimbreResultType, result.generation);
+    vt.setProperty(waveformHashProp, result.waveformHash, nullptr);
+    vt.setProperty(audioFileAbsPathProp, result.audioFileAbsPath, nullptr);
+    vt.setProperty(numEventsProp, static_cast<juce::int64>(result.timbreMeasurements.size()), nullptr);
+
+    std::vector<float> flat;
+    flat.reserve(result.timbreMeasurements.size() * valuesPerEvent);
+    for (auto const &event : result.timbreMeasurements) {
+        for (auto const &s : event.features) {
+            flat.insert(flat.end(), {s.mean, s.median, s.variance, s.skewness, s.kurtosis});
+        }
+    }
+    vt.setProperty(dataProp, toBlock(flat), nullptr);
+    return vt;
+}
+juce::ValueTree makeFinished(const std::uint64_t generation, const juce::String &error) {
+    auto vt = makeMessage(FinishedType, generation);
+    if (error.isNotEmpty()) {
+        vt.setProperty(errorProp, error, nullptr);
+    }
+    return vt;
+}
+//=============================================================================================================================
+std::optional<AnalysisRequest> readAnalysisRequest(const juce::ValueTree &message) {
+    if (!isAnalysisRequest(message) || message.getNumChildren() != 1) {
+        return std::nullopt;
+    }
+    const juce::String path = message.getProperty(waveFileProp);
+    if (!juce::File::isAbsolutePath(path)) {
+        return std::nullopt;
+    }
+    return AnalysisRequest {
+        getGeneration(message),
+        juce::File(path),
+        static_cast<size_t>(static_cast<juce::int64>(message.getProperty(numSamplesProp))),
+        message.getProperty(audioFileAbsPathProp).toString(),
+        message.getChild(0)
+    };
+}
+std::shared_ptr<OnsetAnalysisResult> readOnsetResult(const juce::ValueTree &message) {
+    if (!isOnsetResult(message)) {
+        return nullptr;
+    }
+    auto result = std::make_shared<OnsetAnalysisResult>(fromBlock(message.getProperty(dataProp)),
+                                                        message.getProperty(waveformHashProp).toString(),
+                                                        message.getProperty(audioFileAbsPathProp).toString());
+    result->generation = getGeneration(message);
+    return result;
+}
+std::optional<TimbreAnalysisResult> readTimbreResult(const juce::ValueTree &message) {
+    if (!isTimbreResult(message)) {
+        return std::nullopt;
+    }
+    const auto numEvents = static_cast<size_t>(static_cast<juce::int64>(message.getProperty(numEventsProp)));
+    const auto flat = fromBlock(message.getProperty(dataProp));
+    if (flat.size() != numEvents * valuesPerEvent) {
+        jassertfalse;
+        return std::nullopt;
+    }
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> measurements(numEvents);
+    auto it = flat.begin();
+    for (auto &event : measurements) {
+        for (auto &s : event.features) {
+            s = { it[0], it[1], it[2], it[3], it[4] };
+            it += 5;
+        }
+    }
+    TimbreAnalysisResult result(std::move(measurements),
+                                message.getProperty(waveformHashProp).toString(),
+                                message.getProperty(audioFileAbsPathProp).toString());
+    result.generation = getGeneration(message);
+    return result;
+}
+
+bool isAnalysisRequest(const juce::ValueTree &message) { return message.hasType(AnalysisRequestType); }
+bool isCancelRequest(const juce::ValueTree &message)   { return message.hasType(CancelRequestType); }
+bool isProgress(const juce::ValueTree &message)        { return message.hasType(ProgressType); }
+bool isOnsetResult(const juce::ValueTree &message)     { return message.hasType(OnsetResultType); }
+bool isTimbreResult(const juce::ValueTree &message)    { return message.hasType(TimbreResultType); }
+bool isFinished(const juce::ValueTree &message)        { return message.hasType(FinishedType); }
+
+std::uint64_t getGeneration(const juce::ValueTree &message) {
+    return static_cast<std::uint64_t>(static_cast<juce::int64>(message.getProperty(generationProp, 0)));
+}
+void setGeneration(juce::ValueTree &message, const std::uint64_t generation) {
+    message.setProperty(generationProp, static_cast<juce::int64>(generation), nullptr);
+}
+void setAudioFileAbsPath(juce::ValueTree &message, const juce::String &audioFileAbsPath) {
+    message.setProperty(audioFileAbsPathProp, audioFileAbsPath, nullptr);
+}
+juce::String getError(const juce::ValueTree &message) {
+    return message.getProperty(errorProp).toString();
+}
+RunLoopStatus::Snapshot readProgress(const juce::ValueTree &message) {
+    RunLoopStatus::Snapshot s;
+    const int stage = message.getProperty(stageProp, 0);
+    s.stage = static_cast<RunLoopStatus::Stage>(juce::jlimit(0, static_cast<int>(RunLoopStatus::Stage::BicSegmentation), stage));
+    s.completed = static_cast<juce::uint64>(static_cast<juce::int64>(message.getProperty(completedProp, 0)));
+    s.total = static_cast<juce::uint64>(static_cast<juce::int64>(message.getProperty(totalProp, 0)));
+    s.active = true;
+    return s;
+}
+//=============================================================================================================================
+RemoteAnalysisClient::~RemoteAnalysisClient() {
+    killWorkerProcess();
+}
+
+juce::File RemoteAnalysisClient::findWorkerExecutable() {
+    const auto env = juce::SystemStats::getEnvironmentVariable("TSN_ANALYSIS_WORKER", {}).trim();
+    if (env.isEmpty() || env == "0") {
+        return {};
+    }
+    if (juce::File::isAbsolutePath(env)) {
+        const juce::File f(env);
+        return f.existsAsFile() ? f : juce::File();
+    }
+    // next to the plugin binary (currentExecutableFile is the plugin itself, not the host)
+    const auto dir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+    for (auto const &name : { "tsn-analysis-worker", "tsn-analysis-worker.exe" }) {
+        if (const auto f = dir.getChildFile(name); f.existsAsFile()) {
+            return f;
+        }
+    }
+    return {};
+}
+
+bool RemoteAnalysisClient::ensureLaunched() {
+    if (_connected.load()) {
+        return true;
+    }
+    if (_launchFailed) {
+        return false;
+    }
+    const auto exe = findWorkerExecutable();
+    if (exe == juce::File() || !launchWorkerProcess(exe, commandLineUID, 5000)) {
+        DBG("RemoteAnalysisClient: could not launch worker; analysing in-process");
+        _launchFailed = true;
+        return false;
+    }
+    _connected.store(true);
+    return true;
+}
+
+void RemoteAnalysisClient::handleMessageFromWorker(const juce::MemoryBlock &block) {
+    // arrives on the connection's own thread
+    if (auto message = decode(block); message.isValid()) {
+        {
+            const juce::ScopedLock sl(_inboxLock);
+            _inbox.push_back(std::move(message));
+        }
+        _messageArrived.signal();
+    }
+}
+void RemoteAnalysisClient::handleConnectionLost() {
+    _connected.store(false);
+    _messageArrived.signal();
+}
+std::optional<juce::ValueTree> RemoteAnalysisClient::popMessage() {
+    const juce::ScopedLock sl(_inboxLock);
+    if (_inbox.empty()) {
+        return std::nullopt;
+    }
+    auto m = std::move(_inbox.front());
+    _inbox.pop_front();
+    return m;
+}
+
+auto RemoteAnalysisClient::run(const std::uint64_t generation, const std::span<const float> wave,
+                               const juce::String &audioFileAbsPath, const juce::ValueTree &settingsAndFileInfo,
+                               RunLoopStatus &rls, const ShouldExitFn &shouldExit, const Callbacks &callbacks) -> Outcome
+{
+    if (!ensureLaunched()) {
+        return Outcome::Unavailable;
+    }
+    // the 'shared memory': written once here, memory-mapped read-only by the worker
+    const juce::TemporaryFile waveFile(".f32");
+    if (!waveFile.getFile().replaceWithData(wave.data(), wave.size_bytes())) {
+        return Outcome::Unavailable;
+    }
+    {
+        const juce::ScopedLock sl(_inboxLock);
+        _inbox.clear();     // anything left over belongs to a job we already gave up on
+    }
+    if (!sendMessageToWorker(encode(makeAnalysisRequest(generation, waveFile.getFile(), wave.size(), audioFileAbsPath, settingsAndFileInfo)))) {
+        return Outcome::Unavailable;
+    }
+
+    RunLoopStatus::Stage stage {RunLoopStatus::Stage::Idle};
+    juce::uint64 completed {0};
+    while (true) {
+        if (shouldExit()) {
+            sendMessageToWorker(encode(makeCancelRequest(generation)));
+            return Outcome::Cancelled;
+        }
+        if (!_connected.load()) {
+            return Outcome::Unavailable;
+        }
+        const auto message = popMessage();
+        if (!message.has_value()) {
+            _messageArrived.wait(pollIntervalMs);
+            continue;
+        }
+        if (getGeneration(*message) != generation) {
+            continue;
+        }
+        if (isProgress(*message)) {
+            const auto p = readProgress(*message);
+            if (p.stage != stage) {
+                stage = p.stage;
+                completed = 0;
+                rls.beginStage(stage, p.total);
+            }
+            if (p.completed > completed) {
+                rls.advance(p.completed - completed);
+                completed = p.completed;
+            }
+        }
+        else if (isOnsetResult(*message)) {
+            if (auto onsets = readOnsetResult(*message); onsets != nullptr && callbacks.onOnsets) {
+                callbacks.onOnsets(std::move(onsets));
+            }
+        }
+        else if (isTimbreResult(*message)) {
+            if (auto timbre = readTimbreResult(*message); timbre.has_value() && callbacks.onTimbre) {
+                callbacks.onTimbre(std::move(*timbre));
+            }
+        }
+        else if (isFinished(*message)) {
+            if (const auto error = getError(*message); error.isNotEmpty()) {
+                DBG("RemoteAnalysisClient: worker reported: " << error);
+            }
+            return Outcome::Completed;
+        }
+    }
+}
+
+}   // namespace nvs::analysis::remote
@@ -0,0 +1,111 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include <deque>
+#include "Analysis/AnalysisUsing.h"
+#include "Analysis/RunLoopStatus.h"
+#include "Analysis/Features.h"
+#include "Analysis/Statistics.h"
+#include "Analysis/OnsetAnalysis/OnsetAnalysisResult.h"
+#include "Analysis/TimbreAnalysis/TimbreAnalysisResult.h"
+
+/**
+ * Optional out-of-process analysis.
+ *
+ * The plugin launches tsn-analysis-worker (see tools/analysis_worker) as a child process and talks to it over JUCE's
+ * coordinator/worker pipe. Audio does not travel over the pipe: the host writes it once to a temporary file that the
+ * worker memory-maps. Each message is a binary-serialized ValueTree; see the make* / read* helpers below for the
+ * complete protocol. Crashes or Essentia exceptions in the worker cannot take the host down, the worker may use every
+ * core at normal priority, and it keeps an on-disk result cache shared by every host process on the machine.
+ *
+ * Enabled by setting the TSN_ANALYSIS_WORKER environment variable, either to the worker executable's path or to "1" to
+ * look for it next to the plugin binary. If the worker cannot be launched, or dies mid-job, analysis silently falls
+ * back to the in-process path.
+ */
+namespace nvs::analysis::remote {
+
+inline constexpr const char *commandLineUID = "tsn-analysis-worker";
+
+juce::MemoryBlock encode(const juce::ValueTree &message);
+juce::ValueTree decode(const juce::MemoryBlock &block);
+
+// host -> worker
+// settingsAndFileInfo: a tree holding copies of the Settings and FileInfo branches, as ThreadedAnalyzer::requestAnalysis expects
+juce::ValueTree makeAnalysisRequest(std::uint64_t generation, const juce::File &waveFile, size_t numSamples,
+                                    const juce::String &audioFileAbsPath, const juce::ValueTree &settingsAndFileInfo);
+juce::ValueTree makeCancelRequest(std::uint64_t generation);
+// worker -> host
+juce::ValueTree makeProgress(std::uint64_t generation, const RunLoopStatus::Snapshot &snapshot);
+juce::ValueTree makeOnsetResult(const OnsetAnalysisResult &result);
+juce::ValueTree makeTimbreResult(const TimbreAnalysisResult &result);
+juce::ValueTree makeFinished(std::uint64_t generation, const juce::String &error = {});
+
+struct AnalysisRequest {
+    std::uint64_t generation;
+    juce::File waveFile;
+    size_t numSamples;
+    juce::String audioFileAbsPath;
+    juce::ValueTree settingsAndFileInfo;
+};
+std::optional<AnalysisRequest> readAnalysisRequest(const juce::ValueTree &message);
+std::shared_ptr<OnsetAnalysisResult> readOnsetResult(const juce::ValueTree &message);
+std::optional<TimbreAnalysisResult> readTimbreResult(const juce::ValueTree &message);
+
+bool isAnalysisRequest(const juce::ValueTree &message);
+bool isCancelRequest(const juce::ValueTree &message);
+bool isProgress(const juce::ValueTree &message);
+bool isOnsetResult(const juce::ValueTree &message);
+bool isTimbreResult(const juce::ValueTree &message);
+bool isFinished(const juce::ValueTree &message);
+std::uint64_t getGeneration(const juce::ValueTree &message);
+// for re-sending a cached result
+void setGeneration(juce::ValueTree &message, std::uint64_t generation);
+void setAudioFileAbsPath(juce::ValueTree &message, const juce::String &audioFileAbsPath);
+juce::String getError(const juce::ValueTree &message);
+RunLoopStatus::Snapshot readProgress(const juce::ValueTree &message);
+
+//=============================================================================================================================
+/**
+ * Host side. Owned by ThreadedAnalyzer and only ever used from its worker thread; run() blocks that thread until the
+ * remote job completes, is cancelled, or the worker becomes unavailable.
+ */
+class RemoteAnalysisClient final : private juce::ChildProcessCoordinator
+{
+public:
+    enum class Outcome {
+        Completed,      // a result (possibly empty, e.g. zero onsets) or an error was reported by the worker
+        Cancelled,      // shouldExit fired; the worker was told to drop the job
+        Unavailable     // no worker, or it died: the caller should analyse in-process instead
+    };
+    struct Callbacks {
+        std::function<void(std::shared_ptr<OnsetAnalysisResult>)> onOnsets;
+        std::function<void(TimbreAnalysisResult)> onTimbre;
+    };
+    RemoteAnalysisClient() = default;
+    ~RemoteAnalysisClient() override;
+
+    // invalid if out-of-process analysis is not enabled, or the executable cannot be found
+    static juce::File findWorkerExecutable();
+
+    Outcome run(std::uint64_t generation, std::span<const float> wave, const juce::String &audioFileAbsPath,
+                const juce::ValueTree &settingsAndFileInfo, RunLoopStatus &rls, const ShouldExitFn &shouldExit,
+                const Callbacks &callbacks);
+private:
+    void handleMessageFromWorker(const juce::MemoryBlock &block) override;
+    void handleConnectionLost() override;
+    bool ensureLaunched();
+    std::optional<juce::ValueTree> popMessage();
+
+    juce::CriticalSection _inboxLock;
+    std::deque<juce::ValueTree> _inbox;
+    juce::WaitableEvent _messageArrived;
+    std::atomic<bool> _connected {false};
+    bool _launchFailed {false};     // don't retry a missing or broken executable on every job
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RemoteAnalysisClient)
+};
+
+}   // namespace nvs::analysis::remote
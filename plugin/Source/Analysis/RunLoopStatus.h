@@ -15,26 +15,102 @@ namespace nvs::analysis {
 
 // helpers needed for running long analyses with communication to other structures
 
-class RunLoopStatus 	:	public juce::ChangeBroadcaster
+/**
+ * Lock-free progress record for long-running work. Workers (any thread, including pool threads) only ever touch
+ * relaxed atomics; nothing is broadcast. Consumers such as the GUI sample() it at whatever rate suits them.
+ * The human-readable message is derived from the stage ID, so no string is ever shared between threads.
+ */
+class RunLoopStatus
 {
 public:
-	void set(const juce::String &newMessage){
-		message = newMessage;
-		sendChangeMessage();
+	enum class Stage {
+		Idle,
+		OnsetMatrix,
+		OnsetsInSeconds,
+		SplittingEvents,
+		EventDescriptors,
+		WritingEvents,
+		ProvisionalMap,
+		FrameDescriptors,
+		BicSegmentation
+	};
+	static const char *toString(const Stage stage) {
+		switch (stage) {
+			case Stage::OnsetMatrix:        return "Computing onset matrix...";
+			case Stage::OnsetsInSeconds:    return "Calculating onsets...";
+			case Stage::SplittingEvents:    return "Splitting wave into events...";
+			case Stage::EventDescriptors:   return "Calculating timbre descriptions per event...";
+			case Stage::WritingEvents:      return "Writing events...";
+			case Stage::ProvisionalMap:     return "Sketching timbre space...";
+			case Stage::FrameDescriptors:   return "Calculating timbre descriptions per frame...";
+			case Stage::BicSegmentation:    return "Segmenting by timbre change...";
+			case Stage::Idle:
+			default:                        return "";
+		}
 	}
-	void set(const double newProgress){
-		progress = newProgress;
-		sendChangeMessage();
+	struct Snapshot {
+		Stage stage {Stage::Idle};
+		bool active {false};
+		juce::uint64 completed {0};
+		juce::uint64 total {0};			// 0: indeterminate
+		juce::uint64 bytesProcessed {0};
+		double progress {0.0};			// [0, 1]
+		double etaSeconds {-1.0};		// < 0: unknown
+		juce::String getMessage() const { return toString(stage); }
+	};
+	//=============================================================================================================================
+	// worker side
+	void beginStage(const Stage stage, const juce::uint64 total = 0) noexcept {
+		_completed.store(0, std::memory_order_relaxed);
+		_bytesProcessed.store(0, std::memory_order_relaxed);
+		_total.store(total, std::memory_order_relaxed);
+		_stageStartMs.store(juce::Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+		_stage.store(stage, std::memory_order_relaxed);
+		_active.store(true, std::memory_order_relaxed);
 	}
-	double getProgress() const {
-		return progress.load();
+	void advance(const juce::uint64 numCompleted = 1, const juce::uint64 numBytes = 0) noexcept {
+		_completed.fetch_add(numCompleted, std::memory_order_relaxed);
+		if (numBytes) {
+			_bytesProcessed.fetch_add(numBytes, std::memory_order_relaxed);
+		}
 	}
-	juce::String getMessage() const {
-		return message;
+	void finish() noexcept {
+		_active.store(false, std::memory_order_relaxed);
+		_stage.store(Stage::Idle, std::memory_order_relaxed);
+	}
+	//=============================================================================================================================
+	// reader side. fields are read independently, so a sample straddling beginStage() may mix stages for one frame;
+	// that is harmless for display purposes.
+	Snapshot sample() const noexcept {
+		Snapshot s;
+		s.stage = _stage.load(std::memory_order_relaxed);
+		s.active = _active.load(std::memory_order_relaxed);
+		s.completed = _completed.load(std::memory_order_relaxed);
+		s.total = _total.load(std::memory_order_relaxed);
+		s.bytesProcessed = _bytesProcessed.load(std::memory_order_relaxed);
+		if (s.total > 0) {
+			s.completed = std::min(s.completed, s.total);
+			s.progress = static_cast<double>(s.completed) / static_cast<double>(s.total);
+			if (s.completed > 0) {
+				const double elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - _stageStartMs.load(std::memory_order_relaxed)) * 0.001;
+				s.etaSeconds = elapsedSeconds * static_cast<double>(s.total - s.completed) / static_cast<double>(s.completed);
+			}
+		}
+		return s;
+	}
+	double getProgress() const noexcept {
+		return sample().progress;
+	}
+	bool isActive() const noexcept {
+		return _active.load(std::memory_order_relaxed);
 	}
 private:
-	juce::String message {""};	// ideally should have thread-safe alternative
-	std::atomic<double> progress {0.0};
+	std::atomic<Stage> _stage {Stage::Idle};
+	std::atomic<bool> _active {false};
+	std::atomic<juce::uint64> _completed {0};
+	std::atomic<juce::uint64> _total {0};
+	std::atomic<juce::uint64> _bytesProcessed {0};
+	std::atomic<double> _stageStartMs {0.0};
 };
 using ShouldExitFn = std::function<bool(void)>;
 
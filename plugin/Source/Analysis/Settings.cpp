@@ -10,7 +10,7 @@
 
 #include "Settings.h"
 #include "Analyzer.h"
-#include "StringAxiom.h"
+#include "TsnStringAxiom.h"
 
 namespace nvs::analysis {
 
@@ -35,7 +35,9 @@ const std::map<juce::String, AnySpec> analysisSpecs
 		axiom::triangular, axiom::square, axiom::blackmanharris62, axiom::blackmanharris70,
 		axiom::blackmanharris74, 	axiom::blackmanharris92}, /* default: */		axiom::hann 		} },
     { axiom::numThreads, RangedSettingsSpec<int>{NormalisableRange<double>(1, SystemStats::getNumCpus()), SystemStats::getNumPhysicalCpus(),
-        "The number of threads used for timbral analysis. Higher # of threads => faster analysis, but limited testing has been done for greater than 1 thread."}}
+        "The number of threads used for timbral analysis. Higher # of threads => faster analysis, but limited testing has been done for greater than 1 thread."}},
+    { axiom::featureStorage, ChoiceSettingsSpec{ {axiom::float32, axiom::int16, axiom::int8}, axiom::float32,
+        "How eventwise features are stored in memory and in analysis files. The int options quantize each feature column to 16 or 8 bits and compress it on disk, for large sample libraries."} }
 };
 
 const std::map<juce::String, AnySpec> bfccSpecs
@@ -66,8 +68,8 @@ const std::map<juce::String, AnySpec> bfccSpecs
 
 const std::map<juce::String, AnySpec> onsetSpecs
 {
-    { axiom::segmentation, ChoiceSettingsSpec {{axiom::Event, axiom::Uniform}, axiom::Event,
-        "whether to segment by detected events or uniform frames"} },
+    { axiom::segmentation, ChoiceSettingsSpec {{axiom::Event, axiom::Uniform, axiom::Bic}, axiom::Event,
+        "whether to segment by detected events, uniform frames, or changes in timbre (BIC; suits drones and textures)"} },
 	{ axiom::silenceThreshold,         RangedSettingsSpec<double>{ {0.0,1.0,0.01f,0.4}, 0.1f,
 	    "the threshold for silence"} },
 	{ axiom::alpha,                    RangedSettingsSpec<double>{ {0.0,1.0,0.01f,0.4}, 0.1f,
@@ -83,7 +85,13 @@ const std::map<juce::String, AnySpec> onsetSpecs
 	{ axiom::weight_flux,              RangedSettingsSpec<double>{ {0.0,1.0,0.01f,1.0},  0.0,
 	    "the Spectral Flux detection function which characterizes changes in magnitude spectrum." } },
 	{ axiom::weight_rms,               RangedSettingsSpec<double>{ {0.0,1.0,0.01f,1.0},  0.0,
-	    "the difference function, measuring the half-rectified change of the RMS of the magnitude spectrum (i.e., measuring overall energy flux)" } }
+	    "the difference function, measuring the half-rectified change of the RMS of the magnitude spectrum (i.e., measuring overall energy flux)" } },
+	{ axiom::silenceGate,              BoolSettingsSpec{false,
+	    "Uniform segmentation only: make each stretch of silence a single event, rather than many near-identical ones, and analyse only its beginning."} },
+	{ axiom::silenceGateThreshold,     RangedSettingsSpec<double>{ {-120.0,0.0,0.5f,1.0}, -60.0,
+	    "the level below which audio counts as silence", 1, "dB"} },
+	{ axiom::silenceGateHangover,      RangedSettingsSpec<double>{ {0.0,2000.0,1.0f,0.5}, 250.0,
+	    "how long audio must stay below the threshold before it counts as silence, so that decays are kept", 0, "ms"} }
 };
 
 const std::map<juce::String, AnySpec> sBicSpecs
@@ -116,6 +124,15 @@ const std::map<juce::String, AnySpec> splitSpecs
 	{ axiom::fadeOutSamps, RangedSettingsSpec<int>{ {0,10000,1,1}, 5 } }
 };
 
+// not a branch of the settings tree: these live in the ViewSettings tree (see ensureViewSettings)
+const std::map<juce::String, AnySpec> viewSpecs
+{
+    { axiom::duplicateTolerance, RangedSettingsSpec<double>{ {0.0, 0.1, 0.001, 0.5}, 0.0,
+        "Points of the timbre space closer than this (per dimension, on the normalized axes) are merged into one, which plays its events in turn. Shrinks the triangulation of dense, sustained material. 0 keeps every point.", 3} },
+    { axiom::lazyFeatures, BoolSettingsSpec{false,
+        "Compute the features used by the timbre space axes and the filter first, and the rest afterwards in the background. The analysis can be saved once every feature is in."} }
+};
+
 const std::map<juce::String, const std::map<juce::String,AnySpec>*>
 	specsByBranch
 {
@@ -171,6 +188,27 @@ void initializeSettingsBranches(juce::ValueTree& settingsVT, const bool dbg){
 	}
 }
 
+void ensureViewSettings (juce::ValueTree& stateVT) {
+	auto viewVT = stateVT.getOrCreateChildWithName (axiom::ViewSettings, nullptr);
+	// these were briefly analysis settings; moved out, they no longer change the analysis settings hash
+	auto analysisVT = stateVT.getChildWithName (axiom::Settings).getChildWithName (axiom::Analysis);
+	for (const auto *propName : { axiom::duplicateTolerance, axiom::lazyFeatures }) {
+		if (analysisVT.hasProperty (propName)) {
+			if (!viewVT.hasProperty (propName)) {
+				viewVT.setProperty (propName, analysisVT.getProperty (propName), nullptr);
+			}
+			analysisVT.removeProperty (propName, nullptr);
+		}
+	}
+	for (const auto& [propName, viewSpec] : viewSpecs) {
+		if (!viewVT.hasProperty (propName)) {
+			std::visit ([&]<typename T0>(T0&& spec){
+				viewVT.setProperty (propName, spec.defaultValue, nullptr);
+			}, viewSpec);
+		}
+	}
+}
+
 bool verifySettingsStructure (const juce::ValueTree& settingsVT)
 {
 	if (! settingsVT.isValid()){
@@ -273,6 +311,7 @@ bool updateSettingsFromValueTree(AnalyzerSettings& settings, const juce::ValueTr
     settings.analysis.hopSize = analysisNode.getProperty(axiom::hopSize);
     settings.analysis.windowingType = analysisNode.getProperty(axiom::windowingType).toString();
     settings.analysis.numThreads = analysisNode.getProperty(axiom::numThreads);
+    settings.analysis.featureStorage = toFeatureStorage(analysisNode.getProperty(axiom::featureStorage, axiom::float32).toString());
 
     // BFCC settings
     auto bfccNode = settingsTree.getChildWithName(axiom::BFCC);
@@ -322,7 +361,9 @@ bool updateSettingsFromValueTree(AnalyzerSettings& settings, const juce::ValueTr
     }
     if (onsetNode.hasProperty(axiom::segmentation)) {
         const auto segmentationStr = onsetNode.getProperty(axiom::segmentation).toString();
-        settings.onset.segmentation = segmentationStr == axiom::Uniform ? AnalyzerSettings::Onset::Segmentation::Uniform : AnalyzerSettings::Onset::Segmentation::Event;
+        settings.onset.segmentation = segmentationStr == axiom::Uniform ? AnalyzerSettings::Onset::Segmentation::Uniform
+                                    : segmentationStr == axiom::Bic     ? AnalyzerSettings::Onset::Segmentation::Bic
+                                    :                                     AnalyzerSettings::Onset::Segmentation::Event;
     } else {
         settings.onset.segmentation = AnalyzerSettings::Onset::Segmentation::Event;
         DBG(juce::String("No property ") + axiom::segmentation + " found in settingsTree\n");
@@ -335,6 +376,9 @@ bool updateSettingsFromValueTree(AnalyzerSettings& settings, const juce::ValueTr
 	settings.onset.weight_flux = onsetNode.getProperty(axiom::weight_flux);
 	settings.onset.weight_hfc = onsetNode.getProperty(axiom::weight_hfc);
 	settings.onset.weight_rms = onsetNode.getProperty(axiom::weight_rms);
+	settings.onset.silenceGate = onsetNode.getProperty(axiom::silenceGate, false);
+	settings.onset.silenceGateThreshold = onsetNode.getProperty(axiom::silenceGateThreshold, -60.0);
+	settings.onset.silenceGateHangover = onsetNode.getProperty(axiom::silenceGateHangover, 250.0);
 	
 	// Pitch settings
 	auto pitchNode = settingsTree.getChildWithName(axiom::Pitch);
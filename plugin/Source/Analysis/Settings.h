@@ -10,6 +10,7 @@
 
 #pragma once
 #include "essentia/types.h"
+#include "QuantizedFeatureStore.h"
 #include <JuceHeader.h>
 
 namespace nvs::analysis {
@@ -18,6 +19,10 @@ void ensureBranchAndInitializeDefaults (juce::ValueTree& settingsVT, const juce:
 void initializeSettingsBranches(juce::ValueTree& settingsVT, bool dbg=true);
 bool verifySettingsStructure (const juce::ValueTree& settingsVT);
 bool verifySettingsStructureWithAttemptedFix (juce::ValueTree& settingsVT);
+// creates stateVT's ViewSettings child with any missing viewSpecs defaults. settings of how the analysis is viewed (or
+// scheduled) live there rather than in the analysis settings, so that changing them leaves analysis caches and saved
+// analyses valid.
+void ensureViewSettings (juce::ValueTree& stateVT);
 
 template<typename T>
 struct RangedSettingsSpec
@@ -49,7 +54,7 @@ using AnySpec = std::variant<
 >;
 
 // defined in .cpp to avoid circular include (issue was just with calling nvs::analysis::buildFeatureChoiceVec, but this allows consistency)
-extern const std::map<juce::String, AnySpec> analysisSpecs, bfccSpecs, onsetSpecs, sBicSpecs, pitchSpecs, splitSpecs, timbreSpaceSpecs;
+extern const std::map<juce::String, AnySpec> analysisSpecs, bfccSpecs, onsetSpecs, sBicSpecs, pitchSpecs, splitSpecs, timbreSpaceSpecs, viewSpecs;
 extern const std::map<juce::String, const std::map<juce::String,AnySpec>*> specsByBranch;
 
 
@@ -60,6 +65,7 @@ struct AnalyzerSettings {
         int hopSize = 1024;
         juce::String windowingType = "hann";
         int numThreads = 2;
+        FeatureStorage featureStorage {FeatureStorage::Float32};
     } analysis;
 
     struct BFCC {
@@ -83,7 +89,8 @@ struct AnalyzerSettings {
     struct Onset {
         enum class Segmentation {
             Event,  // use proper onset detection, making 1 event per onset
-            Uniform // use uniformly distributed segments, specified by analysis.hopSize and analysis.frameSize
+            Uniform,// use uniformly distributed segments, specified by analysis.hopSize and analysis.frameSize
+            Bic     // split where the BFCC frames change character (SBic), with the sBic settings
         } segmentation {Segmentation::Uniform};
 
         double alpha = 0.1;
@@ -94,6 +101,11 @@ struct AnalyzerSettings {
         double weight_flux = 0.5;
         double weight_hfc = 0.5;
         double weight_rms = 0.5;
+
+        // Uniform only: stretches of silence become one event each instead of being cut into many
+        bool silenceGate = false;
+        double silenceGateThreshold = -60.0;    // dBFS, block RMS
+        double silenceGateHangover = 250.0;     // ms
     } onset;
 
     struct Pitch {
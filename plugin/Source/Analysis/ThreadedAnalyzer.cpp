@@ -10,66 +10,257 @@
 
 #include "Analysis/ThreadedAnalyzer.h"
 #include "Analysis/OnsetAnalysis/OnsetProcessing.h"
+#include "Analysis/Tracing.h"
 #include "StringAxiom.h"
+#include "TsnStringAxiom.h"
 #include "../../slicer_granular/Source/misc_util_juce.h"
 
 namespace nvs::analysis {
 
 ThreadedAnalyzer::ThreadedAnalyzer()
 	:	juce::Thread("Analyzer")
+	,	_useOutOfProcessWorker(remote::RemoteAnalysisClient::findWorkerExecutable() != juce::File())
 {}
 ThreadedAnalyzer::~ThreadedAnalyzer(){
+	stopAnalysis();
+	signalThreadShouldExit();
+	_jobAvailable.signal();
 	stopThread(5000);
 }
 
-void ThreadedAnalyzer::updateStoredAudio(std::span<float const> wave, const juce::String &audioFileAbsPath){
-	_inputWave.assign(wave.begin(), wave.end());
-	_audioFileAbsPath = audioFileAbsPath;
-    _onsetAnalysisResult.reset();
-    _timbreAnalysisResult.reset();
+bool ThreadedAnalyzer::requestAnalysis(std::span<float const> wave, const juce::String &audioFileAbsPath, juce::ValueTree &settingsTree,
+										std::vector<Feature_e> featuresInUse){
+	jassert( settingsTree.hasType(nvs::axiom::Settings) );
+	jassert (settingsTree.getParent().getChildWithName("FileInfo").hasProperty("sampleRate"));
+
+	// parse on the caller's thread: the tree belongs to the apvts, and the worker must never read it
+	AnalyzerSettings settings;
+	if (!verifySettingsStructureWithAttemptedFix(settingsTree) || !updateSettingsFromValueTree(settings, settingsTree)) {
+	    DBG("ThreadedAnalyzer::requestAnalysis: settings tree invalid");
+	    jassertfalse;
+	    return false;
+	}
+	_requestedSettings = settings;
+	_requestedSettingsHash = util::hashValueTree(settingsTree);
+	const bool lazyFeatures = settingsTree.getParent().getChildWithName(nvs::axiom::ViewSettings).getProperty(nvs::axiom::lazyFeatures, false);
+	_priorityGroups.store(0, std::memory_order_relaxed);
+
+	juce::ValueTree settingsAndFileInfo {};
+	if (_useOutOfProcessWorker.load(std::memory_order_relaxed)) {
+		// just the branches the worker's own requestAnalysis needs, rather than the entire plugin state
+		settingsAndFileInfo = juce::ValueTree("AnalysisRequest");
+		settingsAndFileInfo.appendChild(settingsTree.createCopy(), nullptr);
+		settingsAndFileInfo.appendChild(settingsTree.getParent().getChildWithName(nvs::axiom::FileInfo).createCopy(), nullptr);
+	}
+
+	{
+		const juce::ScopedLock sl(_jobLock);
+		// bumping the generation is what cancels the running job, so do it under the lock together with the replacement
+		const auto generation = _requestedGeneration.fetch_add(1, std::memory_order_acq_rel) + 1;
+		_pendingJob = Job{
+			generation,
+			vecReal(wave.begin(), wave.end()),
+			audioFileAbsPath,
+			std::move(settings),
+			_requestedSettingsHash,
+			std::move(settingsAndFileInfo),
+			std::move(featuresInUse),
+			lazyFeatures
+		};
+	}
+	_jobAvailable.signal();
+
+	if (!isThreadRunning()) {
+		startThread(juce::Thread::Priority::normal);	// the heavy, parallel part runs on the shared AnalysisExecutor
+	}
+	return true;
 }
-auto ThreadedAnalyzer::shareOnsetAnalysis() -> std::shared_ptr<OnsetAnalysisResult> {
-    return _onsetAnalysisResult;
+void ThreadedAnalyzer::stopAnalysis(){
+	const juce::ScopedLock sl(_jobLock);
+	_pendingJob.reset();
+	_requestedGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
+auto ThreadedAnalyzer::shareOnsetAnalysis() const -> std::shared_ptr<OnsetAnalysisResult> {
+	auto r = std::atomic_load_explicit(&_onsetHandoff, std::memory_order_acquire);
+	if (r == nullptr || r->generation != currentGeneration()) {
+		return nullptr;
+	}
+	return r;
 }
 auto ThreadedAnalyzer::stealTimbreSpaceRepresentation() -> std::optional<TimbreAnalysisResult>{
-	return std::exchange(_timbreAnalysisResult, std::nullopt);
+	const auto r = std::atomic_exchange_explicit(&_timbreHandoff, std::shared_ptr<TimbreAnalysisResult>{}, std::memory_order_acq_rel);
+	if (r == nullptr || r->generation != currentGeneration()) {
+		return std::nullopt;
+	}
+	return std::move(*r);	// we hold the only reference now
 }
 
-void ThreadedAnalyzer::updateSettings(juce::ValueTree &settingsTree, const bool attemptFix){
-	jassert( settingsTree.hasType(nvs::axiom::Settings) );
+void ThreadedAnalyzer::run() {
+	while (!threadShouldExit()) {
+		std::optional<Job> job;
+		{
+			const juce::ScopedLock sl(_jobLock);
+			job = std::exchange(_pendingJob, std::nullopt);
+			_busy.store(job.has_value(), std::memory_order_relaxed);
+		}
+		if (!job.has_value()) {
+			_jobAvailable.wait(-1);
+			continue;
+		}
+		runJob(*job);
+		_busy.store(false, std::memory_order_relaxed);
+	}
+}
 
-	if (!_analyzer.updateSettings(settingsTree, attemptFix))
-	{
-	    DBG("updateSettings failed");
-	    jassertfalse;
+void ThreadedAnalyzer::publish(std::shared_ptr<OnsetAnalysisResult> onsets, std::shared_ptr<TimbreAnalysisResult> timbre) {
+	// a consumer reads the onsets before stealing the timbre. withdrawing the old timbre first means it can never pair
+	// these onsets with it, and storing the onsets before the new timbre means that once it holds the new timbre, a
+	// second look at the onsets is guaranteed to find the matching ones (see TimbreSpace::changeListenerCallback).
+	std::atomic_store_explicit(&_timbreHandoff, std::shared_ptr<TimbreAnalysisResult>{}, std::memory_order_release);
+	std::atomic_store_explicit(&_onsetHandoff, std::move(onsets), std::memory_order_release);
+	std::atomic_store_explicit(&_timbreHandoff, std::move(timbre), std::memory_order_release);
+	sendChangeMessage();
+}
+
+bool ThreadedAnalyzer::runProvisionalPass(const Job &job, const String &audioHash, const ShouldExitFn &shouldExit) {
+	TSN_TRACE_SPAN("ThreadedAnalyzer::runProvisionalPass");
+	try {
+		const auto lengthInSeconds = getLengthInSeconds(job.wave.size(), _analyzer.getAnalyzedFileSampleRate());
+		auto onsets = Analyzer::provisionalOnsetsInSeconds(lengthInSeconds);
+		filterOnsets(onsets, lengthInSeconds);
+		forceMinimumOnsets(onsets, 4, lengthInSeconds);
+
+		auto timbreOpt = _analyzer.calculateProvisionalTimbreSpace(job.wave, onsets, job.featuresInUse, _rls, shouldExit);
+		if (!timbreOpt.has_value() || shouldExit()) {
+			return false;
+		}
+		normalizeOnsets(onsets, lengthInSeconds);
+		auto onsetResult = std::make_shared<OnsetAnalysisResult>(std::move(onsets), audioHash, job.audioFileAbsPath);
+		onsetResult->generation = job.generation;
+		onsetResult->provisional = true;
+		auto timbreResult = std::make_shared<TimbreAnalysisResult>(std::move(timbreOpt.value()), audioHash, job.audioFileAbsPath);
+		timbreResult->generation = job.generation;
+		timbreResult->provisional = true;
+		timbreResult->computedGroups = descriptorGroupsFor(job.featuresInUse);
+		publish(std::move(onsetResult), std::move(timbreResult));
+		return true;
+	} catch (const std::exception& e) {
+		// the sketch is only a preview; the full pass still gets its chance
+		DBG("ThreadedAnalyzer: provisional pass failed: " << e.what());
+		return false;
 	}
 }
 
-void ThreadedAnalyzer::run() {
-	// first, clear everything so that if any analysis is terminated early, we don't have garbage leftover
-    _onsetAnalysisResult.reset();
-    _timbreAnalysisResult.reset();
-	if (!(_inputWave.data() && !_inputWave.empty())){
+void ThreadedAnalyzer::fillMissingGroups(const Job &job, const vecReal &onsetsInSeconds, const vecVecReal &events,
+										  const TimbreAnalysisResult &partial, const FeatureContainer<vecReal> *frameTimbres,
+										  const ShouldExitFn &shouldExit) {
+	TSN_TRACE_SPAN("ThreadedAnalyzer::fillMissingGroups");
+	auto timbreSpace = partial.timbreMeasurements;
+	auto computed = partial.computedGroups;
+	while (!computed.all() && !shouldExit()) {
+		// whatever the user asked for most recently first, otherwise in enum order
+		const auto missing = ~computed;
+		auto next = missing & DescriptorGroups(_priorityGroups.load(std::memory_order_relaxed));
+		if (next.none()) {
+			next = missing;
+		}
+		DescriptorGroups group;
+		for (size_t g = 0; g < next.size(); ++g) {
+			if (next.test(g)) {
+				group.set(g);
+				break;
+			}
+		}
+		if (!_analyzer.calculateDescriptorGroups(job.wave, onsetsInSeconds, events, group, timbreSpace, _rls, shouldExit, frameTimbres)) {
+			return;
+		}
+		computed |= group;
+
+		// the onsets already out are the ones these descriptors belong to; only the timbre space is replaced
+		auto timbreResult = std::make_shared<TimbreAnalysisResult>(timbreSpace, partial.waveformHash, partial.audioFileAbsPath);
+		timbreResult->generation = job.generation;
+		timbreResult->computedGroups = computed;
+		std::atomic_store_explicit(&_timbreHandoff, std::move(timbreResult), std::memory_order_release);
+		sendChangeMessage();
+	}
+}
+
+bool ThreadedAnalyzer::runJobOutOfProcess(const Job &job, const ShouldExitFn &shouldExit) {
+	TSN_TRACE_SPAN("ThreadedAnalyzer::runJobOutOfProcess");
+	if (_remote == nullptr) {
+		_remote = std::make_unique<remote::RemoteAnalysisClient>();
+	}
+	const auto outcome = _remote->run(job.generation, job.wave, job.audioFileAbsPath, job.settingsAndFileInfo, _rls, shouldExit, {
+		.onOnsets = [this](std::shared_ptr<OnsetAnalysisResult> result) {
+			std::atomic_store_explicit(&_onsetHandoff, std::move(result), std::memory_order_release);
+			sendChangeMessage();
+		},
+		.onTimbre = [this](TimbreAnalysisResult result) {
+			std::atomic_store_explicit(&_timbreHandoff, std::make_shared<TimbreAnalysisResult>(std::move(result)), std::memory_order_release);
+			sendChangeMessage();
+		}
+	});
+	if (outcome == remote::RemoteAnalysisClient::Outcome::Unavailable) {
+		DBG("ThreadedAnalyzer: analysis worker unavailable, analysing in-process");
+		return false;
+	}
+	return true;
+}
+
+void ThreadedAnalyzer::runJob(Job &job) {
+	// results of older requests must not linger where a consumer could mistake them for this one's
+	std::atomic_store_explicit(&_onsetHandoff, std::shared_ptr<OnsetAnalysisResult>{}, std::memory_order_release);
+	std::atomic_store_explicit(&_timbreHandoff, std::shared_ptr<TimbreAnalysisResult>{}, std::memory_order_release);
+	if (job.wave.empty()){
 		return;
 	}
-	_rls.set(0.0);
+	_analyzer.applySettings(job.settings, job.settingsHash);
 
+	_rls.beginStage(RunLoopStatus::Stage::OnsetsInSeconds);
+	const auto statusFinisher = juce::ScopeGuard{ [this]{ _rls.finish(); } };
+	// dump whatever got traced (including view rebuilds since the last run) once this run finishes, however it finishes
+	const auto traceFlusher = juce::ScopeGuard{ []{ trace::flushToConfiguredFile(); } };
+
+	const auto generation = job.generation;
+	// let any sub-step know if this job has been superseded, cancelled, or we've been asked to exit.
+	// this is polled once per analysis frame, so it has to stay cheap.
+	auto shouldExit = [this, generation]() {
+		const bool retval = threadShouldExit() || _requestedGeneration.load(std::memory_order_relaxed) != generation;
+		return retval;
+	};
+	// no sketch for the out-of-process worker: it would run Essentia in this process after all
+	if (job.settingsAndFileInfo.isValid() && runJobOutOfProcess(job, shouldExit)) {
+		return;
+	}
 	try {
-		// let any sub-step know if we’ve been asked to exit:
-		auto shouldExit = [this]() {
-			const bool retval = threadShouldExit();
-			if (retval){
-				DBG("ThreadedAnalyzer: exit requested");
-			}
-			return retval;;
-		};
+		TSN_TRACE_SPAN("ThreadedAnalyzer::run");
+		{
+			// first request of this instance: start (or join) the process-wide Essentia runtime here, off the message thread
+			TSN_TRACE_SPAN("Essentia startup");
+			_analyzer.getEssentia();
+		}
+	    const String audioHash = util::hashAudioData(job.wave);
 
-		// perform onset analysis
-		_rls.set("Calculating Onsets...");
-	    const String audioHash = util::hashAudioData(_inputWave);
+		// with a provisional map up, the full onsets wait for the full timbre space, so that consumers never pair one with the other
+		const bool provisionalPublished = !job.featuresInUse.empty() && runProvisionalPass(job, audioHash, shouldExit);
+		if (shouldExit()) {
+			return;
+		}
+		std::shared_ptr<OnsetAnalysisResult> deferredOnsets;
+		// left empty unless the segmentation needed them (Bic); the timbre stage reuses them rather than analysing again
+		FeatureContainer<vecReal> frameTimbres;
+		// by index rather than by onset time, which in float seconds is off by samples on long files
+		std::vector<size_t> silentEvents;
 
-	    const auto unnormalizedOnsets = [this, shouldExit, audioHash]()-> vecReal {
-	        const auto onsetOpt = _analyzer.calculateOnsetsInSeconds(_inputWave, _rls, shouldExit);
+		// perform onset analysis
+	    const auto unnormalizedOnsets = [this, &job, shouldExit, audioHash, provisionalPublished, &deferredOnsets, &frameTimbres,
+	                                     &silentEvents]()-> vecReal {
+	        const auto onsetOpt = _analyzer.calculateOnsetsInSeconds(job.wave, _rls, shouldExit, &frameTimbres, &silentEvents);
+		    if (shouldExit()) {
+		        DBG("ThreadedAnalyzer: job " << (juce::int64) job.generation << " superseded during onset analysis");
+		        return {};
+		    }
 		    jassert(onsetOpt.has_value());
 		    if (onsetOpt.value().empty()) {
 		        DBG("Threaded Analyzer: zero onsets... returning");
@@ -77,37 +268,65 @@ void ThreadedAnalyzer::run() {
 		        return {};
 		    }
 
-		    _onsetAnalysisResult = std::make_shared<OnsetAnalysisResult>(onsetOpt.value(), audioHash, _audioFileAbsPath);
+		    auto onsetResult = std::make_shared<OnsetAnalysisResult>(onsetOpt.value(), audioHash, job.audioFileAbsPath);
+		    onsetResult->generation = job.generation;
 
 		    auto const sr = _analyzer.getAnalyzedFileSampleRate();
-		    const auto lengthInSeconds = getLengthInSeconds(_inputWave.size(), sr);
+		    const auto lengthInSeconds = getLengthInSeconds(job.wave.size(), sr);
 
-		    filterOnsets(_onsetAnalysisResult->onsets, lengthInSeconds);
-		    forceMinimumOnsets(_onsetAnalysisResult->onsets, 4, lengthInSeconds);
+		    filterOnsets(onsetResult->onsets, lengthInSeconds);
+		    forceMinimumOnsets(onsetResult->onsets, 4, lengthInSeconds);
+		    if (onsetResult->onsets.size() != onsetOpt->size()) {
+		        silentEvents.clear();   // the onsets moved, so the indices no longer point at the silences
+		    }
 
-		    const auto retval = _onsetAnalysisResult->onsets;
-		    normalizeOnsets(_onsetAnalysisResult->onsets, lengthInSeconds);
+		    const auto retval = onsetResult->onsets;
+		    normalizeOnsets(onsetResult->onsets, lengthInSeconds);
+		    if (provisionalPublished) {
+		        deferredOnsets = std::move(onsetResult);
+		        return retval;
+		    }
+		    std::atomic_store_explicit(&_onsetHandoff, std::move(onsetResult), std::memory_order_release);
 		    sendChangeMessage();
 	        return retval;
 	    }();
 	    if (unnormalizedOnsets.empty()) {
-	        DBG("Threaded Analyzer: zero onsets... returning");
+	        return;
+	    }
+	    const auto *sharedFrames = frameTimbres.features[0].empty() ? nullptr : &frameTimbres;
+	    // once for the job: every descriptor pass below, lazy ones included, describes the same events
+	    const auto events = _analyzer.splitIntoEvents(job.wave, unnormalizedOnsets, silentEvents, _rls, shouldExit);
+	    if (!events.has_value()) {
 	        return;
 	    }
 
         // perform onsetwise BFCC analysis
-		_rls.set("Calculating Onsetwise TimbreSpace...");
 	    {
-	        const auto timbreMeasurementsOpt = _analyzer.calculateOnsetwiseTimbreSpace(_inputWave, unnormalizedOnsets, _rls, shouldExit);
+	        // with lazyFeatures, axes picked since the request are as good as in use
+	        const auto groups = (job.lazyFeatures && !job.featuresInUse.empty())
+	            ?   descriptorGroupsFor(job.featuresInUse) | DescriptorGroups(_priorityGroups.load(std::memory_order_relaxed))
+	            :   allDescriptorGroups();
+	        auto timbreMeasurementsOpt = _analyzer.calculateOnsetwiseTimbreSpace(job.wave, unnormalizedOnsets, *events, _rls, shouldExit, groups, sharedFrames);
 		    if (!timbreMeasurementsOpt.has_value()) {
 		        DBG("no timbre measurement accomplished, likely due to early exit");
-		        sendChangeMessage();
 		        return;
 		    }
 
-		    _timbreAnalysisResult.emplace(timbreMeasurementsOpt.value(), audioHash, _audioFileAbsPath);
-		    // only NOW do we send change message, and its a single message which should properly cause ALL data to be visualized etc.
-		    sendChangeMessage();
+		    auto timbreResult = std::make_shared<TimbreAnalysisResult>(std::move(timbreMeasurementsOpt.value()), audioHash, job.audioFileAbsPath);
+		    timbreResult->generation = job.generation;
+		    timbreResult->computedGroups = groups;
+		    // kept for the fill, since the consumer steals the one published
+		    const auto partial = groups.all() ? nullptr : std::make_shared<TimbreAnalysisResult>(*timbreResult);
+		    if (deferredOnsets != nullptr) {
+		        publish(std::move(deferredOnsets), std::move(timbreResult));
+		    } else {
+		        std::atomic_store_explicit(&_timbreHandoff, std::move(timbreResult), std::memory_order_release);
+		        // only NOW do we send change message, and its a single message which should properly cause ALL data to be visualized etc.
+		        sendChangeMessage();
+		    }
+		    if (partial != nullptr) {
+		        fillMissingGroups(job, unnormalizedOnsets, *events, *partial, sharedFrames, shouldExit);
+		    }
 	    }
 	} catch (const essentia::EssentiaException& e) {
 		DBG("Essentia exception: " << e.what());
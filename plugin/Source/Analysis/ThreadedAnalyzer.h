@@ -12,10 +12,17 @@
 #include "Analysis/Analyzer.h"
 #include "Analysis/OnsetAnalysis/OnsetAnalysisResult.h"
 #include "Analysis/TimbreAnalysis/TimbreAnalysisResult.h"
+#include "Analysis/RemoteAnalysis.h"
 #include <JuceHeader.h>
 
 namespace nvs::analysis {
 
+/**
+ * Persistent analysis worker. Each requestAnalysis() call becomes a job; only the most recent request is kept pending
+ * (an older pending one is simply replaced), and issuing a request cancels the job in flight, which notices within one
+ * analysis frame. Results are tagged with the generation of the request that produced them and handed over through
+ * atomic slots, so consumers on the message thread never see a half-written result or one that has been superseded.
+ */
 class ThreadedAnalyzer final :	public Thread
 ,							    public ChangeBroadcaster
 {
@@ -23,33 +30,89 @@ public:
     ThreadedAnalyzer();
     ~ThreadedAnalyzer() override;
     //===============================================================================
-    void updateStoredAudio(std::span<float const> wave, const juce::String &audioFileAbsPath);
-    void updateSettings(juce::ValueTree &settingsTree, bool attemptFix);
+    // message thread. copies the audio and parses the settings tree (fixing its structure if needed) before queueing,
+    // so the caller may change either as soon as this returns. returns false if the settings were unusable.
+    // featuresInUse are those the caller shows or filters by. if given, a coarse map covering them (see
+    // Analyzer::calculateProvisionalTimbreSpace) is published first, flagged as provisional, and the full analysis
+    // replaces it once done. with the lazyFeatures view setting on, the full analysis itself computes just these at
+    // first and republishes as it fills in the rest.
+    bool requestAnalysis(std::span<float const> wave, const juce::String &audioFileAbsPath, juce::ValueTree &settingsTree,
+                         std::vector<Feature_e> featuresInUse = {});
+    // message thread. features the job in flight should fill in next, if it has not yet, e.g. for a newly picked axis
+    void prioritizeFeatures(std::span<const Feature_e> features) noexcept {
+        _priorityGroups.store(descriptorGroupsFor(features).to_ulong(), std::memory_order_relaxed);
+    }
+    // cancels the job in flight (if any) and drops any pending one
+    void stopAnalysis();
+    bool isBusy() const noexcept { return _busy.load(std::memory_order_relaxed); }
+    // true if no job is running or waiting to run
+    bool isIdle() const {
+        const juce::ScopedLock sl(_jobLock);
+        return !_pendingJob.has_value() && !isBusy();
+    }
+    // analyse in tsn-analysis-worker rather than in this process (see RemoteAnalysis.h). defaults to on iff
+    // TSN_ANALYSIS_WORKER names a usable executable; applies from the next request.
+    void setUseOutOfProcessWorker(bool shouldUse) noexcept { _useOutOfProcessWorker.store(shouldUse, std::memory_order_relaxed); }
     //===============================================================================
     void run() override;
-    void stopAnalysis() { signalThreadShouldExit(); }
     //===============================================================================
     bool onsetsReady() const {
-        return _onsetAnalysisResult != nullptr;
+        return shareOnsetAnalysis() != nullptr;
     }
     bool timbreAnalysisReady() const {
-        return _timbreAnalysisResult.has_value();
+        const auto r = std::atomic_load_explicit(&_timbreHandoff, std::memory_order_acquire);
+        return r != nullptr && r->generation == currentGeneration();
     }
     //===============================================================================
-    std::shared_ptr<OnsetAnalysisResult> shareOnsetAnalysis();
+    // both return nothing if the latest result belongs to a superseded request
+    std::shared_ptr<OnsetAnalysisResult> shareOnsetAnalysis() const;
     std::optional<TimbreAnalysisResult> stealTimbreSpaceRepresentation();
     //===============================================================================
     Analyzer &getAnalyzer() { return _analyzer; }
     RunLoopStatus &getStatus() noexcept { return _rls; }
-    String getSettingsHash() const noexcept { return _analyzer.getSettingsHash(); }
+    // settings of the most recent request (message thread)
+    const AnalyzerSettings &getSettings() const noexcept { return _requestedSettings; }
+    String getSettingsHash() const noexcept { return _requestedSettingsHash; }
     //===============================================================================
 private:
-    Analyzer _analyzer;
-    vecReal _inputWave;
-    std::shared_ptr<OnsetAnalysisResult> _onsetAnalysisResult;
-    std::optional<TimbreAnalysisResult> _timbreAnalysisResult;
+    struct Job {
+        std::uint64_t generation;
+        vecReal wave;
+        String audioFileAbsPath;
+        AnalyzerSettings settings;
+        String settingsHash;
+        juce::ValueTree settingsAndFileInfo;    // only for out-of-process jobs
+        std::vector<Feature_e> featuresInUse;
+        bool lazyFeatures;      // not part of settings: it changes when features are computed, not what they are
+    };
+    void runJob(Job &job);
+    // true if a provisional map was published
+    bool runProvisionalPass(const Job &job, const String &audioHash, const ShouldExitFn &shouldExit);
+    void publish(std::shared_ptr<OnsetAnalysisResult> onsets, std::shared_ptr<TimbreAnalysisResult> timbre);
+    // after a lazy pass: computes the remaining groups one at a time, republishing the timbre space after each
+    void fillMissingGroups(const Job &job, const vecReal &onsetsInSeconds, const vecVecReal &events,
+                           const TimbreAnalysisResult &partial, const FeatureContainer<vecReal> *frameTimbres,
+                           const ShouldExitFn &shouldExit);
+    bool runJobOutOfProcess(const Job &job, const ShouldExitFn &shouldExit);     // false: fall back to in-process
+    std::uint64_t currentGeneration() const noexcept { return _requestedGeneration.load(std::memory_order_acquire); }
+
+    Analyzer _analyzer;     // worker thread only
+
+    std::atomic<bool> _useOutOfProcessWorker;
+    std::unique_ptr<remote::RemoteAnalysisClient> _remote;  // worker thread only
+
+    juce::CriticalSection _jobLock;
+    std::optional<Job> _pendingJob;         // latest request wins
+    juce::WaitableEvent _jobAvailable;
+    std::atomic<std::uint64_t> _requestedGeneration {0};
+    std::atomic<bool> _busy {false};
+    std::atomic<unsigned long> _priorityGroups {0};    // DescriptorGroups
+
+    std::shared_ptr<OnsetAnalysisResult> _onsetHandoff;     // accessed only through std::atomic_* free functions
+    std::shared_ptr<TimbreAnalysisResult> _timbreHandoff;
 
-    String _audioFileAbsPath {};
+    AnalyzerSettings _requestedSettings;
+    String _requestedSettingsHash {};
 
     RunLoopStatus _rls;
 };
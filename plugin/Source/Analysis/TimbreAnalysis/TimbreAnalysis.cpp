@@ -13,7 +13,7 @@
 namespace nvs::analysis {
 
 namespace {
-PitchesAndConfidences calculatePitchesEssentiaYin(std::span<Real> waveSpan, AnalyzerSettings const& settings){
+PitchesAndConfidences calculatePitchesEssentiaYin(std::span<Real> waveSpan, AnalyzerSettings const& settings, const ShouldExitFn &shouldExit){
     vecReal wave(waveSpan.begin(), waveSpan.end());
 
     int const frameSize = settings.analysis.frameSize;
@@ -51,6 +51,7 @@ PitchesAndConfidences calculatePitchesEssentiaYin(std::span<Real> waveSpan, Anal
 
     vecReal frequencies, confidences; // accumulate results manually
     while (true) {
+        if (shouldExit && shouldExit()) break;
         vecReal frame;
 
         // get next frame
@@ -99,12 +100,13 @@ PitchesAndConfidences calculatePitchesEssentiaYin(std::span<Real> waveSpan, Anal
 }	// anonymous namespace
 
 PitchesAndConfidences calculatePitchesAndConfidences (vecReal waveEvent,
-                                                      AnalyzerSettings const& settings)
+                                                      AnalyzerSettings const& settings,
+                                                      const ShouldExitFn &shouldExit)
 {
     auto const algo      = settings.pitch.pitchDetectionAlgorithm.toStdString();
 
     if (algo == "yin") {
-        return calculatePitchesEssentiaYin (waveEvent, settings);
+        return calculatePitchesEssentiaYin (waveEvent, settings, shouldExit);
     }
     if (algo == "pYin") {
         jassertfalse;  // not implemented
@@ -120,7 +122,7 @@ PitchesAndConfidences calculatePitchesAndConfidences (vecReal waveEvent,
     return {};
 }
 
-vecReal calculateLoudnesses(const std::span<Real const> waveSpan, AnalyzerSettings const& settings)
+vecReal calculateLoudnesses(const std::span<Real const> waveSpan, AnalyzerSettings const& settings, const ShouldExitFn &shouldExit)
 {
     auto const filteredWave = [&settings](std::span<Real const> _waveSpan) {
         const vecReal wave(_waveSpan.begin(), _waveSpan.end());
@@ -169,6 +171,7 @@ vecReal calculateLoudnesses(const std::span<Real const> waveSpan, AnalyzerSettin
 
     // Process frame by frame
     while (true) {
+        if (shouldExit && shouldExit()) break;
         vecReal frame;
 
         // get next frame
@@ -198,7 +201,7 @@ vecReal calculateLoudnesses(const std::span<Real const> waveSpan, AnalyzerSettin
     return loudnesses;
 }
 
-FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings)
+FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings, const ShouldExitFn &shouldExit)
 {
     vecReal wave(waveSpan.begin(), waveSpan.end());
 
@@ -278,6 +281,7 @@ FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, Analy
     // Process frame by frame
     int frameCounter = 0;
     while (true) {
+        if (shouldExit && shouldExit()) break;
         vecReal frame;
 
         // get next frame
@@ -339,6 +343,9 @@ FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, Analy
 
         frameCounter++;
     }
+    if (shouldExit && shouldExit()) {
+        return timbres;     // partial; the caller discards it
+    }
 
     assert(!timbres.bfccs().empty());
     assert(!timbres.bfccs()[0].empty());
@@ -12,6 +12,7 @@
 
 #include "Analysis/AnalysisUsing.h"
 #include "Analysis/Settings.h"
+#include "Analysis/RunLoopStatus.h"
 #include <span>
 #include "../Features.h"
 
@@ -21,11 +22,16 @@ struct PitchesAndConfidences {
     std::vector<Real> pitches, confidences;
 };
 
-PitchesAndConfidences calculatePitchesAndConfidences(vecReal waveEvent, AnalyzerSettings const& settings);
+// the frame loops below poll shouldExit (if given) once per frame, and return whatever frames were done so far when it
+// fires. callers that pass it must therefore check it again before trusting the result.
+PitchesAndConfidences calculatePitchesAndConfidences(vecReal waveEvent, AnalyzerSettings const& settings,
+                                                     const ShouldExitFn &shouldExit = nullptr);
 
-vecReal calculateLoudnesses(std::span<Real const> waveSpan, AnalyzerSettings const& settings);
+vecReal calculateLoudnesses(std::span<Real const> waveSpan, AnalyzerSettings const& settings,
+                            const ShouldExitFn &shouldExit = nullptr);
 
-FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings);
+FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings,
+                                           const ShouldExitFn &shouldExit = nullptr);
 
 vecVecReal PCA(vecVecReal const &V, int num_features_out);
 
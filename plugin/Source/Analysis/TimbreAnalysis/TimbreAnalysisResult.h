@@ -14,6 +14,9 @@ struct TimbreAnalysisResult {
 
     String waveformHash {};
     String audioFileAbsPath {};
+    std::uint64_t generation {0};   // ThreadedAnalyzer request that produced this; stale results are never handed out
+    bool provisional {false};       // a coarse sketch that the full analysis of the same request will replace
+    DescriptorGroups computedGroups {allDescriptorGroups()};   // features of the other groups are still zero
 };
 
 } // namespace nvs::analysis
@@ -0,0 +1,151 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "Analysis/Tracing.h"
+#include <chrono>
+#include <mutex>
+
+namespace nvs::trace {
+
+namespace {
+
+constexpr const char *traceFileEnvVar = "TSN_TRACE_FILE";
+constexpr size_t maxEventsPerThread = size_t(1) << 20;   // beyond this, spans are dropped rather than grown unboundedly
+
+struct Event {
+    const char *name;
+    int64_t startMicros;
+    int64_t durationMicros;
+};
+struct ThreadBuffer {
+    juce::SpinLock lock;    // only contended while a trace is being written
+    std::vector<Event> events;
+    uint64_t tid {0};
+    juce::String threadName;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;    // shared so spans outlive the threads that recorded them
+    std::atomic<bool> enabled { juce::SystemStats::getEnvironmentVariable(traceFileEnvVar, {}).isNotEmpty() };
+    const std::chrono::steady_clock::time_point epoch { std::chrono::steady_clock::now() };
+};
+Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+int64_t nowMicros() noexcept {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - registry().epoch).count();
+}
+
+ThreadBuffer &threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto b = std::make_shared<ThreadBuffer>();
+        b->tid = static_cast<uint64_t>(reinterpret_cast<juce::pointer_sized_uint>(juce::Thread::getCurrentThreadId()));
+        if (auto *t = juce::Thread::getCurrentThread()) {
+            b->threadName = t->getThreadName();
+        }
+        else if (juce::MessageManager::existsAndIsCurrentThread()) {
+            b->threadName = "Message";
+        }
+        else {
+            b->threadName = "Thread " + juce::String(static_cast<juce::int64>(b->tid));
+        }
+        b->events.reserve(1024);
+        const std::scoped_lock sl(registry().mutex);
+        registry().buffers.push_back(b);
+        return b;
+    }();
+    return *buffer;
+}
+
+juce::String escape(const juce::String &s) {
+    return s.replace("\\", "\\\\").replace("\"", "\\\"");
+}
+
+}   // anonymous namespace
+//=============================================================================================================================
+void setEnabled(const bool shouldBeEnabled) noexcept {
+    registry().enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+}
+bool isEnabled() noexcept {
+    return registry().enabled.load(std::memory_order_relaxed);
+}
+
+void clear() {
+    const std::scoped_lock sl(registry().mutex);
+    for (auto const &b : registry().buffers) {
+        const juce::SpinLock::ScopedLockType bl(b->lock);
+        b->events.clear();
+    }
+}
+
+bool writeChromeTrace(const juce::File &file) {
+    juce::MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&] {
+        if (!first) json << ",\n";
+        first = false;
+    };
+    {
+        const std::scoped_lock sl(registry().mutex);
+        for (auto const &b : registry().buffers) {
+            const juce::SpinLock::ScopedLockType bl(b->lock);
+            if (b->events.empty()) {
+                continue;
+            }
+            const auto tid = juce::String(static_cast<juce::int64>(b->tid));
+            separator();
+            json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                 << ",\"args\":{\"name\":\"" << escape(b->threadName) << "\"}}";
+            for (auto const &e : b->events) {
+                separator();
+                json << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"tsn\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                     << ",\"ts\":" << static_cast<juce::int64>(e.startMicros)
+                     << ",\"dur\":" << static_cast<juce::int64>(e.durationMicros) << "}";
+            }
+        }
+    }
+    json << "\n]}\n";
+
+    if (const auto result = file.getParentDirectory().createDirectory(); result.failed()) {
+        DBG("trace: could not create directory for " << file.getFullPathName() << ": " << result.getErrorMessage());
+        return false;
+    }
+    return file.replaceWithData(json.getData(), json.getDataSize());
+}
+
+void flushToConfiguredFile() {
+    if (!isEnabled()) {
+        return;
+    }
+    if (const auto path = juce::SystemStats::getEnvironmentVariable(traceFileEnvVar, {});
+        path.isNotEmpty() && juce::File::isAbsolutePath(path))
+    {
+        writeChromeTrace(juce::File(path));
+    }
+}
+//=============================================================================================================================
+ScopedSpan::ScopedSpan(const char *name) noexcept
+:   _name(name)
+{
+    if (isEnabled()) {
+        _startMicros = nowMicros();
+    }
+}
+ScopedSpan::~ScopedSpan() {
+    if (_startMicros < 0) {
+        return;
+    }
+    const auto end = nowMicros();
+    auto &b = threadBuffer();
+    const juce::SpinLock::ScopedLockType bl(b.lock);
+    if (b.events.size() < maxEventsPerThread) {
+        b.events.push_back({_name, _startMicros, end - _startMicros});
+    }
+}
+
+}   // namespace nvs::trace
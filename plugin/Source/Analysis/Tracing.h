@@ -0,0 +1,50 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Minimal scoped-span tracer for the analysis and view-rebuild paths.
+ *
+ * Spans are recorded into a per-thread buffer (no shared lock on the hot path) and can be dumped as Chrome trace JSON,
+ * loadable in chrome://tracing or ui.perfetto.dev. Tracing is off unless the TSN_TRACE_FILE environment variable names
+ * an output file, or setEnabled(true) is called; when off, a span costs one relaxed atomic load.
+ *
+ * Span names must be string literals (or otherwise outlive the tracer); only the pointer is stored.
+ */
+namespace nvs::trace {
+
+void setEnabled(bool shouldBeEnabled) noexcept;
+bool isEnabled() noexcept;
+
+void clear();
+bool writeChromeTrace(const juce::File &file);
+// writes to TSN_TRACE_FILE if tracing is enabled and that variable is set; otherwise does nothing
+void flushToConfiguredFile();
+
+class ScopedSpan {
+public:
+    explicit ScopedSpan(const char *name) noexcept;
+    ~ScopedSpan();
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan &operator=(const ScopedSpan&) = delete;
+private:
+    const char *_name;
+    int64_t _startMicros {-1};  // -1: tracing was off when the span opened
+};
+
+}   // namespace nvs::trace
+
+#ifndef TSN_ENABLE_TRACING
+    #define TSN_ENABLE_TRACING 1
+#endif
+
+#if TSN_ENABLE_TRACING
+    #define TSN_TRACE_SPAN(name) const ::nvs::trace::ScopedSpan JUCE_JOIN_MACRO(tsnTraceSpan_, __LINE__) (name)
+#else
+    #define TSN_TRACE_SPAN(name)
+#endif
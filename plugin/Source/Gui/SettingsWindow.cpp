@@ -9,6 +9,7 @@
 */
 
 #include "SettingsWindow.h"
+#include "TsnStringAxiom.h"
 
 #include <memory>
 #include <utility>
@@ -39,6 +40,11 @@ SettingsWindow::SettingsWindow (TSNGranularAudioProcessor& processor,
 					  page,
 					  /*takeOwnership*/ true);
 	}
+	// view settings live beside the analysis settings rather than among them, but are edited the same way
+	tabs->addTab (nvs::axiom::ViewSettings,
+				  juce::Colours::darkgrey,
+				  createPageForBranch (proc.getAPVTS().state, nvs::axiom::ViewSettings, nvs::analysis::viewSpecs),
+				  /*takeOwnership*/ true);
 
 	setContentOwned (tabs.get(), true);
 }
@@ -184,7 +184,10 @@ void TimbreSpaceComponent::paint(juce::Graphics &g) {
         std::vector<Timbre5DPoint> current_points;
 		current_points.reserve(timbreSpacePS.getCurrentPointIndices().size());
 		for (const WeightedIdx &wi : timbreSpacePS.getCurrentPointIndices()){
-			current_points.push_back(timbres5D[wi.idx].point);
+			// the audio thread may already be selecting from a newer filter than the one shown here
+			if (static_cast<size_t>(wi.idx) < timbres5D.size()) {
+				current_points.push_back(timbres5D[wi.idx].point);
+			}
 		}
 
 	    setNavigatorPoint(get2D(timbreSpacePS.getTargetPoint()));
@@ -373,15 +376,40 @@ void ProgressIndicator::paint(juce::Graphics &g) {
 }
 void ProgressIndicator::resized() {}
 
-void TimbreSpaceComponent::changeListenerCallback (juce::ChangeBroadcaster* source) {
-	if (auto *rls = dynamic_cast<nvs::analysis::RunLoopStatus*>(source)) {
-		std::cout << "timbre space comp: RunLoopStatus: CHANGE listener: SHOWING progress indicator\n";
+void TimbreSpaceComponent::pollAnalysisProgress() {
+	auto status = _proc->getAnalyzer().getStatus().sample();
+	if (!status.active) {
+		status = _proc->getEventExporter().getStatus().sample();	// event export shares the progress bar
+	}
+	if (!status.active) {
+		// nothing running, e.g. a job that was cancelled or failed without a change message
+		if (progressIndicator.isVisible()) {
+			progressIndicator.setVisible(false);
+			progressIndicator.progress = 0.0;
+			progressIndicator.message = {};
+		}
+		return;
+	}
+	juce::String message = status.getMessage();
+	if (status.total > 0) {
+		message << " " << juce::String(status.completed) << "/" << juce::String(status.total);
+		if (status.etaSeconds >= 0.0) {
+			message << " (~" << juce::String(static_cast<int>(std::ceil(status.etaSeconds))) << " s)";
+		}
+	}
+	if (!progressIndicator.isVisible()) {
 		addAndMakeVisible(progressIndicator);
-		progressIndicator.progress = rls->getProgress();
-		progressIndicator.message = rls->getMessage();
-		std::cout << "PROGRESS: " << progressIndicator.progress << '\n';
+	}
+	if (progressIndicator.progress != status.progress || progressIndicator.message != message) {
+		progressIndicator.progress = status.progress;
+		progressIndicator.message = message;
 		progressIndicator.repaint();
 	}
+}
+void TimbreSpaceComponent::changeListenerCallback (juce::ChangeBroadcaster* source) {
+	if (dynamic_cast<nvs::analysis::EventExporter*>(source)){
+		progressIndicator.setVisible(false);
+	}
 	else if (dynamic_cast<nvs::analysis::ThreadedAnalyzer*>(source)){
 		std::cout << "timbre space comp: ThreadedAnalyzer: CHANGE listener: hiding progress indicator\n";
 		progressIndicator.setVisible(false);
@@ -392,10 +420,6 @@ void TimbreSpaceComponent::actionListenerCallback (const juce::String &message)
 		showAnalysisSaveDialog();
 	}
 }
-void TimbreSpaceComponent::exitSignalSent() {
-	std::cout << "timbre space comp: ThreadedAnalyzer: THREAD listener: hiding progress indicator\n";
-	progressIndicator.setVisible(false);
-}
 
 void TimbreSpaceComponent::TSNMouse::createMouseImage() {
 	juce::Image image(juce::Image::ARGB, 16, 16, true);
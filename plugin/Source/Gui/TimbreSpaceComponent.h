@@ -31,7 +31,6 @@ struct ProgressIndicator final :	public juce::Component
 
 class TimbreSpaceComponent final :	public juce::Component
 , 								public juce::ChangeListener
-, 								public juce::Thread::Listener
 ,								private juce::ActionListener
 {
 public:
@@ -44,7 +43,6 @@ public:
 	//==========================================================================================
 	void changeListenerCallback (juce::ChangeBroadcaster* source) override;
 	void actionListenerCallback (const juce::String &message) override;
-	void exitSignalSent() override;
 	//==========================================================================================
 	void paint(juce::Graphics &g) override;
 	void resized() override;
@@ -61,6 +59,7 @@ public:
 	
 	void setNavigatorPoint(const Timbre2DPoint& p);
 	ProgressIndicator& getProgressIndicator();
+	void pollAnalysisProgress();	// call from the editor's timer; samples the analyzer's (or event exporter's) lock-free status
 	
 
 private:
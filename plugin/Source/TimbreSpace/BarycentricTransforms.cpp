@@ -0,0 +1,50 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "BarycentricTransforms.h"
+#include <limits>
+
+namespace nvs::timbrespace {
+
+BarycentricTransforms::BarycentricTransforms(const Triangulation &t) {
+    const size_t n = t.numTriangles();
+    for (auto *coefficients : {&_a1, &_b1, &_c1, &_a2, &_b2, &_c2}) {
+        coefficients->resize(n);
+    }
+    for (size_t tri = 0; tri < n; ++tri) {
+        compute(t, tri);
+    }
+}
+void BarycentricTransforms::update(const Triangulation &t, const std::span<const size_t> changedTriangles) {
+    for (auto *coefficients : {&_a1, &_b1, &_c1, &_a2, &_b2, &_c2}) {
+        coefficients->resize(t.numTriangles());
+    }
+    for (const auto tri : changedTriangles) {
+        compute(t, tri);
+    }
+}
+void BarycentricTransforms::compute(const Triangulation &t, const size_t tri) {
+    const auto &c = t.coords;
+    const size_t v0 = t.triangles[3 * tri], v1 = t.triangles[3 * tri + 1], v2 = t.triangles[3 * tri + 2];
+    const double x0 = c[2 * v0], y0 = c[2 * v0 + 1];
+    const double e1x = c[2 * v1] - x0, e1y = c[2 * v1 + 1] - y0;
+    const double e2x = c[2 * v2] - x0, e2y = c[2 * v2 + 1] - y0;
+    const double det = e1x * e2y - e1y * e2x;
+    if (det * det < 1e-10) {    // the same threshold computeBarycentricWeights falls back to distance weights at
+        constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+        _a1[tri] = _b1[tri] = _c1[tri] = _a2[tri] = _b2[tri] = _c2[tri] = nan;
+        return;
+    }
+    // p - p0 = w1 e1 + w2 e2, solved by Cramer's rule
+    const double a1 = e2y / det, b1 = -e2x / det;
+    const double a2 = -e1y / det, b2 = e1x / det;
+    _a1[tri] = static_cast<float>(a1);
+    _b1[tri] = static_cast<float>(b1);
+    _c1[tri] = static_cast<float>(-(a1 * x0 + b1 * y0));
+    _a2[tri] = static_cast<float>(a2);
+    _b2[tri] = static_cast<float>(b2);
+    _c2[tri] = static_cast<float>(-(a2 * x0 + b2 * y0));
+}
+
+}   // namespace nvs::timbrespace
@@ -0,0 +1,51 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <array>
+#include <span>
+#include <vector>
+#include "TimbrePointTypes.h"
+#include "Triangulation.h"
+
+namespace nvs::timbrespace {
+
+/**
+ * Every triangle's barycentric coordinates as affine functions of the point, precomputed once per triangulation:
+ * the weights of a triangle's second and third vertices are
+ *      w1 = a1 x + b1 y + c1,    w2 = a2 x + b2 y + c2,
+ * and the first's is 1 - w1 - w2. So weighting a target, or testing whether it is inside, is six multiply-adds and
+ * three sign checks instead of solving the triangle's system anew.
+ *
+ * Stored as one float array per coefficient, indexed by triangle, so that many targets can be run through them at once.
+ * A degenerate (collinear) triangle has NaN coefficients, so it contains nothing, and its weights are NaN.
+ */
+class BarycentricTransforms
+{
+public:
+    BarycentricTransforms() = default;
+    explicit BarycentricTransforms(const Triangulation &t);
+    // for transforms made for an earlier state of t: recomputes those of the triangles that have changed since
+    void update(const Triangulation &t, std::span<const size_t> changedTriangles);
+
+    // weights of the triangle's vertices, in the order of Triangulation::triangles
+    std::array<float, 3> weights(const size_t triangle, const Timbre2DPoint &p) const {
+        const float w1 = _a1[triangle] * p.x() + _b1[triangle] * p.y() + _c1[triangle];
+        const float w2 = _a2[triangle] * p.x() + _b2[triangle] * p.y() + _c2[triangle];
+        return {1.f - w1 - w2, w1, w2};
+    }
+    bool contains(const size_t triangle, const Timbre2DPoint &p) const {
+        const auto w = weights(triangle, p);
+        return w[0] >= 0.f && w[1] >= 0.f && w[2] >= 0.f;
+    }
+    size_t size() const { return _a1.size(); }
+    size_t bytes() const { return 6 * _a1.capacity() * sizeof(float); }
+private:
+    void compute(const Triangulation &t, size_t tri);
+
+    std::vector<float> _a1, _b1, _c1;
+    std::vector<float> _a2, _b2, _c2;
+};
+
+}   // namespace nvs::timbrespace
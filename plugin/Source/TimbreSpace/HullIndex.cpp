@@ -0,0 +1,103 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "HullIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nvs::timbrespace {
+
+HullIndex::HullIndex(const Triangulation &t) {
+    if (t.hull_start == delaunator::INVALID_INDEX || t.numTriangles() == 0) {
+        return;
+    }
+    // each hull vertex starts exactly one halfedge without a twin: the hull edge on to its hull_next
+    std::vector<size_t> hullHalfedgeFrom(t.numVertices(), delaunator::INVALID_INDEX);
+    for (size_t e = 0; e < t.halfedges.size(); ++e) {
+        if (t.halfedges[e] == delaunator::INVALID_INDEX) {
+            hullHalfedgeFrom[t.triangles[e]] = e;
+        }
+    }
+    const auto pointOf = [&c = t.coords](const size_t u) {
+        return Timbre2DPoint(static_cast<float>(c[2 * u]), static_cast<float>(c[2 * u + 1]));
+    };
+    std::vector<size_t> vertices;
+    size_t v = t.hull_start;
+    do {
+        vertices.push_back(v);
+        v = t.hull_next[v];
+    } while (v != t.hull_start);
+
+    // the mean of a convex polygon's vertices is inside it, so every edge subtends its own range of angles around it
+    Timbre2DPoint center {0.f, 0.f};
+    for (const size_t u : vertices) {
+        center += pointOf(u);
+    }
+    _center = center / static_cast<float>(vertices.size());
+
+    const size_t h = vertices.size();
+    std::vector<float> angles(h);
+    for (size_t i = 0; i < h; ++i) {
+        const Timbre2DPoint d = pointOf(vertices[i]) - _center;
+        angles[i] = -std::atan2(d.y(), d.x());
+    }
+    // start from the smallest negated angle, so that they ascend the rest of the way around
+    const size_t first = static_cast<size_t>(std::ranges::min_element(angles) - angles.begin());
+    _angles.reserve(h);
+    _points.reserve(h);
+    _halfedges.reserve(h);
+    for (size_t k = 0; k < h; ++k) {
+        const size_t i = (first + k) % h;
+        _angles.push_back(angles[i]);
+        _points.push_back(pointOf(vertices[i]));
+        _halfedges.push_back(hullHalfedgeFrom[vertices[i]]);
+    }
+}
+
+float HullIndex::squaredDistanceToEdge(const size_t edge, const Timbre2DPoint &p, float *along) const {
+    const Timbre2DPoint &a = _points[edge];
+    const Timbre2DPoint &b = _points[(edge + 1) % _points.size()];
+    const Timbre2DPoint ab = b - a;
+    const float lengthSquared = ab.squaredNorm();
+    const float s = lengthSquared > 0.f ? std::clamp((p - a).dot(ab) / lengthSquared, 0.f, 1.f) : 0.f;
+    *along = s;
+    return (a + s * ab - p).squaredNorm();
+}
+
+std::optional<HullIndex::Projection> HullIndex::project(const Timbre2DPoint &p) const {
+    if (empty()) {
+        return std::nullopt;
+    }
+    const size_t h = _halfedges.size();
+    // the edge that the ray from the center through p crosses. p lies beyond it, so the nearest edge is that one or,
+    // for a p off to the side of a sharp corner, one a few edges along, which stepping on while the distance falls finds
+    const Timbre2DPoint d = p - _center;
+    const auto above = std::ranges::upper_bound(_angles, -std::atan2(d.y(), d.x()));
+    const size_t k = static_cast<size_t>(above - _angles.begin());
+    size_t edge = (k == 0 || k == h) ? h - 1 : k - 1;
+
+    float along;
+    float distance = squaredDistanceToEdge(edge, p, &along);
+    for (const size_t step : {size_t{1}, h - 1}) {     // forward, then backward, around the hull
+        for (size_t tried = 1; tried < h; ++tried) {
+            const size_t next = (edge + step) % h;
+            float nextAlong;
+            const float nextDistance = squaredDistanceToEdge(next, p, &nextAlong);
+            if (nextDistance >= distance) {
+                break;
+            }
+            edge = next;
+            distance = nextDistance;
+            along = nextAlong;
+        }
+    }
+
+    const size_t e = _halfedges[edge];
+    Projection projection {e / 3, {0.f, 0.f, 0.f}};
+    projection.weights[e % 3] = 1.f - along;
+    projection.weights[e % 3 == 2 ? 0 : e % 3 + 1] = along;
+    return projection;
+}
+
+}   // namespace nvs::timbrespace
@@ -0,0 +1,52 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <array>
+#include <optional>
+#include <vector>
+#include "TimbrePointTypes.h"
+#include "Triangulation.h"
+
+namespace nvs::timbrespace {
+
+/**
+ * The triangulation's convex hull as a polygon, with its edges indexed by the angle at which they are seen from a point
+ * inside it. A target outside the hull is then snapped to the nearest hull edge in O(log h) (h being the number of
+ * hull edges), instead of searching every triangle for the nearest one.
+ *
+ * Built once per triangulation, on the thread that triangulates; read-only afterwards.
+ */
+class HullIndex
+{
+public:
+    HullIndex() = default;
+    explicit HullIndex(const Triangulation &t);
+
+    // p projected onto the nearest hull edge, as weights over the triangle on the inside of that edge: the edge's two
+    // vertices share the weight by where the projection falls between them, and the third vertex gets none.
+    struct Projection {
+        size_t triangle;
+        std::array<float, 3> weights;   // in the order of Triangulation::triangles
+    };
+    // nullopt if the triangulation had no hull (no triangles)
+    std::optional<Projection> project(const Timbre2DPoint &p) const;
+    bool empty() const { return _halfedges.empty(); }
+    size_t size() const { return _halfedges.size(); }
+    size_t bytes() const {
+        return _angles.capacity() * sizeof(float) + _points.capacity() * sizeof(Timbre2DPoint)
+             + _halfedges.capacity() * sizeof(size_t);
+    }
+private:
+    // the hull edge i runs from _points[i] to _points[i + 1] (wrapping around). they are rotated so that the angles,
+    // which fall as the clockwise hull goes around, are negated into ascending order for a binary search.
+    Timbre2DPoint _center {};
+    std::vector<float> _angles;             // negated angle of each edge's first vertex around _center, ascending
+    std::vector<Timbre2DPoint> _points;
+    std::vector<size_t> _halfedges;         // the hull halfedge along each edge, from _points[i] to _points[i + 1]
+
+    float squaredDistanceToEdge(size_t edge, const Timbre2DPoint &p, float *along) const;
+};
+
+}   // namespace nvs::timbrespace
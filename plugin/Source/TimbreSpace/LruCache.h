@@ -0,0 +1,75 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace nvs::timbrespace {
+
+/**
+ * Keeps the Capacity values most recently looked up or inserted, dropping the least recently used one to make room.
+ * Values may also be given a size in bytes, in which case the least recently used ones are dropped as well to keep the
+ * total within maxBytes; the one just inserted is kept regardless.
+ * Not thread safe; meant for state that belongs to a single (worker) thread.
+ */
+template<typename Key, typename Value, size_t Capacity, typename Hash = std::hash<Key>>
+class LruCache
+{
+public:
+    static_assert(Capacity > 0);
+
+    explicit LruCache(const size_t maxBytes = SIZE_MAX)
+    :   _maxBytes(maxBytes)
+    {}
+
+    // the value stored under key, now the most recently used, or nullptr
+    Value *find(const Key &key) {
+        const auto it = _index.find(key);
+        if (it == _index.end()) {
+            return nullptr;
+        }
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return &it->second->value;
+    }
+    // stores value (of about `bytes`) under key as the most recently used, replacing what was there
+    Value &insert(const Key &key, Value value, const size_t bytes = 0) {
+        if (const auto it = _index.find(key); it != _index.end()) {
+            _bytes -= it->second->bytes;
+            _entries.erase(it->second);
+            _index.erase(it);
+        }
+        while (!_entries.empty() && (_entries.size() == Capacity || _bytes + bytes > _maxBytes)) {
+            _bytes -= _entries.back().bytes;
+            _index.erase(_entries.back().key);
+            _entries.pop_back();
+        }
+        _entries.push_front({key, std::move(value), bytes});
+        _index.emplace(key, _entries.begin());
+        _bytes += bytes;
+        return _entries.front().value;
+    }
+    void clear() {
+        _index.clear();
+        _entries.clear();
+        _bytes = 0;
+    }
+    size_t size() const { return _entries.size(); }
+    size_t bytes() const { return _bytes; }
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t bytes;
+    };
+    std::list<Entry> _entries;     // most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> _index;
+    size_t _bytes {0};
+    size_t _maxBytes;
+};
+
+}   // namespace nvs::timbrespace
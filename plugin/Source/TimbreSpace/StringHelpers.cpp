@@ -28,7 +28,7 @@ std::string str(const TrianglePoints &tri) {
                     std::string(")");
 }
 
-void printTriangles(const delaunator::Delaunator& d) {
+void printTriangles(const Triangulation & d) {
 #if WALK_STRING_DEBUGGING
     fmt::print("All triangles in triangulation: \n");
     for (size_t t = 0; t < d.triangles.size(); t += 3) {
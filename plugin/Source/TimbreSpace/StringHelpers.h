@@ -15,7 +15,7 @@ namespace nvs::timbrespace {
 std::ostream &operator<<(std::ostream &out, const Timbre2DPoint &p);
 std::string str(const Timbre2DPoint &p);
 std::string str(const TrianglePoints &tri);
-void printTriangles(const delaunator::Delaunator& d);
+void printTriangles(const Triangulation & d);
 void printTriangleIdx(size_t idx);
 void printLine(const Timbre2DPoint &p, const Timbre2DPoint &q);
 
@@ -13,9 +13,11 @@
 #include "../../slicer_granular/Source/misc_util_juce.h"
 #include "Analysis/ThreadedAnalyzer.h"
 #include "Analysis/FeatureOperations.h"
+#include "Analysis/AnalysisFileFormat.h"
+#include "Analysis/Tracing.h"
 #include <ranges>
 #include "fmt/core.h"
-#include "StringAxiom.h"
+#include "TsnStringAxiom.h"
 #include "dsp_util.h"
 
 namespace nvs::timbrespace {
@@ -26,37 +28,13 @@ namespace nvs::timbrespace {
 TimbreSpace::TimbreSpace(juce::AudioProcessorValueTreeState &apvts)
     :   _treeManager(apvts, *this)
 {}
-TimbreSpace::~TimbreSpace() {}
-
-void TimbreSpace::setPoints(std::vector<Timbre5DPoint> const &points){
-	using namespace nvs::util;
-    assert(std::ranges::all_of(points,
-        [](const auto& p) {
-            return p.cwiseAbs().maxCoeff() <= 1.0;
-        }));
-	_timbreDataManager.setPoints(points);
-}
-void TimbreSpace::clearPoints() {
-	_timbreDataManager.clear();
-}
-void TimbreSpace::TimbreDataManager::setPoints(const std::vector<Timbre5DPoint> &points) {
-    _timbres5D_pending = points;
-}
-void TimbreSpace::TimbreDataManager::clear() {
-    _timbres5D_pending.clear();
-}
-void TimbreSpace::TimbreDataManager::setPendingReady() {
-    if (_timbres5D_pending.empty()) {
-        return;
-    }
-    _pendingUpdate.store(true, std::memory_order_release);
-}
-std::vector<Timbre5DPoint> const &TimbreSpace::getTimbreSpacePoints() const {
-    return _timbreDataManager.getTimbreSpacePoints();
+TimbreSpace::~TimbreSpace() {
+    _viewWorker.cancel(this);
+    cancelPendingUpdate();
 }
 
-const std::vector<Timbre5DPoint> &TimbreSpace::TimbreDataManager::getTimbreSpacePoints() const {
-    return _timbres5D;
+auto TimbreSpace::shareTimbreSpaceView() -> std::shared_ptr<const ShapedView> {
+    return _shapedView.read().data;
 }
 
 String TimbreSpace::getAudioAbsolutePath() const {
@@ -86,12 +64,19 @@ static const std::map<juce::String, size_t> pidToDimensionMap {
 void TimbreSpace::updateDimensionwiseFeatureFromParam(const juce::String& paramID) {
     for (auto const &[s, i] : pidToDimensionMap) {
         if (paramID == s) {
-            settings.dimensionwiseFeatures[i] = static_cast<nvs::analysis::Feature_e>(_treeManager.getAPVTS().getRawParameterValue(s)->load());
-            fullSelfUpdate(false);
+            const auto feature = static_cast<nvs::analysis::Feature_e>(_treeManager.getAPVTS().getRawParameterValue(s)->load());
+            checkFeatureComputed(feature);
+            settings.dimensionwiseFeatures[i] = feature;
+            requestViewUpdate();
             return;
         }
     }
 }
+void TimbreSpace::checkFeatureComputed(const analysis::Feature_e feature) const {
+    if (!_computedGroups.test(static_cast<size_t>(analysis::descriptorGroupOf(feature))) && onFeaturesMissing) {
+        onFeaturesMissing();
+    }
+}
 void TimbreSpace::updateAllDimensionwiseFeatures(){
     for (auto const &[s, i] : pidToDimensionMap) {
         const auto val = _treeManager.getAPVTS().getRawParameterValue(s)->load();
@@ -108,14 +93,17 @@ void TimbreSpace::valueTreePropertyChanged (ValueTree &alteredTree, const juce::
         if (paramID == nvs::axiom::histogram_equalization) {
             DBG("Histogram equalization changed to: " + juce::String(newValue));
             updateHistogramEqualization();
-            DBG("tree changed! redrawing points...\n");
-            fullSelfUpdate(false);
+            requestViewUpdate();
             return;
         }
         if (paramID == nvs::axiom::statistic) {
             updateStatistic();
             DBG("tree changed! redrawing points...\n");
-            fullSelfUpdate(false);
+            requestViewUpdate();
+            return;
+        }
+        if (paramID == nvs::axiom::filtered_feature) {
+            checkFeatureComputed(static_cast<nvs::analysis::Feature_e>(_treeManager.getAPVTS().getRawParameterValue(paramID)->load()));
             return;
         }
         updateDimensionwiseFeatureFromParam(paramID);
@@ -134,27 +122,18 @@ void TimbreSpace::valueTreeRedirected (ValueTree &treeWhichHasBeenChanged) {
     }
 }
 
-using EventwiseStatisticsF = nvs::analysis::EventwiseStatistics<float>;
-
-
-juce::ValueTree timbreSpaceReprToVT(std::vector<nvs::analysis::FeatureContainer<EventwiseStatisticsF>> const &fullTimbreSpace,
-                                    std::vector<float> const &normalizedOnsets,
-                                    const juce::String& waveformHash,
-                                    const juce::String& audioAbsPath);
-
 void TimbreSpace::changeListenerCallback(juce::ChangeBroadcaster* source) {
     // could there be any reason to clear the tree? re-assigning it wouldn't need that, but
     // what if the rest of this func fails? do we want a cleared tree at that point?
     if (auto *a = dynamic_cast<nvs::analysis::ThreadedAnalyzer*>(source)){
         // TimbreSpace really only cares about getting both Onsets and TimbreSpaceAnalysis; it cannot complete its tasks without both.
         // ========================================ONSETS========================================
-        const auto onsetsResult = a->shareOnsetAnalysis();
+        auto onsetsResult = a->shareOnsetAnalysis();
         if (!onsetsResult) {
             DBG("Onsets somehow null; returning\n");
             return;
         }
-        auto const &onsets = onsetsResult->onsets;
-        if (onsets.empty()) {
+        if (onsetsResult->onsets.empty()) {
             DBG("Onsets have 0 length");
             return;
         }
@@ -165,6 +144,15 @@ void TimbreSpace::changeListenerCallback(juce::ChangeBroadcaster* source) {
             DBG("No analysis available\n");
             return;
         }
+        if (onsetsResult->provisional != analysisResult->provisional) {
+            // the full result landed between the two reads; its onsets were published before it
+            onsetsResult = a->shareOnsetAnalysis();
+            if (!onsetsResult || onsetsResult->provisional != analysisResult->provisional) {
+                DBG("Onsets and timbre analysis from different passes; returning\n");
+                return;
+            }
+        }
+        auto const &onsets = onsetsResult->onsets;
         auto const &tspace = analysisResult.value().timbreMeasurements;
 
         const String waveformHash = onsetsResult->waveformHash;
@@ -173,10 +161,16 @@ void TimbreSpace::changeListenerCallback(juce::ChangeBroadcaster* source) {
         if (waveformHash != analysisResult.value().waveformHash || absFilePath != analysisResult.value().audioFileAbsPath) {
             DBG("Discrepancy between onsets and timbre analysis\n");
         }
-        setTimbreSpaceTree(timbreSpaceReprToVT(tspace, onsets, waveformHash, absFilePath));
-
-        setSavePending(true);
-        signalSaveAnalysisOption();
+        const auto storage = a->getSettings().analysis.featureStorage;
+        setTimbreSpaceTree(analysis::timbreSpaceReprToVT(tspace, onsets, waveformHash, absFilePath, storage),
+                           analysisResult->computedGroups, analysisResult->provisional);
+
+        // a provisional map is only shown and played until the full one replaces it, and a lazy one until its last
+        // features are in; neither is worth saving
+        if (!isProvisional() && hasAllFeatures()) {
+            setSavePending(true);
+            signalSaveAnalysisOption();
+        }
         signalOnsetsAvailable();
     }
 }
@@ -190,24 +184,12 @@ void TimbreSpace::updateStatistic() {
 }
 
 
-void addEventwiseStatistics(juce::ValueTree& tree, const analysis::EventwiseStatistics<analysis::Real>& stats) {
-	tree.setProperty(axiom::mean, stats.mean, nullptr);
-	tree.setProperty(axiom::median, stats.median, nullptr);
-	tree.setProperty(axiom::variance, stats.variance, nullptr);
-	tree.setProperty(axiom::skewness, stats.skewness, nullptr);
-	tree.setProperty(axiom::kurtosis, stats.kurtosis, nullptr);
-}
-analysis::EventwiseStatistics<analysis::Real> toEventwiseStatistics(juce::ValueTree const &vt){
-	return {
-		.mean = vt.getProperty(axiom::mean),
-		.median = vt.getProperty(axiom::median),
-		.variance = vt.getProperty(axiom::variance),
-		.skewness = vt.getProperty(axiom::skewness),
-		.kurtosis = vt.getProperty(axiom::kurtosis)
-	};
-}
-void TimbreSpace::setTimbreSpaceTree(ValueTree const &timbreSpaceTree) {
+void TimbreSpace::setTimbreSpaceTree(ValueTree const &timbreSpaceTree, const analysis::DescriptorGroups computedGroups,
+                                     const bool provisional) {
+    _computedGroups = computedGroups;
+    _provisional = provisional;
 	_treeManager.setTimbreSpaceTree(timbreSpaceTree);
+    _featureTable = std::make_shared<const FeatureTable>(timbreSpaceTree);
     signalTimbreSpaceTreeChanged();
     const auto onsetsVar = timbreSpaceTree.getProperty(axiom::NormalizedOnsets);
     if (const Array<var> *onsetsArray = onsetsVar.getArray()) {
@@ -221,130 +203,7 @@ void TimbreSpace::setTimbreSpaceTree(ValueTree const &timbreSpaceTree) {
             _onsetAnalysis = std::make_shared<analysis::OnsetAnalysisResult>(onsets, waveformHash, path);
         }
     }
-	fullSelfUpdate(false);
-}
-
-juce::ValueTree timbreSpaceReprToVT(std::vector<nvs::analysis::FeatureContainer<EventwiseStatisticsF>> const &fullTimbreSpace,
-									std::vector<float> const &normalizedOnsets,
-									const juce::String& waveformHash,
-									const juce::String& audioAbsPath){
-	ValueTree vt(axiom::TimbreAnalysis);
-	{
-		ValueTree md(axiom::Metadata);
-		md.setProperty(axiom::Version, ProjectInfo::versionString, nullptr);
-		md.setProperty(axiom::audioHash, waveformHash, nullptr);
-		md.setProperty(axiom::AudioFilePathAbsolute, audioAbsPath, nullptr);
-		md.setProperty(axiom::CreationTime, {}, nullptr);
-		md.setProperty(axiom::AnalysisSettings, {}, nullptr);
-		vt.addChild(md, 0, nullptr);
-	}
-	{
-		var onsetArray;
-		for (auto const &o : normalizedOnsets) {
-			onsetArray.append(o);
-		}
-		vt.setProperty(axiom::NormalizedOnsets, onsetArray, nullptr);
-	}
-	{
-		ValueTree timbreMeasurements("TimbreMeasurements");
-		
-		for (int frameIdx = 0; frameIdx < static_cast<int>(fullTimbreSpace.size()); ++frameIdx){
-			const auto &timbreFrame = fullTimbreSpace[frameIdx];
-			
-			ValueTree frameTree(axiom::Frame);
-			
-			ValueTree bfccsTree(axiom::BFCCs);
-		    {
-			    const auto &bfccs = timbreFrame.bfccs();
-		        for (int bfccIdx = 0; bfccIdx < static_cast<int>(bfccs.size()); ++bfccIdx){
-		            ValueTree bfccTree("BFCC" + juce::String(bfccIdx));
-		            addEventwiseStatistics(bfccTree, bfccs[bfccIdx]);
-		            bfccsTree.addChild(bfccTree, bfccIdx, nullptr);
-		        }
-		    }
-			frameTree.addChild(bfccsTree, -1, nullptr);
-			
-			// Add single-value features
-		    for (auto feature : nvs::util::Iterator<analysis::Feature_e, static_cast<analysis::Feature_e>(analysis::NumBFCC), analysis::Feature_e::f0>()) {
-		        ValueTree featureTree(analysis::toString(feature));
-		        addEventwiseStatistics(featureTree, timbreFrame[feature]);
-		        frameTree.addChild(featureTree, -1, nullptr);
-		    }
-
-			timbreMeasurements.addChild(frameTree, frameIdx, nullptr);
-			
-			vt.addChild(timbreMeasurements, 1, nullptr);
-		}
-	}
-
-	return vt;
-}
-std::vector<nvs::analysis::FeatureContainer<EventwiseStatisticsF>> valueTreeToTimbreSpace(juce::ValueTree const &vt)
-{
-    using namespace analysis;
-
-	std::vector<FeatureContainer<EventwiseStatisticsF>> timbreSpace;
-	
-	auto timbreMeasurements = vt.getChildWithName(axiom::TimbreMeasurements);
-	if (!timbreMeasurements.isValid())
-		return timbreSpace;
-	
-	// Reserve space for efficiency
-	timbreSpace.reserve(timbreMeasurements.getNumChildren());
-
-    static_assert(static_cast<Feature_e>(0) == Feature_e::bfcc0); // we will be casting ints to Features for the BFCCs
-    static_assert(static_cast<Feature_e>(12) == Feature_e::bfcc12);
-	for (int frameIdx = 0; frameIdx < timbreMeasurements.getNumChildren(); ++frameIdx)
-	{
-		auto frameTree = timbreMeasurements.getChild(frameIdx);
-		FeatureContainer<EventwiseStatisticsF> frame;
-		
-		// Extract BFCCs
-		if (auto bfccsTree = frameTree.getChildWithName(axiom::BFCCs);
-		    bfccsTree.isValid())
-		{
-			for (int bfccIdx = 0; bfccIdx < bfccsTree.getNumChildren(); ++bfccIdx)
-			{
-				auto bfccTree = bfccsTree.getChild(bfccIdx);
-				frame[static_cast<Feature_e>(bfccIdx)] = (toEventwiseStatistics(bfccTree));
-			}
-		}
-		
-		// Extract single-value features
-	    for (auto const feature :  nvs::util::Iterator<Feature_e, static_cast<Feature_e>(NumBFCC), Feature_e::f0>()) {
-	        if (auto featureTree = frameTree.getChildWithName(toString(feature));
-                featureTree.isValid())
-	        {
-	            frame[feature] = toEventwiseStatistics(featureTree);
-	        }
-	    }
-
-		timbreSpace.push_back(std::move(frame));
-	}
-	
-	return timbreSpace;
-}
-
-std::vector<float> valueTreeToNormalizedOnsets(juce::ValueTree const &vt)
-{
-	std::vector<float> normalizedOnsets;
-
-	const auto onsetArray = vt.getProperty(axiom::NormalizedOnsets);
-	if (!onsetArray.isArray())
-		return normalizedOnsets;
-	
-	auto* array = onsetArray.getArray();
-	if (!array)
-		return normalizedOnsets;
-	
-	normalizedOnsets.reserve(array->size());
-	
-	for (auto && e : *array)
-	{
-		normalizedOnsets.push_back(static_cast<float>(e));
-	}
-	
-	return normalizedOnsets;
+	requestViewUpdate();
 }
 
 TimbreSpace::TreeManager::TreeManager(AudioProcessorValueTreeState &apvts, TimbreSpace &timbreSpace)
@@ -395,146 +254,125 @@ void TimbreSpace::signalShapedPointsAvailable() const {
     sendActionMessage(axiom::shapedPointsAvailable);
 }
 void TimbreSpace::signalTimbreSpaceTreeChanged() const {
-    sendActionMessage(axiom::timbreSpaceTreeChanged);   // for TimbreSpacePointSelector to know to update filtered feature
+    sendActionMessage(axiom::timbreSpaceTreeChanged);   // for anything that keeps state per dataset
 }
 
-void TimbreSpace::TimbreDataManager::swapIfPending() {
-    if (_pendingUpdate.exchange(false, std::memory_order_acq_rel))
+void TimbreSpace::handleAsyncUpdate() {
+    // views finishing in quick succession coalesce into one update; announce only points not announced yet
+    if (const auto generation = _shapedView.read().generation;
+        generation != _signalledGeneration)
     {
-        _timbres5D = std::move(_timbres5D_pending);
+        _signalledGeneration = generation;
+        signalShapedPointsAvailable();
     }
 }
 
-void TimbreSpace::fullSelfUpdate(const bool verbose){
-	extractTimbralFeatures(verbose);
-	computeHistogramEqualizedPoints(verbose);
-	reshape(verbose);
-	_timbreDataManager.setPendingReady();// _pendingUpdate.store(true, std::memory_order_release);
-    _timbreDataManager.swapIfPending();
-
-    signalShapedPointsAvailable();
+//================================================FeatureTable==================================================
+FeatureTable::FeatureTable(const ValueTree &timbreSpaceTree) {
+    if (const auto quantizedTree = timbreSpaceTree.getChildWithName(axiom::QuantizedMeasurements);
+        quantizedTree.isValid())
+    {
+        _quantizedStore = analysis::QuantizedFeatureStore::fromValueTree(quantizedTree);
+        jassert(_quantizedStore.has_value());
+        return;
+    }
+    _measurements = analysis::valueTreeToTimbreSpace(timbreSpaceTree);
 }
-// Internal template that works with any container
-template<typename Container>
-[[nodiscard]]
-inline std::vector<analysis::Real>
-extractFeaturesFromTreeImpl(const juce::ValueTree &frameTree,
-                             const Container &featuresToUse,
-                             const analysis::Statistic statisticToUse)
-{
+size_t FeatureTable::getNumEvents() const {
+    return _quantizedStore.has_value() ? _quantizedStore->getNumEvents() : _measurements.size();
+}
+std::vector<float> FeatureTable::getColumn(const analysis::Feature_e feature, const analysis::Statistic statistic) const {
     using namespace analysis;
-    std::vector<Real> out;
-
-    if constexpr (requires { featuresToUse.size(); }) {
-        out.reserve(featuresToUse.size());
+    if (_quantizedStore.has_value()) {
+        // dequantize only the columns in view
+        return _quantizedStore->getColumn(feature, statistic);
     }
-
-    juce::String statPropName;
-    switch (statisticToUse) {
-       case Statistic::Mean:     statPropName = axiom::mean;     break;
-       case Statistic::Median:   statPropName = axiom::median;   break;
-       case Statistic::Variance: statPropName = axiom::variance; break;
-       case Statistic::Skewness: statPropName = axiom::skewness; break;
-       case Statistic::Kurtosis: statPropName = axiom::kurtosis; break;
-       default: jassertfalse;
+    float EventwiseStatistics<float>::* ptr = nullptr;
+    switch (statistic) {
+        case Statistic::Mean:     ptr = &EventwiseStatistics<float>::mean;     break;
+        case Statistic::Median:   ptr = &EventwiseStatistics<float>::median;   break;
+        case Statistic::Variance: ptr = &EventwiseStatistics<float>::variance; break;
+        case Statistic::Skewness: ptr = &EventwiseStatistics<float>::skewness; break;
+        case Statistic::Kurtosis: ptr = &EventwiseStatistics<float>::kurtosis; break;
+        default: jassertfalse; return std::vector<float>(_measurements.size(), 0.f);
     }
-
-    for (auto f : featuresToUse) {
-       const int idx = static_cast<int>(f);
-       Real value = 0.0f;
-
-       if (0 <= idx && idx < NumBFCC) {
-          const auto bfccsTree = frameTree.getChildWithName(axiom::BFCCs);
-          if (bfccsTree.isValid() && idx < bfccsTree.getNumChildren()) {
-             auto bfccTree = bfccsTree.getChild(idx);
-             value = bfccTree.getProperty(statPropName, 0.0f);
-          }
-       }
-       else {
-          juce::String childName;
-          switch (f) {
-            case Feature_e::SpectralCentroid:    childName = axiom::SpectralCentroid; break;
-            case Feature_e::SpectralDecrease:    childName = axiom::SpectralDecrease; break;
-            case Feature_e::SpectralFlatness:    childName = axiom::SpectralFlatness; break;
-            case Feature_e::SpectralCrest:       childName = axiom::SpectralCrest; break;
-            case Feature_e::SpectralComplexity:  childName = axiom::SpectralComplexity; break;
-            case Feature_e::StrongPeak:          childName = axiom::StrongPeak; break;
-            case Feature_e::Periodicity:         childName = axiom::Periodicity; break;
-            case Feature_e::Loudness:            childName = axiom::Loudness;    break;
-            case Feature_e::f0:                  childName = axiom::f0;          break;
-            default: jassertfalse;
-          }
-
-            if (auto scalarTree = frameTree.getChildWithName(childName);
-                scalarTree.isValid())
-            {
-                value = scalarTree.getProperty(statPropName, 0.0f);
-            }
-       }
-
-       out.push_back(value);
+    std::vector<float> column;
+    column.reserve(_measurements.size());
+    for (auto const &event : _measurements) {
+        column.push_back(event[feature].*ptr);
     }
-
-    return out;
-}
-
-[[nodiscard]]
-inline std::vector<analysis::Real>
-extractFeaturesFromTree(const juce::ValueTree &frameTree,
-                        const std::vector<analysis::Feature_e> &featuresToUse,
-                        const analysis::Statistic statisticToUse)
-{
-    return extractFeaturesFromTreeImpl(frameTree, featuresToUse, statisticToUse);
-}
-
-// Overload for single feature - wraps it in a std::array for iteration
-[[nodiscard]]
-inline std::vector<analysis::Real>
-extractFeaturesFromTree(const juce::ValueTree &frameTree,
-                        const analysis::Feature_e featureToUse,
-                        const analysis::Statistic statisticToUse)
-{
-    const std::array features{featureToUse};
-    return extractFeaturesFromTreeImpl(frameTree, features, statisticToUse);
+    return column;
 }
 
-std::vector<float> TimbreSpace::getRawFeatureValues(const nvs::analysis::Feature_e feature) const {
-    auto const s = nvs::analysis::toString(feature);
-
-    if (nvs::util::isEmpty(_treeManager.getTimbreSpaceTree())){ return {}; }
-
-    auto const &timbreTree = _treeManager.getTimbralFramesTree();
-
-    std::vector<float> extractedFramewiseFeatureValues;
-
-    for (int feat_idx = 0; feat_idx < timbreTree.getNumChildren(); ++feat_idx) {
-        ValueTree const &frame = timbreTree.getChild(feat_idx);
-        std::vector<float> v = extractFeaturesFromTree(frame, feature, settings.statistic);
-        jassert (v.size() == 1);
-        extractedFramewiseFeatureValues.push_back(v[0]);
+//===============================================TimbreSpace view===============================================
+void TimbreSpace::requestViewUpdate() {
+    if (_featureTable == nullptr || _featureTable->getNumEvents() == 0) {
+        return;
     }
-    return extractedFramewiseFeatureValues;
+    ViewRequest request {
+        .features = _featureTable,
+        .dimensionwiseFeatures = settings.dimensionwiseFeatures,
+        .statistic = settings.statistic,
+        .histogramEqualization = settings.histogramEqualization
+    };
+    _viewWorker.post(this, [this, request = std::move(request)](const analysis::ShouldExitFn &shouldExit) {
+        computeView(request, shouldExit);
+    });
 }
 
-void TimbreSpace::extractTimbralFeatures(const bool verbose) {
-    if (verbose)
-        DBG("Extracting timbre points\n");
-
-	auto const &featuresToExtract = settings.dimensionwiseFeatures;
-	if (nvs::util::isEmpty(_treeManager.getTimbreSpaceTree())){
-		if (verbose)
-		    DBG("TimbreSpace::extractTimbralFeatures: timbre space empty, early exit\n");
+void TimbreSpace::computeView(const ViewRequest &request, const analysis::ShouldExitFn &shouldExit){
+	TSN_TRACE_SPAN("TimbreSpace::computeView");
+	DimensionSet extracted;
+	{
+		TSN_TRACE_SPAN("extractTimbralFeatures");
+		extracted = extractTimbralFeatures(request);
+	}
+	// the stages run to the end even if superseded meanwhile, so that the cache stays consistent for the next request
+	{
+		TSN_TRACE_SPAN("normalizeColumns");
+		normalizeColumns(extracted);
+	}
+	{
+		TSN_TRACE_SPAN("computeHistogramEqualizedPoints");
+		computeHistogramEqualizedPoints(extracted);
+	}
+	std::vector<Timbre5DPoint> points;
+	{
+		TSN_TRACE_SPAN("reshape");
+		points = reshape(request.histogramEqualization);
+	}
+	if (points.empty() || shouldExit()) {
 		return;
 	}
-	_eventwiseExtractedTimbrePoints.clear();
-	_eventwiseExtractedTimbrePoints.reserve(_treeManager.getNumFrames());
-	
-	auto const &timbralFramesTree = _treeManager.getTimbralFramesTree();
-	for (int frameIdx = 0; frameIdx < timbralFramesTree.getNumChildren(); ++frameIdx) {
-		ValueTree const &frame = timbralFramesTree.getChild(frameIdx);
-		std::vector<float> v = extractFeaturesFromTree(frame, featuresToExtract, settings.statistic);
-		_eventwiseExtractedTimbrePoints.push_back(v);
+	assert(std::ranges::all_of(points,
+	    [](const auto& p) {
+	        return p.cwiseAbs().maxCoeff() <= 1.0;
+	    }));
+	_shapedView.publish(std::make_shared<const ShapedView>(ShapedView{request, std::move(points)}));
+	triggerAsyncUpdate();
+}
+
+std::vector<float> TimbreSpace::getRawFeatureValues(const nvs::analysis::Feature_e feature) const {
+    if (_featureTable == nullptr){ return {}; }
+    return _featureTable->getColumn(feature, settings.statistic);
+}
+
+auto TimbreSpace::extractTimbralFeatures(const ViewRequest &request) -> DimensionSet {
+	auto &cache = _viewCache;
+	const bool sameSource = cache.source == request.features && cache.statistic == request.statistic;
+	DimensionSet extracted;
+	for (size_t d = 0; d < numDimensions; ++d) {
+		auto const feature = request.dimensionwiseFeatures[d];
+		if (sameSource && cache.columnFeatures[d] == feature) {
+			continue;
+		}
+		cache.columns[d] = request.features->getColumn(feature, request.statistic);
+		cache.columnFeatures[d] = feature;
+		extracted.set(d);
 	}
+	cache.source = request.features;
+	cache.statistic = request.statistic;
+	return extracted;
 }
 
 std::vector<float> getHistoEqualizationVec(std::vector<float> const &points){
@@ -562,57 +400,8 @@ std::vector<float> getHistoEqualizationVec(std::vector<float> const &points){
 	return vecOut;
 }
 
-void TimbreSpace::computeHistogramEqualizedPoints(const bool verbose)
-{	/** to be called when the actual analyzed timbre space changes  */
-
-    if(verbose)
-        DBG("updating timbre points\n");
-
-	if (_eventwiseExtractedTimbrePoints.empty()){
-		if (verbose)
-		    DBG("updateAndDrawTimbreSpacePoints: timbreSpace empty, returning...\n");
-		return;
-	}
-	{
-		auto const n_dim = _eventwiseExtractedTimbrePoints[0].size();
-		_ranges.clear();
-		_ranges.reserve(n_dim);
-		
-		for (size_t i = 0; i < n_dim; ++i){
-			_ranges.push_back(nvs::analysis::calculateRangeOfDimension(_eventwiseExtractedTimbrePoints, i));
-		}
-	}
-	{
-		std::vector<float> allDim0, allDim1;
-		allDim0.reserve(_eventwiseExtractedTimbrePoints.size());
-		allDim1.reserve(_eventwiseExtractedTimbrePoints.size());
-		for (auto const& frame : _eventwiseExtractedTimbrePoints){
-			allDim0.push_back(frame[0]);	// e.g. bfcc1
-			allDim1.push_back(frame[1]);	// e.g. bfcc2
-		}
-		_histoEqualizedD0 = getHistoEqualizationVec(allDim0);
-		_histoEqualizedD1 = getHistoEqualizationVec(allDim1);
-	}
-}
-void TimbreSpace::reshape(const bool verbose)
-{   /** to be called when we only want to change the VIEW of the timbre points (which will also need to happen when the timbre space itself changes) */
-    if (verbose)
-        DBG("reshaping timbre space\n");
-
-    if (_eventwiseExtractedTimbrePoints.empty()){
-        if (verbose)
-            DBG("drawTimbreSpacePoints: _eventwiseExtractedTimbrePoints empty, returning...");
-        return;
-    }
-    
-    std::vector<std::vector<float>> const &timbreSpaceRepr = _eventwiseExtractedTimbrePoints;
-    if (timbreSpaceRepr[0].size() != _ranges.size()){
-        if (verbose)
-            DBG("drawTimbreSpacePoints: point size mismatch, exiting early");
-        jassertfalse;
-        return;
-    }
-    
+void TimbreSpace::normalizeColumns(const DimensionSet dims) {
+    auto &cache = _viewCache;
     auto normalizer = [](float x, std::pair<float, float> range) -> float
     {
         auto r = (range.second - range.first);
@@ -622,56 +411,80 @@ void TimbreSpace::reshape(const bool verbose)
         }
         return juce::jmap(y01, -1.f, 1.f);
     };
-    
     auto squash = [](const float xNorm) -> float { return std::asinh(10.0f*xNorm) / static_cast<float>(M_PI); };
-    auto foo = [&](const float x, const std::pair<float, float> &range) -> float { return squash(normalizer(x, range)); };
-
-    // clear points of timbreSpaceHolds
-    clearPoints(); // clearing to make way for points we're about to be adding
-
-    std::vector<Timbre5DPoint> points;
-    points.reserve(timbreSpaceRepr.size());
-    for (size_t i = 0; i < timbreSpaceRepr.size(); ++i) {
-        static constexpr size_t nDim {5};
-        std::vector<float> const &timbreFrame = timbreSpaceRepr[i];
-        
-        jassert (timbreFrame.size() >= nDim);
-
-        // ========================================2D========================================
-        // squash normalized points within dimension range
-        Timbre2DPoint pNL(foo(timbreFrame[0], _ranges[0]),
-                          foo(timbreFrame[1], _ranges[1]));
-        
-        // histogram equalization
-        float const &equalizedX = _histoEqualizedD0[i];
-        float const &equalizedY = _histoEqualizedD1[i];
-        
-        Timbre2DPoint pHE(juce::jmap(equalizedX, -1.f, 1.f),
-                          juce::jmap(equalizedY, -1.f, 1.f));
-    
-        float c = settings.histogramEqualization;
-        jassert (0.0 <= c && c <= 1.0);
-        Timbre2DPoint p = (1.f - c) * pNL + c * pHE; 
-        
-        // ========================================3D========================================
-        Timbre3DPoint color(normalizer(timbreFrame[2], _ranges[2]),
-                           normalizer(timbreFrame[3], _ranges[3]),
-                           normalizer(timbreFrame[4], _ranges[4]));
-        
-        // with this method, there is the guarantee that
-        // the Nth member of timbreSpaceComponent._timbres5D corresponds to
-        // the Nth member of onsets.
-        constexpr float padding_scalar = 0.95f;
-
-#pragma message("maybe we should build up the points, then add all instead of one by one. there is occassional bug when histo equalizing otherwise")
-        points.emplace_back((Timbre5DPoint() << p * padding_scalar, color).finished());
-
-        if (verbose){
-            DBG(fmt::format("adding the point  {:.3f}, {:.3f}\n", p(0), p(1)));
+
+    for (size_t d = 0; d < numDimensions; ++d) {
+        if (!dims.test(d)) {
+            continue;
+        }
+        auto const &column = cache.columns[d];
+        auto &normalized = cache.normalized[d];
+        normalized.resize(column.size());
+        if (column.empty()) {
+            continue;
+        }
+        const auto [lo, hi] = std::ranges::minmax_element(column);
+        const Range range {*lo, *hi};
+        cache.ranges[d] = range;
+        if (d < numPositionDimensions) {
+            // squash normalized points within dimension range
+            std::ranges::transform(column, normalized.begin(), [&](const float x) { return squash(normalizer(x, range)); });
+        } else {
+            std::ranges::transform(column, normalized.begin(), [&](const float x) { return normalizer(x, range); });
+        }
+    }
+}
+
+void TimbreSpace::computeHistogramEqualizedPoints(const DimensionSet dims)
+{	/** to be called when the position columns change  */
+    auto &cache = _viewCache;
+    for (size_t d = 0; d < numPositionDimensions; ++d) {
+        if (!dims.test(d)) {
+            continue;
+        }
+        cache.equalized[d] = getHistoEqualizationVec(cache.columns[d]);
+        for (auto &e : cache.equalized[d]) {
+            e = juce::jmap(e, -1.f, 1.f);
         }
     }
-    setPoints(points);
 }
+std::vector<Timbre5DPoint> TimbreSpace::reshape(const float c) const
+{   /** to be called when we only want to change the VIEW of the timbre points (which will also need to happen when the timbre space itself changes) */
+    auto const &cache = _viewCache;
+    const size_t n = cache.numEvents();
+    if (n == 0){
+        return {};
+    }
+    const bool consistent = std::ranges::all_of(cache.normalized, [n](const auto &v) { return v.size() == n; })
+                        &&  std::ranges::all_of(cache.equalized, [n](const auto &v) { return v.size() == n; });
+    if (!consistent){
+        DBG("reshape: point size mismatch, exiting early");
+        jassertfalse;
+        return {};
+    }
+
+    jassert (0.0 <= c && c <= 1.0);
+    constexpr float padding_scalar = 0.95f;
+    // the blend between the linear normalized and histogram equalized positions, as one flat lerp per dimension
+    std::array<std::vector<float>, numPositionDimensions> blended;
+    for (size_t d = 0; d < numPositionDimensions; ++d) {
+        blended[d].resize(n);
+        const float *pNL = cache.normalized[d].data();
+        const float *pHE = cache.equalized[d].data();
+        float *p = blended[d].data();
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = ((1.f - c) * pNL[i] + c * pHE[i]) * padding_scalar;
+        }
+    }
 
+    // with this method, there is the guarantee that
+    // the Nth member of timbreSpaceComponent._timbres5D corresponds to
+    // the Nth member of onsets.
+    std::vector<Timbre5DPoint> points(n);
+    for (size_t i = 0; i < n; ++i) {
+        points[i] << blended[0][i], blended[1][i], cache.normalized[2][i], cache.normalized[3][i], cache.normalized[4][i];
+    }
+    return points;
+}
 
 }	// namespace nvs::timbrespace
@@ -11,15 +11,36 @@
 #pragma once
 #include "../Analysis/Features.h"
 #include "../Analysis/Statistics.h"
+#include "../Analysis/QuantizedFeatureStore.h"
 #include "../Analysis/OnsetAnalysis/OnsetAnalysisResult.h"
 #include "TimbrePointTypes.h"
+#include "ViewRecomputeWorker.h"
+#include "TripleBuffer.h"
 #include "../../delaunator-cpp/include/delaunator.hpp"
 
 namespace nvs::timbrespace {
 
+/**
+ * Every feature of every event of an analysis, decoded once from its tree. Immutable, so that views can be computed
+ * from it on any thread while the message thread goes on to another tree.
+ */
+class FeatureTable {
+public:
+	explicit FeatureTable(const ValueTree &timbreSpaceTree);
+	std::vector<float> getColumn(analysis::Feature_e feature, analysis::Statistic statistic) const;
+	size_t getNumEvents() const;
+	bool isQuantized() const { return _quantizedStore.has_value(); }
+private:
+	std::vector<analysis::FeatureContainer<analysis::EventwiseStatistics<float>>> _measurements;  // unless quantized
+	// decoded from the tree's QuantizedMeasurements child, if the analysis was stored quantized. when present, it
+	// replaces the per-frame TimbreMeasurements children as the source of feature values.
+	std::optional<analysis::QuantizedFeatureStore> _quantizedStore;
+};
+
 class TimbreSpace final :	public juce::ChangeListener
 ,						    public juce::ValueTree::Listener
 ,						    public juce::ActionBroadcaster
+,						    private juce::AsyncUpdater
 {
 public:
     explicit TimbreSpace(juce::AudioProcessorValueTreeState &apvts);
@@ -30,12 +51,35 @@ public:
 	TimbreSpace(TimbreSpace&&) noexcept = delete;
 	TimbreSpace& operator=(TimbreSpace&&) noexcept = delete;
 	//=============================================================================================================================
-	std::vector<Timbre5DPoint> const &getTimbreSpacePoints() const;
+	// what a view is computed from
+    struct ViewRequest {
+        std::shared_ptr<const FeatureTable> features;
+        std::vector<analysis::Feature_e> dimensionwiseFeatures;
+        analysis::Statistic statistic;
+        float histogramEqualization;
+    };
+    struct ShapedView {
+        ViewRequest request;
+        std::vector<Timbre5DPoint> points;
+    };
+	// message thread: the latest finished view; null until the first one is done
+	std::shared_ptr<const ShapedView> shareTimbreSpaceView();
 	std::shared_ptr<analysis::OnsetAnalysisResult> shareOnsets() const;
 	//=============================================================================================================================
-	void setTimbreSpaceTree(ValueTree const &timbreSpaceTree);
+	// computedGroups: those the analysis has filled in so far (see axiom::lazyFeatures)
+	// provisional: the tree is the coarse sketch that the full analysis will replace (see ThreadedAnalyzer)
+	void setTimbreSpaceTree(ValueTree const &timbreSpaceTree, analysis::DescriptorGroups computedGroups = analysis::allDescriptorGroups(),
+	                        bool provisional = false);
 	ValueTree getTimbreSpaceTree() const { return _treeManager.getTimbreSpaceTree(); }
+	bool usesQuantizedFeatureStore() const { return _featureTable != nullptr && _featureTable->isQuantized(); }
     std::vector<float> getRawFeatureValues(nvs::analysis::Feature_e feature) const;
+    std::shared_ptr<const FeatureTable> shareFeatureTable() const { return _featureTable; }
+    analysis::Statistic getStatistic() const { return settings.statistic; }
+    std::vector<nvs::analysis::Feature_e> const &getDimensionwiseFeatures() const { return settings.dimensionwiseFeatures; }
+    bool hasAllFeatures() const { return _computedGroups.all(); }
+    bool isProvisional() const { return _provisional; }
+    // called (message thread) when an axis or the filter switches to a feature the analysis has not computed yet
+    std::function<void()> onFeaturesMissing;
 	//=============================================================================================================================
 	bool hasValidAnalysisFor(String const &waveformHash) const;
     String getAudioAbsolutePath() const;
@@ -43,13 +87,17 @@ public:
     void setSavePending(const bool saveIsPending) { _analysisSavePending = saveIsPending; }
     bool isSavePending() const { return _analysisSavePending; }
     //=============================================================================================================================
+    // shared with TimbreSpacePointSelector, so that its filter runs after the view it filters
+    ViewRecomputeWorker &getViewWorker() { return _viewWorker; }
+    //=============================================================================================================================
 private:
 	void valueTreePropertyChanged (ValueTree &alteredTree, const juce::Identifier &property) override;
 	void valueTreeRedirected (ValueTree &treeWhichHasBeenChanged) override;
 	void changeListenerCallback(juce::ChangeBroadcaster *source) override; // conditionally calls analyzerUpdated
+	void handleAsyncUpdate() override; // a view finished on the worker
     // void analyzerUpdated(nvs::analysis::ThreadedAnalyzer &a);
 
-    void updateDimensionwiseFeatureFromParam(const String& paramID); // updates settings.dimensionwiseFeatures from tree for selected feature and calls fullSelfUpdate
+    void updateDimensionwiseFeatureFromParam(const String& paramID); // updates settings.dimensionwiseFeatures from tree for selected feature and requests a view update
     void updateAllDimensionwiseFeatures();  //  updates settings.dimensionwiseFeatures from tree ALL features. does NOT call any update function.
     void updateHistogramEqualization();
     void updateStatistic();
@@ -67,32 +115,12 @@ private:
 	} settings;
 	//=============================================================================================================================
     std::shared_ptr<analysis::OnsetAnalysisResult> _onsetAnalysis;
+    analysis::DescriptorGroups _computedGroups {analysis::allDescriptorGroups()};
+    bool _provisional {false};
+    void checkFeatureComputed(analysis::Feature_e feature) const;
 	//=============================================================================================================================
-    class TimbreDataManager {
-    public:
-        void swapIfPending();
-
-        // audio thread: read current stable data
-        const std::vector<Timbre5DPoint>& getTimbreSpacePoints() const;
-        void setPoints(const std::vector<Timbre5DPoint>& points); // only gets called downstream from reshape()
-        void clear();
-
-        bool isEmpty() const { return _timbres5D.empty(); }
-        size_t size() const { return _timbres5D.size(); }
-
-        void setPendingReady();
-    private:
-        // current stable data (audio thread reads)
-        std::vector<Timbre5DPoint> _timbres5D;
-        // pending data (message thread writes)
-        std::vector<Timbre5DPoint> _timbres5D_pending;
-        // for thread synchronization
-        std::atomic<bool> _pendingUpdate { false };
-    } _timbreDataManager;
-
-    //=============================================================================================================================
-    void setPoints(std::vector<Timbre5DPoint> const &points);
-    void clearPoints();
+    TripleBuffer<ShapedView> _shapedView;       // published by the worker, read by the message thread
+    std::uint64_t _signalledGeneration {0};     // of _shapedView, last announced with shapedPointsAvailable
     //=============================================================================================================================
 	class TreeManager {
 	public:
@@ -111,6 +139,7 @@ private:
 	} _treeManager;
 	
 	bool _analysisSavePending {false};
+	std::shared_ptr<const FeatureTable> _featureTable;  // of the current tree
 	
     //=============================================================================================================================
 	void signalSaveAnalysisOption() const;
@@ -119,19 +148,42 @@ private:
     void signalTimbreSpaceTreeChanged() const;
     //=============================================================================================================================
 
-	void fullSelfUpdate(bool verbose); // simply calls the following 3 functions:
-	void extractTimbralFeatures(bool verbose=false); // based on settings.dimensionwiseFeatures and settings.statistic, (re)populates _eventwiseExtractedTimbrePoints
-	void computeHistogramEqualizedPoints(bool verbose=false); // based on _eventwiseExtractedTimbrePoints, computes _ranges and _histoEqualized dimensions
-	void reshape(bool verbose=false); // performs some math such as normalization, squashing, and interpolation (between linear normalized and histogram normalized) on _eventwiseExtractedTimbrePoints (NOT in place) to update _timbreDataManager._timbres5D_pending
-    //=============================================================================================================================
-    // used only in extractTimbralFeatures(), computeHistogramEqualizedPoints, and reshape()
-    std::vector<std::vector<float>> _eventwiseExtractedTimbrePoints;	// gets extracted from _treeManager._timbreSpaceTree any time new view (e.g. different feature set) is requested
-    //=============================================================================================================================
-    // the following are used in reshape():
+	// the view is computed on _viewWorker, from a copy of the settings it depends on, so that the message thread never
+	// waits on it and a burst of changes (e.g. a slider drag) costs one recompute for its latest values.
+	// it is computed in cached stages, each redone only for the dimensions whose own inputs changed:
+	//	extracted columns		<- the feature table, the dimension's feature, the statistic
+	//	ranges, normalized		<- extracted columns (squashed for the 2D position, linear for the color dimensions)
+	//	equalized				<- extracted columns (2D position only)
+	//	blended points			<- normalized, equalized, histogramEqualization
+	// so that e.g. sweeping the histogram equalization amount only redoes the blend.
     typedef std::pair<float, float> Range;
-    std::vector<Range> _ranges {}; // min, max per dimension computed ASAP to efficiently allow histogram equalization
-    std::vector<float> _histoEqualizedD0, _histoEqualizedD1 {};
+    static constexpr size_t numDimensions {5};
+    static constexpr size_t numPositionDimensions {2};     // the others are color
+    using DimensionSet = std::bitset<numDimensions>;
+	void requestViewUpdate(); // message thread: posts the current settings to the worker
+	void computeView(const ViewRequest &request, const analysis::ShouldExitFn &shouldExit); // worker: runs the stages below, then publishes the points
+	DimensionSet extractTimbralFeatures(const ViewRequest &request); // re-extracts the columns whose inputs changed, returning which
+	void normalizeColumns(DimensionSet dims); // computes the range and normalized coordinates of dims
+	void computeHistogramEqualizedPoints(DimensionSet dims); // computes the histogram-equalized coordinates of the position dimensions among dims
+	std::vector<Timbre5DPoint> reshape(float histogramEqualization) const; // interpolates between the normalized and histogram-equalized positions
+    //=============================================================================================================================
+    // worker thread only
+    struct ViewCache {
+        // what columns[d] was extracted from
+        std::shared_ptr<const FeatureTable> source;
+        analysis::Statistic statistic {analysis::Statistic::NumStatistics};
+        std::array<std::optional<analysis::Feature_e>, numDimensions> columnFeatures {};
+
+        // column-major: one value per event
+        std::array<std::vector<float>, numDimensions> columns;
+        std::array<Range, numDimensions> ranges {};
+        std::array<std::vector<float>, numDimensions> normalized;
+        std::array<std::vector<float>, numPositionDimensions> equalized;    // mapped to [-1, 1]
+
+        size_t numEvents() const { return columns[0].size(); }
+    } _viewCache;
     //=============================================================================================================================
+    ViewRecomputeWorker _viewWorker;    // last, so that it stops before anything its jobs touch is destroyed
 };
 
 }	// namespace nvs::timbrespace
@@ -2,14 +2,22 @@
 // Created by Nicholas Solem on 1/12/26.
 //
 
+#include <algorithm>
+#include <iterator>
 #include <ranges>
 #include "TimbreSpacePointSelector.h"
 #include "TimbreSpaceTriangulation.h"
+#include "Analysis/Tracing.h"
 #include "dsp_util.h"
 #include "StringAxiom.h"
+#include "TsnStringAxiom.h"
 
 namespace nvs::timbrespace {
 
+namespace {
+constexpr size_t noVertex {delaunator::INVALID_INDEX};
+}
+
 TimbreSpacePointSelector::TimbreSpacePointSelector(juce::AudioProcessorValueTreeState &apvts, TimbreSpace &timbreSpace)
 :   _apvts(apvts)
 ,   _timbreSpace(timbreSpace)
@@ -19,6 +27,8 @@ TimbreSpacePointSelector::TimbreSpacePointSelector(juce::AudioProcessorValueTree
 
 }
 TimbreSpacePointSelector::~TimbreSpacePointSelector() {
+    _timbreSpace.getViewWorker().cancel(this);
+    cancelPendingUpdate();
     _apvts.state.removeListener(this);
     _timbreSpace.removeActionListener(this);
 }
@@ -28,41 +38,66 @@ void TimbreSpacePointSelector::valueTreePropertyChanged (ValueTree &alteredTree,
         const auto paramID = alteredTree["id"].toString();
         const float newValue = alteredTree["value"];
 
-        if (paramID == nvs::axiom::filtered_feature) {
-            updateRanksForFilteredFeature();
-            updateGlobalFilter();
-            return;
-        }
-        if ((paramID == nvs::axiom::filtered_feature_min) || (paramID == nvs::axiom::filtered_feature_max)) {
-            // ideally we should only update these when their slider is RELEASED, not as it drags!
+        if ((paramID == nvs::axiom::filtered_feature) || (paramID == nvs::axiom::filtered_feature_min) ||
+            (paramID == nvs::axiom::filtered_feature_max))
+        {
+            // while a slider drags, requests not yet started are replaced, so only its latest value gets rebuilt
             updateGlobalFilter();
             return;
         }
     }
+    if (alteredTree.hasType(nvs::axiom::ViewSettings) && property == juce::Identifier(nvs::axiom::duplicateTolerance)) {
+        updateGlobalFilter();
+    }
+}
+float TimbreSpacePointSelector::getDuplicateTolerance() const {
+    const auto viewSettings = _apvts.state.getChildWithName(nvs::axiom::ViewSettings);
+    return static_cast<float>(static_cast<double>(viewSettings.getProperty(nvs::axiom::duplicateTolerance, 0.0)));
 }
 
 void TimbreSpacePointSelector::actionListenerCallback(const String &message) {
-    if (message == axiom::timbreSpaceTreeChanged) {
-        _featurewiseRankIndices.clear();    // first time around for new dataset, we must clear its state
-        updateRanksForFilteredFeature();    // and then fill it in for the currently selected feature
-        reserveWrappedPoints();
-    }
+    // a new tree needs no handling of its own: its feature table invalidates the ranks, and its view follows
     if (message == axiom::shapedPointsAvailable) {
         updateGlobalFilter();
     }
 }
-
-void TimbreSpacePointSelector::reserveWrappedPoints() {
-    // reserves based on rank for filtered feature having been already set
-    _wrappedPoints.clear();
-    _wrappedPoints.reserve(_featurewiseRankIndices[_filteredFeature].size());
+void TimbreSpacePointSelector::handleAsyncUpdate() {
+    if (auto const &published = _wrappedPointsPublished.read();
+        published.data != nullptr)
+    {
+        _wrappedPoints = published.data;
+    }
 }
 
 void TimbreSpacePointSelector::updateGlobalFilter() {
-    const auto &rawPoints = _timbreSpace.getTimbreSpacePoints();
+    auto view = _timbreSpace.shareTimbreSpaceView();
+    auto features = _timbreSpace.shareFeatureTable();
+    if (view == nullptr || view->points.empty() || features == nullptr) {
+        return;
+    }
+    FilterRequest request {
+        .view = std::move(view),
+        .features = std::move(features),
+        .statistic = _timbreSpace.getStatistic(),
+        .filteredFeature = static_cast<nvs::analysis::Feature_e>(_apvts.getRawParameterValue(axiom::filtered_feature)->load()),
+        .minFrac = _apvts.getRawParameterValue(nvs::axiom::filtered_feature_min)->load(),
+        .maxFrac = _apvts.getRawParameterValue(nvs::axiom::filtered_feature_max)->load(),
+        .duplicateTolerance = getDuplicateTolerance()
+    };
+    _timbreSpace.getViewWorker().post(this, [this, request = std::move(request)](const analysis::ShouldExitFn &shouldExit) {
+        computeGlobalFilter(request, shouldExit);
+    });
+}
 
-    const float minFrac = _apvts.getRawParameterValue(nvs::axiom::filtered_feature_min)->load();
-    const float maxFrac = _apvts.getRawParameterValue(nvs::axiom::filtered_feature_max)->load();
+void TimbreSpacePointSelector::computeGlobalFilter(const FilterRequest &request, const analysis::ShouldExitFn &shouldExit) {
+    TSN_TRACE_SPAN("updateGlobalFilter");
+    const auto &rawPoints = request.view->points;
+    const auto &ranks = getRanks(request);
+    if (ranks.size() != rawPoints.size()) {
+        return;     // the points are of the previous tree; those of this one are on their way and will filter again
+    }
+    const float minFrac = request.minFrac;
+    const float maxFrac = request.maxFrac;
 
     typedef signed long long SLL;
 
@@ -77,85 +112,277 @@ void TimbreSpacePointSelector::updateGlobalFilter() {
         jassert (maxRank - minRank >= 3);
     }
 
-    _wrappedPoints.clear();
-    _wrappedPoints.reserve(rawPoints.size());
+    auto wrappedPoints = std::make_shared<std::vector<WrappedPoint5D>>();
+    wrappedPoints->reserve(rawPoints.size());
     for (size_t i = 0; i < rawPoints.size(); ++i) {
         const auto rawPoint = rawPoints[i];
-        const size_t rank = _featurewiseRankIndices[_filteredFeature][i];
+        const size_t rank = ranks[i];
         bool active = (rank >= minRank && rank < maxRank);
-        _wrappedPoints.push_back({rawPoint, active});
+        wrappedPoints->push_back({rawPoint, active});
+    }
+    _wrappedPointsPublished.publish(wrappedPoints);
+    triggerAsyncUpdate();
+    if (shouldExit()) {
+        return;
     }
 
+    std::vector<size_t> activeIndices;
+    for (size_t i = 0; i < wrappedPoints->size(); ++i) {
+        if ((*wrappedPoints)[i].active) {
+            activeIndices.push_back(i);
+        }
+    }
+    const auto &view = request.view->request;
+    if (_snapshotCache.source != view.features) {
+        _snapshotCache.entries.clear();     // a new analysis; nothing cached can come up again
+        _snapshotCache.source = view.features;
+    }
+    const SnapshotKey key {
+        .dimensionwiseFeatures = view.dimensionwiseFeatures,
+        .statistic = view.statistic,
+        .histogramEqualization = view.histogramEqualization,
+        .duplicateTolerance = request.duplicateTolerance,
+        .activeSetHash = hashIndices(activeIndices)
+    };
+    std::shared_ptr<const TriangulationSnapshot> snapshot;
+    if (const auto *cached = _snapshotCache.entries.find(key);
+        cached != nullptr && (*cached)->_activeIndices == activeIndices)
     {
-        auto snapshot = std::make_shared<TriangulationSnapshot>();
+        snapshot = *cached;     // this configuration was triangulated before; switching back to it costs nothing more
+    }
+    else {
+        auto built = std::make_shared<TriangulationSnapshot>();
+        built->_activeIndices = std::move(activeIndices);
 
     // rebuildActivePoints
-        auto &activeIndices = snapshot->_activeIndices;
-        for (size_t i = 0; i < _wrappedPoints.size(); ++i) {
-            if (_wrappedPoints[i].active) {
-                activeIndices.push_back(i);
-            }
+        std::vector<Timbre5DPoint> unclusteredPoints;
+        unclusteredPoints.reserve(built->_activeIndices.size());
+        for (const size_t idx : built->_activeIndices) {
+            unclusteredPoints.push_back((*wrappedPoints)[idx].point);
         }
-        auto &activePoints = snapshot->_activePoints;
-        // assumes we already have wrappedPoints and _activePointsPending built
-        for (const size_t idx : activeIndices) {
-            activePoints.push_back(_wrappedPoints[idx].point);
+        {
+            TSN_TRACE_SPAN("clusterNearDuplicates");
+            built->_clusters = clusterNearDuplicates(unclusteredPoints, request.duplicateTolerance);
         }
 
     // computeDelaunay
-        if (activePoints.empty()) {
+        if (built->_clusters.size() == 0) {
             DBG("TimbreSpacePointSelector::triangulatePoints timbres5D empty; returning\n");
             return;
         }
-        const auto coords2D = make2dCoordinates(activePoints);
+        TSN_TRACE_SPAN("triangulate");
         try {
-            snapshot->_delaunator = std::make_unique<delaunator::Delaunator>(coords2D);   // IF THIS FAILS, _pendingUpdate does not store `true`
+            if (!updateTriangulation(*built, request)) {
+                rebuildTriangulation(*built, request);   // IF THIS FAILS, _pendingUpdate does not store `true`
+            }
         }
         catch (std::exception &e) {
             DBG(e.what());
+            _delaunayBase = {};
             return;
         }
         catch (...) {
+            _delaunayBase = {};
             return;
         }
-        std::atomic_store_explicit(&_triangulationSnapshotPending, snapshot, std::memory_order_release); // memory_order_release indicating: done writing, publish it
+        _delaunayBase.snapshot = built;
+        _delaunayBase.view = request.view;
+        _delaunayBase.duplicateTolerance = request.duplicateTolerance;
+        const auto bytes = built->bytes();
+        snapshot = _snapshotCache.entries.insert(key, std::move(built), bytes);
+    }
+    if (shouldExit()) {
+        return;
     }
+    _triangulationSnapshots.publish(std::move(snapshot));
+}
+bool TimbreSpacePointSelector::updateTriangulation(TriangulationSnapshot &built, const FilterRequest &request) {
+    auto &base = _delaunayBase;
+    if (!_delaunay.isValid() || base.snapshot == nullptr || base.view != request.view
+        || base.duplicateTolerance != request.duplicateTolerance)
+    {
+        return false;   // the points have moved, or are clustered differently
+    }
+    const auto &previous = *base.snapshot;
+    const auto &activeIndices = built._activeIndices;
+    const auto &clusters = built._clusters;
+
+    // the events that entered and left the filter; both active sets are ascending
+    std::vector<size_t> entered, left;
+    std::ranges::set_difference(activeIndices, previous._activeIndices, std::back_inserter(entered));
+    std::ranges::set_difference(previous._activeIndices, activeIndices, std::back_inserter(left));
+    // past about an eighth of the points changing, local updates stop paying off against a fresh Delaunator
+    if (entered.size() + left.size() > activeIndices.size() / 8) {
+        return false;
+    }
+    std::vector<size_t> clusterOfPoint(activeIndices.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        for (const size_t m : clusters.members(c)) {
+            clusterOfPoint[m] = c;
+        }
+    }
+    const auto clusterOfEvent = [&](const size_t e) {
+        return clusterOfPoint[static_cast<size_t>(std::ranges::lower_bound(activeIndices, e) - activeIndices.begin())];
+    };
+    const auto previousMembers = [&previous](const size_t v) {
+        return previous._clusters.members(previous._clusterOfVertex[v]);
+    };
+    // a cluster is the active events of one cell of the tolerance grid, and the cells stay put from one filter to the
+    // next. so the vertices to replace are those of the cells that gained or lost events, found from either side;
+    // every other cluster keeps its members, its centroid and its vertex.
+    std::vector<size_t> touchedClusters, touchedVertices;
+    for (const size_t e : entered) {
+        touchedClusters.push_back(clusterOfEvent(e));
+    }
+    for (const size_t e : left) {
+        touchedVertices.push_back(base.vertexOfEvent[e]);
+    }
+    for (const size_t c : touchedClusters) {
+        for (const size_t m : clusters.members(c)) {
+            if (const size_t v = base.vertexOfEvent[activeIndices[m]]; v != noVertex) {
+                touchedVertices.push_back(v);
+            }
+        }
+    }
+    for (const size_t v : touchedVertices) {
+        for (const size_t m : previousMembers(v)) {
+            if (const size_t e = previous._activeIndices[m]; std::ranges::binary_search(activeIndices, e)) {
+                touchedClusters.push_back(clusterOfEvent(e));
+            }
+        }
+    }
+    for (auto *touched : {&touchedClusters, &touchedVertices}) {
+        std::ranges::sort(*touched);
+        touched->erase(std::unique(touched->begin(), touched->end()), touched->end());
+    }
+    std::vector<double> addedCoords;
+    addedCoords.reserve(2 * touchedClusters.size());
+    for (const size_t c : touchedClusters) {
+        addedCoords.push_back(clusters.centroids[c][0]);
+        addedCoords.push_back(clusters.centroids[c][1]);
+    }
+    const auto addedVertices = _delaunay.update(touchedVertices, addedCoords);
+    if (!addedVertices.has_value()) {
+        return false;
+    }
+
+    // patched from the previous snapshot: only what lies on the changed vertices and triangles is new
+    const auto &t = _delaunay.triangulation();
+    built._triangulation = std::make_unique<Triangulation>(t);
+    built._activePoints = previous._activePoints;
+    built._activePoints.resize(t.numVertices());
+    for (const size_t v : touchedVertices) {
+        for (const size_t m : previousMembers(v)) {
+            base.vertexOfEvent[previous._activeIndices[m]] = noVertex;
+        }
+    }
+    for (size_t i = 0; i < touchedClusters.size(); ++i) {
+        const size_t v = (*addedVertices)[i];
+        built._activePoints[v] = clusters.centroids[touchedClusters[i]];
+        for (const size_t m : clusters.members(touchedClusters[i])) {
+            base.vertexOfEvent[activeIndices[m]] = v;
+        }
+    }
+    built._clusterOfVertex.assign(t.numVertices(), noVertex);
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        built._clusterOfVertex[base.vertexOfEvent[activeIndices[clusters.members(c)[0]]]] = c;
+    }
+    built._triangleGrid = previous._triangleGrid;
+    built._triangleGrid.update(t, _delaunay.changedTriangles());
+    built._barycentric = previous._barycentric;
+    built._barycentric.update(t, _delaunay.changedTriangles());
+    built._hull = _delaunay.hullChanged() ? HullIndex(t) : previous._hull;
+    return true;
+}
+void TimbreSpacePointSelector::rebuildTriangulation(TriangulationSnapshot &built, const FilterRequest &request) {
+    const auto &clusters = built._clusters;
+    // renumbered along a Hilbert curve, so that the walk, and the grid and transforms below, touch neighboring vertices
+    // and triangles in neighboring memory. the updates that follow keep that numbering, give or take the points they
+    // change, until the next rebuild.
+    built._clusterOfVertex = _delaunay.rebuild(make2dCoordinates(clusters.centroids));
+    const auto &t = _delaunay.triangulation();
+    built._triangulation = std::make_unique<Triangulation>(t);
+    built._activePoints.clear();
+    built._activePoints.reserve(clusters.size());
+    auto &vertexOfEvent = _delaunayBase.vertexOfEvent;
+    vertexOfEvent.assign(request.view->points.size(), noVertex);
+    for (size_t v = 0; v < built._clusterOfVertex.size(); ++v) {
+        const size_t c = built._clusterOfVertex[v];
+        built._activePoints.push_back(clusters.centroids[c]);
+        for (const size_t m : clusters.members(c)) {
+            vertexOfEvent[built._activeIndices[m]] = v;
+        }
+    }
+    built._triangleGrid = TriangleGrid(t);
+    built._barycentric = BarycentricTransforms(t);
+    built._hull = HullIndex(t);
 }
 void TimbreSpacePointSelector::computeExistingPointsFromTarget(const Timbre5DPoint &target) {
     _target = target;
 
-    swapIfPending();
-    auto currentSnapshot = _triangulationSnapshotCurrent;
+    const auto *currentSnapshot = _triangulationSnapshots.read().data.get();
     if (currentSnapshot == nullptr) {
         return;
     }
-    if (currentSnapshot->_delaunator == nullptr) {
+    if (currentSnapshot->_triangulation == nullptr) {
         return;
     }
-    std::vector<WeightedIdx> weightedIndices =
+    auto weightedIndices =
         findPointsTriangulationBased(
             _target,
             currentSnapshot->_activePoints,
-            *currentSnapshot->_delaunator,
-            &_lastTriangleIndex
+            *currentSnapshot->_triangulation,
+            &_lastTriangleIndex,
+            &currentSnapshot->_triangleGrid,
+            &currentSnapshot->_barycentric,
+            &currentSnapshot->_hull
         );
-    jassert(weightedIndices.size() == 3);
-
     for (auto const &widx : weightedIndices) {
         jassert(0 <= widx.idx);
         jassert((widx.idx < currentSnapshot->_activePoints.size()));
     }
 
     for (size_t i = 0; i < weightedIndices.size(); ++i) {
-        jassert(weightedIndices[i].idx < currentSnapshot->_activeIndices.size());
+        const size_t cluster = currentSnapshot->_clusterOfVertex[weightedIndices[i].idx];
+        jassert(cluster < currentSnapshot->_clusters.size());
 
-        weightedIndices[i].idx = currentSnapshot->_activeIndices[weightedIndices[i].idx];
+        const auto members = currentSnapshot->_clusters.members(cluster);
+        const auto member = members.size() == 1 ? members[0] : members[_clusterMemberCycle++ % members.size()];
+        weightedIndices[i].idx = currentSnapshot->_activeIndices[member];
         _currentPointIndices[i] = weightedIndices[i];
     }
 }
 
 std::vector<WrappedPoint5D> const &TimbreSpacePointSelector::getTimbreSpacePoints() const {
-    return _wrappedPoints;
+    static const std::vector<WrappedPoint5D> none;
+    return _wrappedPoints != nullptr ? *_wrappedPoints : none;
+}
+
+size_t TimbreSpacePointSelector::TriangulationSnapshot::bytes() const {
+    return sizeof(TriangulationSnapshot)
+         + (_triangulation != nullptr ? sizeof(Triangulation) + _triangulation->bytes() : 0)
+         + _triangleGrid.bytes() + _barycentric.bytes() + _hull.bytes()
+         + _activePoints.capacity() * sizeof(Timbre5DPoint)
+         + (_clusterOfVertex.capacity() + _activeIndices.capacity()) * sizeof(size_t)
+         + _clusters.centroids.capacity() * sizeof(Timbre5DPoint)
+         + (_clusters.memberOffsets.capacity() + _clusters.memberIndices.capacity()) * sizeof(size_t);
+}
+
+size_t TimbreSpacePointSelector::hashIndices(const std::vector<size_t> &indices) {
+    size_t h = indices.size();
+    for (const size_t i : indices) {
+        h = h * 0x9E3779B97F4A7C15ull + i;
+    }
+    return h;
+}
+size_t TimbreSpacePointSelector::SnapshotKey::Hash::operator()(const SnapshotKey &k) const noexcept {
+    size_t h = k.activeSetHash;
+    for (const auto f : k.dimensionwiseFeatures) {
+        h = h * 0x9E3779B97F4A7C15ull + static_cast<size_t>(f);
+    }
+    h = h * 0x9E3779B97F4A7C15ull + static_cast<size_t>(k.statistic);
+    h = h * 0x9E3779B97F4A7C15ull + std::hash<float>{}(k.histogramEqualization);
+    return h * 0x9E3779B97F4A7C15ull + std::hash<float>{}(k.duplicateTolerance);
 }
 
 std::vector<size_t> computeRanks(const std::vector<float>& featureValues) {
@@ -173,23 +400,18 @@ std::vector<size_t> computeRanks(const std::vector<float>& featureValues) {
 
     return ranks;
 }
-void TimbreSpacePointSelector::updateRanksForFilteredFeature() {
-    _filteredFeature = static_cast<nvs::analysis::Feature_e>(_apvts.getRawParameterValue(axiom::filtered_feature)->load());
-    _filteredFeatureTargetRangeNormalized.first = _apvts.getRawParameterValue(axiom::filtered_feature_min)->load();
-    _filteredFeatureTargetRangeNormalized.second = _apvts.getRawParameterValue(axiom::filtered_feature_max)->load();
-
-    const auto vals = _timbreSpace.getRawFeatureValues(_filteredFeature);
-
-    _featurewiseRankIndices[_filteredFeature] = computeRanks(vals);
-}
-void TimbreSpacePointSelector::swapIfPending() {
-    auto pending = std::atomic_exchange_explicit(&_triangulationSnapshotPending,    // get value
-        std::shared_ptr<TriangulationSnapshot>(),                                 // AND clear pending slot (default ctor is nullptr)
-        std::memory_order_acq_rel);                                     // acq_rel: "acquire the new data" + "release the nullptr write"
-    if (pending)
-    {
-        _triangulationSnapshotCurrent = pending;
+const std::vector<size_t> &TimbreSpacePointSelector::getRanks(const FilterRequest &request) {
+    auto &cache = _rankCache;
+    if (cache.source != request.features || cache.statistic != request.statistic) {
+        cache.featurewiseRankIndices.clear();
+        cache.source = request.features;
+        cache.statistic = request.statistic;
+    }
+    auto [it, inserted] = cache.featurewiseRankIndices.try_emplace(request.filteredFeature);
+    if (inserted) {
+        it->second = computeRanks(request.features->getColumn(request.filteredFeature, request.statistic));
     }
+    return it->second;
 }
 
 
@@ -4,6 +4,11 @@
 
 #pragma once
 #include "TimbreSpace.h"
+#include "BarycentricTransforms.h"
+#include "HullIndex.h"
+#include "LruCache.h"
+#include "TriangleGrid.h"
+#include "Triangulation.h"
 #include "../../slicer_granular/Source/IndexTypes.h"
 
 namespace nvs::timbrespace {
@@ -12,11 +17,13 @@ typedef WrappedPoint<5> WrappedPoint5D;
 
 class TimbreSpacePointSelector final :   public juce::ActionListener
 ,                                        public juce::ValueTree::Listener
+,                                        private juce::AsyncUpdater
 {
 public:
     explicit TimbreSpacePointSelector (juce::AudioProcessorValueTreeState& apvts, TimbreSpace &timbreSpace);
     ~TimbreSpacePointSelector() override;
 
+    // message thread: the points of the latest finished filter, each marked whether it passed
     std::vector<WrappedPoint5D> const &getTimbreSpacePoints() const;
 
     void computeExistingPointsFromTarget(const Timbre5DPoint &target);
@@ -33,32 +40,84 @@ private:
     Timbre5DPoint _target {};
     size_t _lastTriangleIndex {0};
     std::vector<WeightedIdx> _currentPointIndices {{},{},{}};
+    size_t _clusterMemberCycle {0};     // rotates playback through the events a collapsed point stands for
 
-    std::vector<WrappedPoint5D> _wrappedPoints {};
+    std::shared_ptr<const std::vector<WrappedPoint5D>> _wrappedPoints;         // message thread
+    TripleBuffer<std::vector<WrappedPoint5D>> _wrappedPointsPublished;        // worker to message thread
 
+    // immutable once built, so that the cache below and the audio thread can share it
     struct TriangulationSnapshot {
-        std::unique_ptr<delaunator::Delaunator> _delaunator { nullptr };
-        std::vector<Timbre5DPoint> _activePoints {};
-        std::vector<size_t> _activeIndices {};
+        std::unique_ptr<Triangulation> _triangulation { nullptr };
+        TriangleGrid _triangleGrid {};                  // of _triangulation, to start locating the target from
+        BarycentricTransforms _barycentric {};          // of _triangulation's triangles, to weight the target with
+        HullIndex _hull {};                             // of _triangulation, to project targets outside it onto
+        std::vector<Timbre5DPoint> _activePoints {};    // of each vertex, the centroid of its cluster of near-duplicate active points
+        std::vector<size_t> _clusterOfVertex {};        // the _clusters index of each vertex; none for those removed
+        std::vector<size_t> _activeIndices {};          // event index of every active point
+        PointClusters _clusters {};                     // of _activeIndices
+
+        size_t bytes() const;   // approximately, as held by the cache
     };
-    std::shared_ptr<TriangulationSnapshot> _triangulationSnapshotCurrent;
-    std::shared_ptr<TriangulationSnapshot> _triangulationSnapshotPending;   // we want to use atomic<shared_ptr>, but not all compilers support it
-
-    void reserveWrappedPoints();
-    void rebuildActivePoints();
-
-    nvs::analysis::Feature_e _filteredFeature {nvs::analysis::Feature_e::SpectralFlatness};
-    void updateRanksForFilteredFeature();
-    typedef std::pair<float, float> Range;
-    Range _filteredFeatureTargetRangeNormalized {0.f, 1.f};
-    std::map<analysis::Feature_e, std::vector<size_t>> _featurewiseRankIndices {};
-    void updateGlobalFilter();
-
-    void computeDelaunay();
-
-    void swapIfPending();
+    // worker to audio thread. the audio thread must neither lock nor free memory to take up a new snapshot: it only
+    // reads the one in its slot, never holding a share of its own, so a snapshot it gives up is released by the worker
+    // on a later publish (see TripleBuffer)
+    TripleBuffer<TriangulationSnapshot> _triangulationSnapshots;
+
+    // worker thread only: the snapshots of the last few filter configurations, so that toggling between filter ranges
+    // or axis choices reuses their triangulations instead of rebuilding them. bounded by bytes as well as by count, so
+    // that large corpora, whose snapshots run to tens of megabytes, keep fewer of them.
+    struct SnapshotKey {
+        std::vector<analysis::Feature_e> dimensionwiseFeatures;     // of the view the points were shaped by
+        analysis::Statistic statistic;
+        float histogramEqualization;
+        float duplicateTolerance;
+        size_t activeSetHash;   // of the active indices; a hit is checked against the snapshot's own
+        bool operator==(const SnapshotKey &) const = default;
+        struct Hash { size_t operator()(const SnapshotKey &k) const noexcept; };
+    };
+    struct SnapshotCache {
+        std::shared_ptr<const FeatureTable> source;     // what every entry's points were computed from
+        static constexpr size_t maxBytes {64 * 1024 * 1024};
+        LruCache<SnapshotKey, std::shared_ptr<const TriangulationSnapshot>, 8, SnapshotKey::Hash> entries {maxBytes};
+    } _snapshotCache;
+    static size_t hashIndices(const std::vector<size_t> &indices);
+
+    // the filter runs on the timbre space's ViewRecomputeWorker, from a copy of everything it depends on; a burst of
+    // changes (e.g. dragging the filter range) costs one rebuild for its latest values
+    struct FilterRequest {
+        std::shared_ptr<const TimbreSpace::ShapedView> view;
+        std::shared_ptr<const FeatureTable> features;
+        analysis::Statistic statistic;
+        analysis::Feature_e filteredFeature;
+        float minFrac;
+        float maxFrac;
+        float duplicateTolerance;
+    };
+    void updateGlobalFilter();      // message thread: posts a FilterRequest for the current parameters
+    void computeGlobalFilter(const FilterRequest &request, const analysis::ShouldExitFn &shouldExit);    // worker
+    // worker thread only: carried from one filter to the next, so that moving the filter range a little only
+    // retriangulates around the points that entered or left it, and patches the snapshot built from it last
+    IncrementalDelaunay _delaunay;
+    struct DelaunayBase {
+        std::shared_ptr<const TriangulationSnapshot> snapshot;  // the last one built from _delaunay
+        std::shared_ptr<const TimbreSpace::ShapedView> view;    // whose points it triangulated
+        float duplicateTolerance {0.f};
+        std::vector<size_t> vertexOfEvent;                      // of each active event's cluster; none for the others
+    } _delaunayBase;
+    bool updateTriangulation(TriangulationSnapshot &built, const FilterRequest &request);
+    void rebuildTriangulation(TriangulationSnapshot &built, const FilterRequest &request);
+    float getDuplicateTolerance() const;
+
+    // worker thread only: ranks of every event by feature, for the table and statistic they were computed from
+    struct RankCache {
+        std::shared_ptr<const FeatureTable> source;
+        analysis::Statistic statistic {analysis::Statistic::NumStatistics};
+        std::map<analysis::Feature_e, std::vector<size_t>> featurewiseRankIndices {};
+    } _rankCache;
+    const std::vector<size_t> &getRanks(const FilterRequest &request);
 
     void actionListenerCallback(const String &message) override;
+    void handleAsyncUpdate() override;  // a filter finished on the worker
 };
 
 }   // namespace nvs::timbrespace
\ No newline at end of file
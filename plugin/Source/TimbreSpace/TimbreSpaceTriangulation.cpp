@@ -10,6 +10,8 @@
 
 #include "TimbreSpaceTriangulation.h"
 #include <set>
+#include <numeric>
+#include <unordered_map>
 #include <fmt/core.h>
 #include <cassert>
 #include "StringHelpers.h"
@@ -79,7 +81,7 @@ bool pointInTriangle(const Point2D& p, const Point2D& a, const Point2D& b, const
     return (u >= 0) && (v >= 0) && (u + v <= 1);
 }
 
-std::optional<std::array<size_t, 3>> findContainingTriangle(const delaunator::Delaunator& d,
+std::optional<std::array<size_t, 3>> findContainingTriangle(const Triangulation & d,
                                               const Point2D& target, const size_t startTriangle)
 {
 #if 1
@@ -306,10 +308,11 @@ std::array<double, 3> computeBarycentricWeights(const Point2D& p,
 */
 
 // triangulation-based point selection function
-std::vector<WeightedIdx> findPointsTriangulationBased(const Timbre5DPoint& target,
-    const std::vector<Timbre5DPoint>& database, const delaunator::Delaunator &d, size_t* startTriangle)
+std::array<WeightedIdx, 3> findPointsTriangulationBased(const Timbre5DPoint& target,
+    const std::vector<Timbre5DPoint>& database, const Triangulation &d, size_t* startTriangle,
+    const TriangleGrid *grid, const BarycentricTransforms *barycentric, const HullIndex *hull)
 {
-	if (database.empty()) { return {{},{},{}}; }
+	if (database.empty()) { return {}; }
     const auto dbSizeAtStart = database.size();
 
 	// Need at least 3 points for triangulation
@@ -318,18 +321,59 @@ std::vector<WeightedIdx> findPointsTriangulationBased(const Timbre5DPoint& targe
 	// Find triangle containing the target point
 	const Point2D targetPoint = get2D(target);
 
-    const size_t _startTri = startTriangle != nullptr ? *startTriangle : 0;
-    const auto triangleOpt = findContainingTriangle(d, targetPoint, _startTri);
-    if (startTriangle != nullptr && triangleOpt != std::nullopt) {
-        *startTriangle = triangleOpt.value()[0];
+    size_t _startTri = startTriangle != nullptr ? *startTriangle : 0;
+    if (grid != nullptr) {
+        _startTri = grid->triangleNear(targetPoint).value_or(_startTri);
     }
+    // walked once: whether it ends in a triangle around the target or at the hull, every case below goes on from here
+    const auto tri = straightWalk(d, targetPoint, _startTri);
+    if (tri.has_value() && startTriangle != nullptr) {
+        *startTriangle = *tri;
+    }
+    if (barycentric != nullptr) {
+        // the common case: the walk ends in a proper triangle around the target, whose weights are then a few
+        // multiply-adds. anything else (outside the hull, or on a degenerate triangle) takes the general path below.
+        if (tri.has_value() && barycentric->contains(*tri, targetPoint)) {
+            const auto weights = barycentric->weights(*tri, targetPoint);
+            std::array<WeightedIdx, 3> result;
+            for (size_t k = 0; k < 3; ++k) {
+                jassert (d.triangles[3 * *tri + k] < database.size());
+                result[k] = WeightedIdx(d.triangles[3 * *tri + k], weights[k]);
+            }
+            return result;
+        }
+    }
+    // as findContainingTriangle, on the walk already made
+    const auto triangleOpt = [&d, &tri, &targetPoint]() -> std::optional<std::array<size_t, 3>> {
+        if (!tri.has_value()) {
+            return std::nullopt;
+        }
+        const std::array<size_t, 3> vertices {d.triangles[3 * *tri], d.triangles[3 * *tri + 1], d.triangles[3 * *tri + 2]};
+        if (!pointInTriangle(targetPoint, getPointFromVertex(d, vertices[0]), getPointFromVertex(d, vertices[1]),
+                             getPointFromVertex(d, vertices[2])))
+        {
+            return std::nullopt;
+        }
+        return vertices;
+    }();
 
 	if (!triangleOpt.has_value()) {
 		// Target point is outside the convex hull
+		if (const auto projection = hull != nullptr ? hull->project(targetPoint) : std::nullopt;
+			projection.has_value())
+		{
+			if (startTriangle != nullptr) {
+				*startTriangle = projection->triangle;
+			}
+			std::array<WeightedIdx, 3> result;
+			for (size_t k = 0; k < 3; ++k) {
+				jassert (d.triangles[3 * projection->triangle + k] < database.size());
+				result[k] = WeightedIdx(d.triangles[3 * projection->triangle + k], projection->weights[k]);
+			}
+			return result;
+		}
 		// Fall back to distance-based method or handle as edge case
-		const auto result = findNearestTrianglePoints(target, database, d);
-	    jassert (result.size() == 3);
-	    return result;
+		return findNearestTrianglePoints(target, database, d);
 	}
 
 	// Get the triangle vertices
@@ -356,21 +400,13 @@ std::vector<WeightedIdx> findPointsTriangulationBased(const Timbre5DPoint& targe
         jassert (w >= 0.0);
     }
 
-	// Create result vector
-	std::vector<WeightedIdx> result;
-	result.reserve(3);
-	result.emplace_back(idx0, weights[0]);
-	result.emplace_back(idx1, weights[1]);
-	result.emplace_back(idx2, weights[2]);
-
-    jassert (result.size() == 3);
-	return result;
+	return {WeightedIdx(idx0, weights[0]), WeightedIdx(idx1, weights[1]), WeightedIdx(idx2, weights[2])};
 }
 
 // Helper function for when target is outside convex hull
-std::vector<WeightedIdx> findNearestTrianglePoints(const Timbre5DPoint& target,
+std::array<WeightedIdx, 3> findNearestTrianglePoints(const Timbre5DPoint& target,
 														 const std::vector<Timbre5DPoint>& database,
-														 const delaunator::Delaunator& d)
+														 const Triangulation & d)
 {
 	// Find the nearest edge or vertex of the convex hull
 	// This is a simplified approach - you might want to be more sophisticated
@@ -404,22 +440,69 @@ std::vector<WeightedIdx> findNearestTrianglePoints(const Timbre5DPoint& target,
 
     const auto weights = computeBarycentricWeights(targetPoint, bestPoints[0], bestPoints[1], bestPoints[2]);
 	// Use the closest triangle and project the point onto it
-	std::vector<WeightedIdx> result;
-	result.reserve(3);
-	result.emplace_back(bestTriangle[0], weights[0]);
-	result.emplace_back(bestTriangle[1], weights[1]);
-	result.emplace_back(bestTriangle[2], weights[2]);
-
-	return result;
+	return {WeightedIdx(bestTriangle[0], weights[0]), WeightedIdx(bestTriangle[1], weights[1]),
+	        WeightedIdx(bestTriangle[2], weights[2])};
 }
 
 
+//=============================================================================================================================
+PointClusters clusterNearDuplicates(const std::span<const Timbre5DPoint> points, const float tolerance) {
+	PointClusters clusters;
+	if (tolerance <= 0.f) {
+		clusters.centroids.assign(points.begin(), points.end());
+		clusters.memberIndices.resize(points.size());
+		std::iota(clusters.memberIndices.begin(), clusters.memberIndices.end(), 0);
+		clusters.memberOffsets.resize(points.size() + 1);
+		std::iota(clusters.memberOffsets.begin(), clusters.memberOffsets.end(), 0);
+		return clusters;
+	}
+	using Cell = std::array<int, 5>;
+	struct CellHash {
+		size_t operator()(const Cell &c) const noexcept {
+			size_t h = 0;
+			for (const int k : c) {
+				h = h * 0x9E3779B97F4A7C15ull + static_cast<size_t>(static_cast<unsigned int>(k));
+			}
+			return h;
+		}
+	};
+	std::unordered_map<Cell, size_t, CellHash> clusterOfCell;
+	clusterOfCell.reserve(points.size());
+	std::vector<size_t> clusterOfPoint(points.size());
+	std::vector<size_t> counts;
+	for (size_t i = 0; i < points.size(); ++i) {
+		Cell cell;
+		for (size_t d = 0; d < cell.size(); ++d) {
+			cell[d] = static_cast<int>(std::floor(points[i][static_cast<Eigen::Index>(d)] / tolerance));
+		}
+		const auto [it, inserted] = clusterOfCell.try_emplace(cell, clusters.centroids.size());
+		if (inserted) {
+			clusters.centroids.push_back(Timbre5DPoint::Zero());
+			counts.push_back(0);
+		}
+		clusterOfPoint[i] = it->second;
+		clusters.centroids[it->second] += points[i];
+		++counts[it->second];
+	}
+	// counting sort of the points by cluster
+	clusters.memberOffsets.assign(clusters.size() + 1, 0);
+	for (size_t c = 0; c < clusters.size(); ++c) {
+		clusters.centroids[c] /= static_cast<float>(counts[c]);
+		clusters.memberOffsets[c + 1] = clusters.memberOffsets[c] + counts[c];
+	}
+	clusters.memberIndices.resize(points.size());
+	std::vector<size_t> next(clusters.memberOffsets.begin(), clusters.memberOffsets.end() - 1);
+	for (size_t i = 0; i < points.size(); ++i) {
+		clusters.memberIndices[next[clusterOfPoint[i]]++] = i;
+	}
+	return clusters;
+}
 //=============================================================================================================================
 
 
 // Find the halfedge index in triangle that goes from vertex v1 to vertex v2
 // Returns SIZE_MAX if not found
-size_t findHalfedge(const delaunator::Delaunator& d, size_t triangleIdx, size_t v1, size_t v2) {
+size_t findHalfedge(const Triangulation & d, size_t triangleIdx, size_t v1, size_t v2) {
     size_t t0 = triangleIdx * 3;
 
     for (size_t i = 0; i < 3; ++i) {
@@ -434,7 +517,7 @@ size_t findHalfedge(const delaunator::Delaunator& d, size_t triangleIdx, size_t
 }
 
 // Check if two triangles are neighbors (share an edge)
-bool isNeighbor(const delaunator::Delaunator& d, size_t triangle1, size_t triangle2) {
+bool isNeighbor(const Triangulation & d, size_t triangle1, size_t triangle2) {
     size_t baseIdx = triangle1 * 3;
 
     // Check all three edges of triangle1
@@ -454,7 +537,7 @@ bool isNeighbor(const delaunator::Delaunator& d, size_t triangle1, size_t triang
 
 // Get the neighbor triangle across the edge from v1 to v2
 // Returns SIZE_MAX if no neighbor exists (hull edge) or edge not found
-size_t neighbor(const delaunator::Delaunator& d,
+size_t neighbor(const Triangulation & d,
                 size_t triangle, size_t v1, size_t v2)
 {
     size_t baseIdx = triangle * 3;
@@ -534,7 +617,7 @@ bool horizontalRayIntersectsEdge(const Point2D& A,
 
 // Check if point q is on the "other side" of edge e relative to triangle t
 // Edge e is defined by the halfedge index in the triangle
-bool pointOnOtherSide(const delaunator::Delaunator& d,
+bool pointOnOtherSide(const Triangulation & d,
                       size_t triangle,
                       size_t edgeIdx,  // 0, 1, or 2 for which edge of the triangle
                       const Point2D& q) {
@@ -565,7 +648,7 @@ bool pointOnOtherSide(const delaunator::Delaunator& d,
 
 // Get the third vertex of a triangle given two known vertices
 // Returns SIZE_MAX if v1 or v2 are not in the triangle
-size_t getThirdVertex(const delaunator::Delaunator& d, size_t triangleIdx, size_t v1, size_t v2) {
+size_t getThirdVertex(const Triangulation & d, size_t triangleIdx, size_t v1, size_t v2) {
     size_t t0 = triangleIdx * 3;
 
     std::array<size_t, 3> vertices = {
@@ -599,7 +682,7 @@ size_t getThirdVertex(const delaunator::Delaunator& d, size_t triangleIdx, size_
 
 // Get vertex index from point (assumes point exactly matches a vertex in coords)
 [[deprecated("uses linear search")]]
-size_t getVertexIndex(const delaunator::Delaunator& d, const Point2D& point) {
+size_t getVertexIndex(const Triangulation & d, const Point2D& point) {
     const float EPSILON = 1e-6f;
 
     for (size_t i = 0; i < d.coords.size() / 2; ++i) {
@@ -613,7 +696,7 @@ size_t getVertexIndex(const delaunator::Delaunator& d, const Point2D& point) {
     return SIZE_MAX;
 }
 
-Point2D getPointFromVertex(const delaunator::Delaunator& d, const size_t vertexIdx) {
+Point2D getPointFromVertex(const Triangulation & d, const size_t vertexIdx) {
     assert (vertexIdx < d.coords.size());
     return {
         static_cast<float>(d.coords[2 * vertexIdx + 0]),
@@ -621,7 +704,7 @@ Point2D getPointFromVertex(const delaunator::Delaunator& d, const size_t vertexI
     };
 }
 
-std::pair<size_t, size_t> getEdgeVertices(const delaunator::Delaunator& d,
+std::pair<size_t, size_t> getEdgeVertices(const Triangulation & d,
                                           size_t triangle,
                                           size_t edgeIdx) {
     size_t baseIdx = triangle * 3;
@@ -633,7 +716,7 @@ std::pair<size_t, size_t> getEdgeVertices(const delaunator::Delaunator& d,
 
     return {v1, v2};
 }
-size_t getOppositeVertex(const delaunator::Delaunator& d,
+size_t getOppositeVertex(const Triangulation & d,
                          size_t triangle,
                          size_t edgeIdx)
 {
@@ -644,7 +727,7 @@ size_t getOppositeVertex(const delaunator::Delaunator& d,
 class _Vertex {
     // just used for keeping invariants together, NOT a general purpose vertex class!
 public:
-    _Vertex(const delaunator::Delaunator &d, const char *label)
+    _Vertex(const Triangulation &d, const char *label)
     :   _d(d)
 
     , _label(label)
@@ -681,14 +764,14 @@ private:
     size_t _id {SIZE_MAX};
     size_t _count {0};
     Point2D _p;
-    const delaunator::Delaunator &_d;
+    const Triangulation &_d;
 
     const char *_label;
 
 };
 
 // Remembering stochastic walk - refines the triangle location
-std::optional<size_t> rememberingStochasticWalk(const delaunator::Delaunator& d,
+std::optional<size_t> rememberingStochasticWalk(const Triangulation & d,
                                                  const Point2D& p,
                                                  size_t startTri) {
 #ifndef WALK_STRING_DEBUGGING
@@ -784,11 +867,11 @@ std::optional<size_t> rememberingStochasticWalk(const delaunator::Delaunator& d,
     return std::nullopt;
 }
 
-size_t getVertexFromHalfedge(const delaunator::Delaunator& d, size_t halfedgeIdx) {
+size_t getVertexFromHalfedge(const Triangulation & d, size_t halfedgeIdx) {
     return d.triangles[halfedgeIdx];
 }
 
-std::optional<size_t> straightWalk(const delaunator::Delaunator &d, const Point2D &_p, size_t startTri) {
+std::optional<size_t> straightWalk(const Triangulation &d, const Point2D &_p, size_t startTri) {
     // traverses the triangulation T, following the line segment from q to p.
 
     printTriangles(d);
@@ -801,7 +884,7 @@ std::optional<size_t> straightWalk(const delaunator::Delaunator &d, const Point2
     _Vertex l(d, "l");
     _Vertex s(d, "s");
 
-    startTri = std::min(startTri, (d.triangles.size() / 3) - 3); // prevent lookup error int triangle points::create
+    startTri = std::min(startTri, (d.triangles.size() / 3) - 1); // prevent lookup error int triangle points::create
     const auto qrlOpt = TrianglePoints::create(d, startTri);
     if (qrlOpt == std::nullopt) {
         return std::nullopt;
@@ -877,7 +960,7 @@ std::optional<size_t> straightWalk(const delaunator::Delaunator &d, const Point2
     return t;
 }
 [[deprecated("not working, just use straight walk")]]
-std::optional<size_t> hybridWalk(const delaunator::Delaunator &d, const Point2D &_q, const size_t startTri_α)
+std::optional<size_t> hybridWalk(const Triangulation &d, const Point2D &_q, const size_t startTri_α)
 {
     printTriangles(d);
 
@@ -12,11 +12,15 @@
 
 #include <random>
 #include <ranges>
+#include <span>
 
-#include "../../delaunator-cpp/include/delaunator.hpp"
+#include "Triangulation.h"
 #include "../../slicer_granular/Source/IndexTypes.h"
 #include "TimbrePointTypes.h"
 #include "TrianglePoints.h"
+#include "TriangleGrid.h"
+#include "BarycentricTransforms.h"
+#include "HullIndex.h"
 
 namespace nvs::timbrespace {
 
@@ -24,8 +28,8 @@ std::vector<double> make2dCoordinates(const std::vector<Timbre5DPoint> &points);
 
 bool pointInTriangle(const Timbre2DPoint& p, const Timbre2DPoint& a, const Timbre2DPoint& b, const Timbre2DPoint& c) ;
 
-// Find triangle containing target point using Delaunator results
-std::optional<std::array<size_t, 3>> findContainingTriangle(const delaunator::Delaunator& d,
+// Find triangle containing target point in a Delaunay triangulation
+std::optional<std::array<size_t, 3>> findContainingTriangle(const Triangulation & d,
 															const Timbre2DPoint& target,
 															size_t startTriangle);
 
@@ -57,35 +61,57 @@ std::array<double, 3> computeBarycentricWeights(const Timbre2DPoint& p,
  }
 */
 
-// triangulation-based point selection function. startTriangle is an in/out parameter.
-std::vector<WeightedIdx> findPointsTriangulationBased(const Timbre5DPoint& target,
+// triangulation-based point selection function. startTriangle is an in/out parameter. given the triangulation's grid,
+// the walk starts from the triangle it has near the target instead; given its barycentric transforms, the weights
+// come from those; given its hull index, a target outside the hull is projected onto the nearest hull edge.
+// returns the three vertices of one triangle by value, so that the audio thread can query without allocating.
+std::array<WeightedIdx, 3> findPointsTriangulationBased(const Timbre5DPoint& target,
                                                     const std::vector<Timbre5DPoint>& database,
-                                                    const delaunator::Delaunator &d,
-                                                    size_t* startTriangle = nullptr);
-
-// Helper function for when target is outside convex hull
-std::vector<WeightedIdx> findNearestTrianglePoints(const Timbre5DPoint& target,
+                                                    const Triangulation &d,
+                                                    size_t* startTriangle = nullptr,
+                                                    const TriangleGrid *grid = nullptr,
+                                                    const BarycentricTransforms *barycentric = nullptr,
+                                                    const HullIndex *hull = nullptr);
+
+// Helper function for when target is outside convex hull, and there is no HullIndex. linear in the number of triangles
+std::array<WeightedIdx, 3> findNearestTrianglePoints(const Timbre5DPoint& target,
 												 const std::vector<Timbre5DPoint>& database,
-												 const delaunator::Delaunator& d);
+												 const Triangulation & d);
+
+//=============================================================================================================================
+// near-duplicate collapsing: points sharing a cell of a grid with side `tolerance` (in all 5 dimensions) form one
+// cluster, so that dense corpora triangulate as far fewer, better-shaped triangles.
+struct PointClusters {
+	std::vector<Timbre5DPoint> centroids;	// one per cluster, in order of each cluster's first point
+	std::vector<size_t> memberOffsets;		// members of cluster c: memberIndices[memberOffsets[c] .. memberOffsets[c+1])
+	std::vector<size_t> memberIndices;		// into the clustered points
+
+	size_t size() const { return centroids.size(); }
+	std::span<const size_t> members(const size_t c) const {
+		return std::span(memberIndices).subspan(memberOffsets[c], memberOffsets[c + 1] - memberOffsets[c]);
+	}
+};
+// tolerance <= 0 leaves every point in a cluster of its own
+PointClusters clusterNearDuplicates(std::span<const Timbre5DPoint> points, float tolerance);
 
 //=============================================================================================================================
 
-size_t findHalfedge(const delaunator::Delaunator& d, size_t triangleIdx, size_t v1, size_t v2);
-size_t getThirdVertex(const delaunator::Delaunator& d, size_t triangleIdx, size_t v1, size_t v2);
+size_t findHalfedge(const Triangulation & d, size_t triangleIdx, size_t v1, size_t v2);
+size_t getThirdVertex(const Triangulation & d, size_t triangleIdx, size_t v1, size_t v2);
 
 [[deprecated("uses linear search")]]
-size_t getVertexIndex(const delaunator::Delaunator& d, const Timbre2DPoint& point);
-size_t getVertexFromHalfedge(const delaunator::Delaunator& d, size_t halfedgeIdx);
-Timbre2DPoint getPointFromVertex(const delaunator::Delaunator& d, size_t vertexIdx);
-std::pair<size_t, size_t> getEdgeVertices(const delaunator::Delaunator& d,
+size_t getVertexIndex(const Triangulation & d, const Timbre2DPoint& point);
+size_t getVertexFromHalfedge(const Triangulation & d, size_t halfedgeIdx);
+Timbre2DPoint getPointFromVertex(const Triangulation & d, size_t vertexIdx);
+std::pair<size_t, size_t> getEdgeVertices(const Triangulation & d,
                                           size_t triangle,
                                           size_t edgeIdx);
-size_t getOppositeVertex(const delaunator::Delaunator& d,
+size_t getOppositeVertex(const Triangulation & d,
                          size_t triangle,
                          size_t edgeIdx);   // gets the vertex NOT belonging to the given edge
-size_t neighbor(const delaunator::Delaunator& d,size_t triangle, size_t v1, size_t v2);
-bool isNeighbor(const delaunator::Delaunator& d, size_t triangle1, size_t triangle2);
-bool pointOnOtherSide(const delaunator::Delaunator& d,
+size_t neighbor(const Triangulation & d,size_t triangle, size_t v1, size_t v2);
+bool isNeighbor(const Triangulation & d, size_t triangle1, size_t triangle2);
+bool pointOnOtherSide(const Triangulation & d,
                       size_t triangle,
                       size_t edgeIdx,  // 0, 1, or 2 for which edge of the triangle
                       const Timbre2DPoint& q);
@@ -93,15 +119,15 @@ float cross(const Timbre2DPoint &A, const Timbre2DPoint &B);
 float orientation(const Timbre2DPoint &A, const Timbre2DPoint &B, const Timbre2DPoint &C);
 float orientation(const TrianglePoints &points);
 
-std::optional<size_t> rememberingStochasticWalk(const delaunator::Delaunator& d,
+std::optional<size_t> rememberingStochasticWalk(const Triangulation & d,
                                              const Timbre2DPoint& q,
                                              size_t startTri);
-std::optional<size_t> straightWalk(const delaunator::Delaunator &d, const Timbre2DPoint &_p, size_t startTri);
-std::optional<size_t> hybridWalk(const delaunator::Delaunator &d, const Timbre2DPoint &q, size_t startTri_α);
+std::optional<size_t> straightWalk(const Triangulation &d, const Timbre2DPoint &_p, size_t startTri);
+std::optional<size_t> hybridWalk(const Triangulation &d, const Timbre2DPoint &q, size_t startTri_α);
 
 // TODO: use the following function to check if the point is even inside a triangle by checking it against the convex hull
 // TODO: and test it!
-inline bool pointInConvexHull(const delaunator::Delaunator& d,
+inline bool pointInConvexHull(const Triangulation & d,
                        const Timbre2DPoint& q)
 {
     const auto start = d.hull_start;
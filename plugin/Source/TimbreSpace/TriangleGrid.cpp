@@ -0,0 +1,76 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "TriangleGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nvs::timbrespace {
+
+int TriangleGrid::cellOf(const double coordinate) {
+    const auto cell = static_cast<int>(std::floor((coordinate + 1.0) * 0.5 * resolution));
+    return std::clamp(cell, 0, resolution - 1);
+}
+double TriangleGrid::cellCenter(const int cell) {
+    return (cell + 0.5) * 2.0 / resolution - 1.0;
+}
+
+TriangleGrid::TriangleGrid(const Triangulation &t)
+:   _cells(static_cast<size_t>(resolution) * resolution, noTriangle)
+,   _numTriangles(static_cast<std::uint32_t>(t.numTriangles()))
+{
+    for (size_t tri = 0; tri < t.numTriangles(); ++tri) {
+        rasterize(t, tri);
+    }
+}
+void TriangleGrid::update(const Triangulation &t, const std::span<const size_t> changedTriangles) {
+    if (_cells.empty()) {
+        *this = TriangleGrid(t);
+        return;
+    }
+    _numTriangles = static_cast<std::uint32_t>(t.numTriangles());
+    for (const auto tri : changedTriangles) {
+        rasterize(t, tri);
+    }
+}
+void TriangleGrid::rasterize(const Triangulation &t, const size_t tri) {
+    const auto &c = t.coords;
+    const size_t a = t.triangles[3 * tri], b = t.triangles[3 * tri + 1], v = t.triangles[3 * tri + 2];
+    const double ax = c[2 * a], ay = c[2 * a + 1];
+    const double bx = c[2 * b], by = c[2 * b + 1];
+    const double vx = c[2 * v], vy = c[2 * v + 1];
+    // the edge functions of a clockwise triangle are all <= 0 inside it
+    const auto edge = [](const double x0, const double y0, const double x1, const double y1, const double x, const double y) {
+        return (x1 - x0) * (y - y0) - (y1 - y0) * (x - x0);
+    };
+    const int xBegin = cellOf(std::min({ax, bx, vx})), xEnd = cellOf(std::max({ax, bx, vx}));
+    const int yBegin = cellOf(std::min({ay, by, vy})), yEnd = cellOf(std::max({ay, by, vy}));
+    for (int cy = yBegin; cy <= yEnd; ++cy) {
+        const double y = cellCenter(cy);
+        for (int cx = xBegin; cx <= xEnd; ++cx) {
+            const double x = cellCenter(cx);
+            auto &cell = _cells[static_cast<size_t>(cy) * resolution + cx];
+            const bool containsCenter = edge(ax, ay, bx, by, x, y) <= 0.0
+                                     && edge(bx, by, vx, vy, x, y) <= 0.0
+                                     && edge(vx, vy, ax, ay, x, y) <= 0.0;
+            // a cell whose center lies outside every triangle (at the hull) keeps any triangle near it
+            if (containsCenter || cell >= _numTriangles) {
+                cell = static_cast<std::uint32_t>(tri);
+            }
+        }
+    }
+}
+
+std::optional<size_t> TriangleGrid::triangleNear(const Timbre2DPoint &p) const {
+    if (_cells.empty()) {
+        return std::nullopt;
+    }
+    const auto cell = _cells[static_cast<size_t>(cellOf(p.y())) * resolution + cellOf(p.x())];
+    if (cell >= _numTriangles) {    // including noTriangle
+        return std::nullopt;
+    }
+    return cell;
+}
+
+}   // namespace nvs::timbrespace
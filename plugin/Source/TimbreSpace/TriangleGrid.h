@@ -0,0 +1,48 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "TimbrePointTypes.h"
+#include "Triangulation.h"
+
+namespace nvs::timbrespace {
+
+/**
+ * A fixed resolution grid over [-1, 1]², remembering for each cell a triangle that touches it: the one containing the
+ * cell's center, where there is one. Starting a walk there instead of at the last triangle found makes locating a
+ * point a step or two of walking, however far it jumped and however many triangles there are.
+ *
+ * Built on the thread that triangulates, once per triangulation or patched after an IncrementalDelaunay update;
+ * read-only afterwards.
+ */
+class TriangleGrid
+{
+public:
+    static constexpr int resolution {256};
+
+    TriangleGrid() = default;
+    explicit TriangleGrid(const Triangulation &t);
+    // for a grid built over an earlier state of t: draws in the triangles that have changed since. a cell whose
+    // triangle has changed, but lies in none of these, keeps it; any triangle is as good a start to walk from.
+    void update(const Triangulation &t, std::span<const size_t> changedTriangles);
+
+    // a triangle touching the cell of p (clamped to the grid), or nullopt if no triangle touches it
+    std::optional<size_t> triangleNear(const Timbre2DPoint &p) const;
+    bool empty() const { return _cells.empty(); }
+    size_t bytes() const { return _cells.capacity() * sizeof(std::uint32_t); }
+private:
+    static constexpr std::uint32_t noTriangle {UINT32_MAX};
+    static int cellOf(double coordinate);
+    static double cellCenter(int cell);
+    void rasterize(const Triangulation &t, size_t tri);
+
+    std::vector<std::uint32_t> _cells;  // row-major, y then x
+    std::uint32_t _numTriangles {0};    // cells naming a triangle past these name none
+};
+
+}   // namespace nvs::timbrespace
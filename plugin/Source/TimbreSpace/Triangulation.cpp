@@ -0,0 +1,722 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "Triangulation.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+
+namespace nvs::timbrespace {
+
+Triangulation::Triangulation(const delaunator::Delaunator &d)
+:   coords(d.coords.begin(), d.coords.end())
+,   triangles(d.triangles)
+,   halfedges(d.halfedges)
+,   hull_prev(numVertices(), delaunator::INVALID_INDEX)
+,   hull_next(numVertices(), delaunator::INVALID_INDEX)
+,   hull_start(d.hull_start)
+{
+    // Delaunator leaves stale entries in hull_next/hull_prev for vertices that dropped off the hull while it was built
+    if (hull_start == delaunator::INVALID_INDEX) {
+        return;
+    }
+    size_t v = hull_start;
+    do {
+        const auto next = d.hull_next[v];
+        hull_next[v] = next;
+        hull_prev[next] = v;
+        v = next;
+    } while (v != hull_start);
+}
+
+namespace {
+// the position of (x, y), in cells of a 2^16 x 2^16 grid, along the Hilbert curve through it
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        const uint32_t rx = (x & s) > 0;
+        const uint32_t ry = (y & s) > 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {     // rotate the quadrant, so that the curve enters and leaves it where its neighbors meet it
+            if (rx == 1) {
+                x = s - 1 - (x & (s - 1));
+                y = s - 1 - (y & (s - 1));
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+// the order of keys, as a permutation: order[new] = old
+std::vector<size_t> sortedOrder(const std::vector<uint64_t> &keys) {
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [&keys](const size_t a, const size_t b) { return keys[a] < keys[b]; });
+    return order;
+}
+}
+
+std::vector<size_t> Triangulation::renumberAlongHilbertCurve() {
+    const size_t n = numVertices();
+    if (n == 0) {
+        return {};
+    }
+    double minX = coords[0], maxX = coords[0], minY = coords[1], maxY = coords[1];
+    for (size_t v = 1; v < n; ++v) {
+        minX = std::min(minX, coords[2 * v]);
+        maxX = std::max(maxX, coords[2 * v]);
+        minY = std::min(minY, coords[2 * v + 1]);
+        maxY = std::max(maxY, coords[2 * v + 1]);
+    }
+    constexpr double cells {65535.0};
+    const double scaleX = maxX > minX ? cells / (maxX - minX) : 0.0;
+    const double scaleY = maxY > minY ? cells / (maxY - minY) : 0.0;
+    const auto key = [&](const double x, const double y) {
+        return hilbertIndex(static_cast<uint32_t>((x - minX) * scaleX), static_cast<uint32_t>((y - minY) * scaleY));
+    };
+
+    std::vector<uint64_t> vertexKeys(n);
+    for (size_t v = 0; v < n; ++v) {
+        vertexKeys[v] = key(coords[2 * v], coords[2 * v + 1]);
+    }
+    const auto vertexOrder = sortedOrder(vertexKeys);
+    std::vector<size_t> newVertex(n);
+    for (size_t v = 0; v < n; ++v) {
+        newVertex[vertexOrder[v]] = v;
+    }
+
+    const size_t m = numTriangles();
+    std::vector<uint64_t> triangleKeys(m);
+    for (size_t t = 0; t < m; ++t) {
+        double x = 0.0, y = 0.0;
+        for (size_t k = 0; k < 3; ++k) {
+            x += coords[2 * triangles[3 * t + k]];
+            y += coords[2 * triangles[3 * t + k] + 1];
+        }
+        triangleKeys[t] = key(x / 3.0, y / 3.0);
+    }
+    const auto triangleOrder = sortedOrder(triangleKeys);
+    std::vector<size_t> newTriangle(m);
+    for (size_t t = 0; t < m; ++t) {
+        newTriangle[triangleOrder[t]] = t;
+    }
+    const auto newHalfedge = [&newTriangle](const size_t e) {
+        return e == delaunator::INVALID_INDEX ? e : 3 * newTriangle[e / 3] + e % 3;
+    };
+    const auto renumberVertex = [&newVertex](const size_t v) {
+        return v == delaunator::INVALID_INDEX ? v : newVertex[v];
+    };
+
+    Triangulation renumbered;
+    renumbered.coords.resize(coords.size());
+    renumbered.hull_prev.resize(n);
+    renumbered.hull_next.resize(n);
+    for (size_t v = 0; v < n; ++v) {
+        const size_t old = vertexOrder[v];
+        renumbered.coords[2 * v] = coords[2 * old];
+        renumbered.coords[2 * v + 1] = coords[2 * old + 1];
+        renumbered.hull_prev[v] = renumberVertex(hull_prev[old]);
+        renumbered.hull_next[v] = renumberVertex(hull_next[old]);
+    }
+    renumbered.hull_start = renumberVertex(hull_start);
+    renumbered.triangles.resize(triangles.size());
+    renumbered.halfedges.resize(halfedges.size());
+    for (size_t t = 0; t < m; ++t) {
+        const size_t old = triangleOrder[t];
+        for (size_t k = 0; k < 3; ++k) {     // each triangle keeps its rotation, so halfedge k stays its edge k
+            renumbered.triangles[3 * t + k] = newVertex[triangles[3 * old + k]];
+            renumbered.halfedges[3 * t + k] = newHalfedge(halfedges[3 * old + k]);
+        }
+    }
+    *this = std::move(renumbered);
+    return vertexOrder;
+}
+
+//=============================================================================================================================
+namespace {
+double orient2d(const double ax, const double ay, const double bx, const double by, const double cx, const double cy) {
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);   // > 0 if a, b, c turn counterclockwise
+}
+double inCircle2d(const double ax, const double ay, const double bx, const double by, const double cx, const double cy,
+                  const double px, const double py)
+{
+    // > 0 if p is inside the circumcircle of the counterclockwise a, b, c
+    const double adx = ax - px, ady = ay - py;
+    const double bdx = bx - px, bdy = by - py;
+    const double cdx = cx - px, cdy = cy - py;
+    return (adx * adx + ady * ady) * (bdx * cdy - bdy * cdx)
+         - (bdx * bdx + bdy * bdy) * (adx * cdy - ady * cdx)
+         + (cdx * cdx + cdy * cdy) * (adx * bdy - ady * bdx);
+}
+}
+
+double IncrementalDelaunay::orient(const size_t a, const size_t b, const size_t c) const {
+    return orient(a, b, _vertices[c].x, _vertices[c].y);
+}
+double IncrementalDelaunay::orient(const size_t a, const size_t b, const double x, const double y) const {
+    const auto &A = _vertices[a];
+    const auto &B = _vertices[b];
+    return orient2d(A.x, A.y, B.x, B.y, x, y);
+}
+double IncrementalDelaunay::inCircle(const size_t a, const size_t b, const size_t c, const double x, const double y) const {
+    const auto &A = _vertices[a];
+    const auto &B = _vertices[b];
+    const auto &C = _vertices[c];
+    return inCircle2d(A.x, A.y, B.x, B.y, C.x, C.y, x, y);
+}
+
+bool IncrementalDelaunay::inConflict(const Tri &t, const double x, const double y) const {
+    if (!t.isGhost()) {
+        return inCircle(t.v[0], t.v[1], t.v[2], x, y) > 0.0;
+    }
+    // a ghost's circumcircle degenerates to the open half plane beyond its hull edge s->e (on the edge's left)
+    const auto j = static_cast<size_t>(std::ranges::find(t.v, infinite) - t.v.begin());
+    const auto s = t.v[(j + 1) % 3];
+    const auto e = t.v[(j + 2) % 3];
+    if (const auto o = orient(s, e, x, y); o != 0.0) {
+        return o > 0.0;
+    }
+    // plus the open edge itself, so that a point landing on the hull splits it
+    const auto &S = _vertices[s];
+    const auto &E = _vertices[e];
+    const double along = (x - S.x) * (E.x - S.x) + (y - S.y) * (E.y - S.y);
+    return along > 0.0 && along < (E.x - S.x) * (E.x - S.x) + (E.y - S.y) * (E.y - S.y);
+}
+
+//=============================================================================================================================
+size_t IncrementalDelaunay::addVertex(const double x, const double y) {
+    size_t id;
+    if (!_freeVertices.empty()) {
+        id = _freeVertices.back();
+        _freeVertices.pop_back();
+        _vertices[id] = {x, y};
+    } else {
+        id = _vertices.size();
+        _vertices.push_back({x, y});
+    }
+    _verticesAt.emplace(std::make_pair(x, y), id);
+    return id;
+}
+size_t IncrementalDelaunay::newTri(const std::array<size_t, 3> &v, const std::array<size_t, 3> &n) {
+    size_t t;
+    if (!_freeTris.empty()) {
+        t = _freeTris.back();
+        _freeTris.pop_back();
+        _tris[t] = {v, n};
+    } else {
+        t = _tris.size();
+        _tris.push_back({v, n});
+    }
+    if (!_tris[t].isGhost()) {
+        ++_numRealTris;
+        if (!_freeNumbers.empty()) {
+            _tris[t].number = _freeNumbers.back();
+            _freeNumbers.pop_back();
+            _trisByNumber[_tris[t].number] = t;
+        } else {
+            _tris[t].number = _trisByNumber.size();
+            _trisByNumber.push_back(t);
+        }
+    } else {
+        _ghost = t;
+    }
+    markChanged(t);
+    for (const auto u : v) {
+        if (u != infinite) {
+            _vertices[u].tri = t;
+        }
+    }
+    return t;
+}
+void IncrementalDelaunay::freeTri(const size_t t) {
+    if (!_tris[t].isGhost()) {
+        --_numRealTris;
+        _trisByNumber[_tris[t].number] = none;
+        _freeNumbers.push_back(_tris[t].number);
+    } else {
+        _hullChanged = true;
+    }
+    _tris[t].live = false;
+    _freeTris.push_back(t);
+}
+void IncrementalDelaunay::markChanged(const size_t t) {
+    if (_tris[t].isGhost()) {
+        _hullChanged = true;
+    } else {
+        _changed.push_back(_tris[t].number);
+    }
+}
+void IncrementalDelaunay::relink(const size_t t, const size_t a, const size_t b, const size_t neighbor) {
+    auto &tri = _tris[t];
+    for (size_t i = 0; i < 3; ++i) {
+        if (tri.v[i] == b && tri.v[(i + 1) % 3] == a) {
+            tri.n[i] = neighbor;
+            markChanged(t);
+            return;
+        }
+    }
+    assert(false && "no such edge");
+}
+
+//=============================================================================================================================
+std::vector<size_t> IncrementalDelaunay::rebuild(const std::vector<double> &coords) {
+    _valid = false;     // until Delaunator is through
+    Triangulation t {delaunator::Delaunator(coords)};
+    auto pointOfVertex = t.renumberAlongHilbertCurve();
+    assign(t);
+    return pointOfVertex;
+}
+
+void IncrementalDelaunay::assign(const Triangulation &t) {
+    _tris.clear();
+    _freeTris.clear();
+    _vertices.clear();
+    _freeVertices.clear();
+    _verticesAt.clear();
+    _numRealTris = 0;
+    _hint = none;
+    _valid = false;
+    _trisByNumber.clear();
+    _freeNumbers.clear();
+    _ghost = none;
+    _exported = t;
+
+    for (size_t i = 0; i < t.numVertices(); ++i) {
+        addVertex(t.coords[2 * i], t.coords[2 * i + 1]);
+    }
+    if (t.triangles.empty()) {
+        return;
+    }
+    // its clockwise (a, b, c) is our counterclockwise (a, c, b), so its edge k is our edge 2 - k, reversed
+    _tris.reserve(t.numTriangles() * 2);
+    for (size_t j = 0; j < t.numTriangles(); ++j) {
+        std::array<size_t, 3> n {none, none, none};
+        for (size_t k = 0; k < 3; ++k) {
+            if (const auto twin = t.halfedges[3 * j + k]; twin != delaunator::INVALID_INDEX) {
+                n[2 - k] = twin / 3;
+            }
+        }
+        newTri({t.triangles[3 * j], t.triangles[3 * j + 2], t.triangles[3 * j + 1]}, n);
+    }
+    // a ghost (y, x, infinite) beyond each hull edge x->y; around the hull, each ghost meets the next at its second vertex
+    std::unordered_map<size_t, size_t> ghostFrom;
+    const auto numReal = _tris.size();
+    for (size_t j = 0; j < numReal; ++j) {
+        for (size_t i = 0; i < 3; ++i) {
+            if (_tris[j].n[i] != none) {
+                continue;
+            }
+            const auto x = _tris[j].v[i];
+            const auto y = _tris[j].v[(i + 1) % 3];
+            const auto g = newTri({y, x, infinite}, {j, none, none});
+            _tris[j].n[i] = g;
+            ghostFrom[y] = g;
+        }
+    }
+    for (size_t g = numReal; g < _tris.size(); ++g) {
+        const auto next = ghostFrom.at(_tris[g].v[1]);
+        _tris[g].n[1] = next;
+        _tris[next].n[2] = g;
+    }
+    // the triangles were made in t's order, so they have its numbers
+    _changed.clear();
+    _hullChanged = false;
+    _hint = 0;
+    _valid = true;
+}
+
+//=============================================================================================================================
+size_t IncrementalDelaunay::locate(const double x, const double y) const {
+    size_t t = _hint;
+    if (t >= _tris.size() || !_tris[t].live || _tris[t].isGhost()) {
+        const auto it = std::ranges::find_if(_tris, [](const Tri &tri) { return tri.live && !tri.isGhost(); });
+        if (it == _tris.end()) {
+            return none;
+        }
+        t = static_cast<size_t>(it - _tris.begin());
+    }
+    // visibility walk: step across any edge that has (x, y) beyond it, until none does, or the hull is crossed
+    for (size_t step = 0; step < _tris.size(); ++step) {
+        const auto &tri = _tris[t];
+        bool stepped = false;
+        for (size_t k = 0; k < 3; ++k) {
+            const auto i = (step + k) % 3;  // varying the first edge tried keeps the walk from cycling
+            if (orient(tri.v[i], tri.v[(i + 1) % 3], x, y) < 0.0) {
+                t = tri.n[i];
+                stepped = true;
+                break;
+            }
+        }
+        if (!stepped || _tris[t].isGhost()) {
+            return t;
+        }
+    }
+    // lost (which should not happen in a Delaunay triangulation); fall back to looking everywhere
+    for (t = 0; t < _tris.size(); ++t) {
+        if (_tris[t].live && inConflict(_tris[t], x, y)) {
+            return t;
+        }
+    }
+    return none;
+}
+
+bool IncrementalDelaunay::insert(const size_t p) {
+    const double x = _vertices[p].x;
+    const double y = _vertices[p].y;
+    // a duplicate of a vertex already in the triangulation stays out of it, as in Delaunator
+    for (auto [it, end] = _verticesAt.equal_range({x, y}); it != end; ++it) {
+        if (it->second != p && _vertices[it->second].tri != none) {
+            return true;
+        }
+    }
+    const auto seed = locate(x, y);
+    if (seed == none) {
+        return false;
+    }
+    // the cavity: the triangles whose circumcircles contain p, grown from the one p is in (or beyond)
+    std::vector<size_t> cavity {seed};
+    const auto inCavity = [&cavity](const size_t t) { return std::ranges::find(cavity, t) != cavity.end(); };
+    for (size_t c = 0; c < cavity.size(); ++c) {
+        for (const auto nb : _tris[cavity[c]].n) {
+            if (!inCavity(nb) && inConflict(_tris[nb], x, y)) {
+                cavity.push_back(nb);
+            }
+        }
+    }
+    // its boundary, counterclockwise around p, to be fanned into triangles (a, b, p). before touching anything, make
+    // sure the fan will not fold over: p must see every boundary edge from inside, and every vertex of the cavity
+    // must start exactly one boundary edge (or the rounding in the predicates has left the cavity other than a disk)
+    struct BoundaryEdge {
+        size_t a, b, outside;
+    };
+    std::vector<BoundaryEdge> boundary;
+    for (const auto c : cavity) {
+        const auto &tri = _tris[c];
+        for (size_t i = 0; i < 3; ++i) {
+            if (inCavity(tri.n[i])) {
+                continue;
+            }
+            const auto a = tri.v[i];
+            const auto b = tri.v[(i + 1) % 3];
+            if (a != infinite && b != infinite && orient(a, b, x, y) <= 0.0) {
+                return false;
+            }
+            boundary.push_back({a, b, tri.n[i]});
+        }
+    }
+    std::ranges::sort(boundary, {}, &BoundaryEdge::a);
+    if (std::ranges::adjacent_find(boundary, {}, &BoundaryEdge::a) != boundary.end()) {
+        return false;
+    }
+    const auto boundaryFrom = [&boundary](const size_t a) -> size_t {
+        const auto it = std::ranges::lower_bound(boundary, a, {}, &BoundaryEdge::a);
+        return (it != boundary.end() && it->a == a) ? static_cast<size_t>(it - boundary.begin()) : none;
+    };
+    for (const auto c : cavity) {
+        for (const auto u : _tris[c].v) {
+            if (boundaryFrom(u) == none) {
+                return false;
+            }
+        }
+    }
+
+    for (const auto c : cavity) {
+        freeTri(c);
+    }
+    std::vector<size_t> fan(boundary.size());
+    for (size_t k = 0; k < boundary.size(); ++k) {
+        const auto &e = boundary[k];
+        fan[k] = newTri({e.a, e.b, p}, {e.outside, none, none});
+        relink(e.outside, e.a, e.b, fan[k]);
+    }
+    // around p, the triangle on edge a->b continues into the one on edge b->c
+    for (size_t k = 0; k < boundary.size(); ++k) {
+        const auto next = fan[boundaryFrom(boundary[k].b)];
+        _tris[fan[k]].n[1] = next;
+        _tris[next].n[2] = fan[k];
+    }
+    if (const auto it = std::ranges::find_if(fan, [this](const size_t t) { return !_tris[t].isGhost(); });
+        it != fan.end())
+    {
+        _hint = *it;
+    }
+    return true;
+}
+
+bool IncrementalDelaunay::remove(const size_t v) {
+    const double x = _vertices[v].x;
+    const double y = _vertices[v].y;
+    const auto release = [this, v, x, y] {
+        for (auto [it, end] = _verticesAt.equal_range({x, y}); it != end; ++it) {
+            if (it->second == v) {
+                _verticesAt.erase(it);
+                break;
+            }
+        }
+        _vertices[v].live = false;
+        _vertices[v].tri = none;
+        _freeVertices.push_back(v);
+    };
+    if (_vertices[v].tri == none) {
+        release();
+        return true;
+    }
+
+    // v's star, and the ring of its neighbors counterclockwise, each with the triangle beyond the ring edge to the next
+    struct RingVertex {
+        size_t v, outside;
+    };
+    std::vector<RingVertex> ring;
+    std::vector<size_t> star;
+    size_t numRealInStar = 0;
+    {
+        const auto first = _vertices[v].tri;
+        size_t t = first;
+        do {
+            const auto &tri = _tris[t];
+            const auto i = static_cast<size_t>(std::ranges::find(tri.v, v) - tri.v.begin());
+            if (i == 3 || star.size() > _tris.size()) {
+                return false;
+            }
+            ring.push_back({tri.v[(i + 1) % 3], tri.n[(i + 1) % 3]});
+            star.push_back(t);
+            numRealInStar += tri.isGhost() ? 0 : 1;
+            t = tri.n[(i + 2) % 3];
+        } while (t != first);
+    }
+    // on the hull, the ring passes through infinity; start it there, so that the rest is the chain u0 ... uk
+    const auto inf = std::ranges::find(ring, infinite, &RingVertex::v);
+    const bool onHull = inf != ring.end();
+    std::ranges::rotate(ring, inf != ring.end() ? inf : ring.begin());
+    if (ring.size() < 3) {
+        return false;
+    }
+
+    // ears, found before touching anything: a convex corner of what is left of the ring, whose circumcircle holds no
+    // other vertex of the ring, is a Delaunay triangle of the ring, and so of the triangulation without v. on the hull,
+    // clipping stops when no such corner is left, and what is left of the chain becomes the new hull.
+    std::vector<size_t> ids(ring.size());
+    std::ranges::transform(ring, ids.begin(), &RingVertex::v);
+    auto ringVertices = ids;
+    std::erase(ringVertices, infinite);
+    std::vector<size_t> tips;
+    const auto findEar = [this, &ids, &ringVertices]() -> std::optional<size_t> {
+        const auto m = ids.size();
+        for (size_t j = 0; j < m; ++j) {
+            const auto a = ids[(j + m - 1) % m];
+            const auto b = ids[j];
+            const auto c = ids[(j + 1) % m];
+            if (a == infinite || b == infinite || c == infinite || orient(a, b, c) <= 0.0) {
+                continue;
+            }
+            if (std::ranges::none_of(ringVertices, [&](const size_t w) {
+                    return w != a && w != b && w != c && inCircle(a, b, c, _vertices[w].x, _vertices[w].y) > 0.0;
+                }))
+            {
+                return j;
+            }
+        }
+        return std::nullopt;
+    };
+    while (ids.size() > 3) {
+        const auto j = findEar();
+        if (!j.has_value()) {
+            break;
+        }
+        tips.push_back(*j);
+        ids.erase(ids.begin() + static_cast<std::ptrdiff_t>(*j));
+    }
+    if (onHull) {
+        // the chain left must be convex seen from outside, or a pocket went unfilled
+        for (size_t j = 2; j + 1 < ids.size(); ++j) {
+            if (orient(ids[j - 1], ids[j], ids[j + 1]) > 0.0) {
+                return false;
+            }
+        }
+    } else if (ids.size() != 3 || orient(ids[0], ids[1], ids[2]) <= 0.0) {
+        return false;
+    }
+    if (_numRealTris - numRealInStar + tips.size() + (onHull ? 0 : 1) == 0) {
+        return false;   // nothing would be left to triangulate
+    }
+
+    for (const auto t : star) {
+        freeTri(t);
+    }
+    release();
+    size_t someReal = none;
+    for (const auto j : tips) {
+        const auto m = ring.size();
+        auto &prev = ring[(j + m - 1) % m];
+        const auto &tip = ring[j];
+        const auto &next = ring[(j + 1) % m];
+        const auto t = newTri({prev.v, tip.v, next.v}, {prev.outside, tip.outside, none});
+        relink(prev.outside, prev.v, tip.v, t);
+        relink(tip.outside, tip.v, next.v, t);
+        prev.outside = t;   // the ring now runs prev -> next, along t's edge next -> prev
+        ring.erase(ring.begin() + static_cast<std::ptrdiff_t>(j));
+        someReal = t;
+    }
+    if (!onHull) {
+        const auto t = newTri({ring[0].v, ring[1].v, ring[2].v}, {ring[0].outside, ring[1].outside, ring[2].outside});
+        for (size_t i = 0; i < 3; ++i) {
+            relink(ring[i].outside, ring[i].v, ring[(i + 1) % 3].v, t);
+        }
+        someReal = t;
+    } else {
+        // a ghost (w, w', infinite) on each edge w -> w' of the chain left, chained to each other and to the ghosts
+        // beyond either end of it
+        size_t previousGhost = ring[0].outside;     // the one beyond infinity -> u0
+        for (size_t j = 1; j + 1 < ring.size(); ++j) {
+            const auto g = newTri({ring[j].v, ring[j + 1].v, infinite}, {ring[j].outside, none, previousGhost});
+            relink(ring[j].outside, ring[j].v, ring[j + 1].v, g);
+            relink(previousGhost, infinite, ring[j].v, g);
+            previousGhost = g;
+        }
+        _tris[previousGhost].n[1] = ring.back().outside;
+        relink(ring.back().outside, ring.back().v, infinite, previousGhost);
+    }
+    if (someReal != none) {
+        _hint = someReal;
+    }
+    // a duplicate of v that was left out of the triangulation takes its place
+    for (auto [it, end] = _verticesAt.equal_range({x, y}); it != end; ++it) {
+        if (_vertices[it->second].tri == none) {
+            return insert(it->second);
+        }
+    }
+    return true;
+}
+
+//=============================================================================================================================
+std::optional<std::vector<size_t>> IncrementalDelaunay::update(const std::span<const size_t> removedVertices,
+                                                               const std::span<const double> addedCoords)
+{
+    if (!_valid) {
+        return std::nullopt;
+    }
+    _changed.clear();
+    _hullChanged = false;
+    // insertions first, so that removals never leave too few points to go on from
+    std::vector<size_t> added(addedCoords.size() / 2);
+    for (size_t i = 0; i < added.size(); ++i) {
+        added[i] = addVertex(addedCoords[2 * i], addedCoords[2 * i + 1]);
+        if (!insert(added[i])) {
+            _valid = false;
+            return std::nullopt;
+        }
+    }
+    for (const auto v : removedVertices) {
+        assert(v < _vertices.size() && _vertices[v].live);
+        if (!remove(v)) {
+            _valid = false;
+            return std::nullopt;
+        }
+    }
+    packNumbers();
+    exportChanges(added);
+    return added;
+}
+
+void IncrementalDelaunay::packNumbers() {
+    // the last triangles move into the lowest numbers left free, so that the numbers run from 0 to the count again
+    std::ranges::sort(_freeNumbers);
+    const auto dropFreeTail = [this] {
+        while (!_trisByNumber.empty() && _trisByNumber.back() == none) {
+            _trisByNumber.pop_back();
+        }
+    };
+    for (const auto number : _freeNumbers) {
+        dropFreeTail();
+        if (number >= _trisByNumber.size()) {
+            break;
+        }
+        const auto t = _trisByNumber.back();
+        _trisByNumber.pop_back();
+        _trisByNumber[number] = t;
+        _tris[t].number = number;
+        markChanged(t);
+        for (const auto nb : _tris[t].n) {
+            markChanged(nb);    // their halfedges across from t lead to its new number
+        }
+    }
+    dropFreeTail();
+    _freeNumbers.clear();
+}
+
+void IncrementalDelaunay::exportChanges(const std::span<const size_t> addedVertices) {
+    auto &out = _exported;
+    const auto numVertices = _vertices.size();
+    out.coords.resize(2 * numVertices);
+    out.hull_prev.resize(numVertices, delaunator::INVALID_INDEX);
+    out.hull_next.resize(numVertices, delaunator::INVALID_INDEX);
+    for (const auto v : addedVertices) {
+        out.coords[2 * v] = _vertices[v].x;
+        out.coords[2 * v + 1] = _vertices[v].y;
+    }
+    const auto count = _trisByNumber.size();
+    out.triangles.resize(3 * count);
+    out.halfedges.resize(3 * count);
+    std::ranges::sort(_changed);
+    _changed.erase(std::unique(_changed.begin(), _changed.end()), _changed.end());
+    _changed.erase(std::ranges::lower_bound(_changed, count), _changed.end());   // moved away, or gone
+    for (const auto j : _changed) {
+        // our counterclockwise (a, b, c) is its clockwise (a, c, b); our edge i is its edge 2 - i, reversed
+        const auto &tri = _tris[_trisByNumber[j]];
+        out.triangles[3 * j] = tri.v[0];
+        out.triangles[3 * j + 1] = tri.v[2];
+        out.triangles[3 * j + 2] = tri.v[1];
+        for (size_t i = 0; i < 3; ++i) {
+            const auto &nb = _tris[tri.n[i]];
+            out.halfedges[3 * j + 2 - i] = delaunator::INVALID_INDEX;
+            if (nb.isGhost()) {
+                continue;
+            }
+            for (size_t k = 0; k < 3; ++k) {
+                if (nb.v[k] == tri.v[(i + 1) % 3] && nb.v[(k + 1) % 3] == tri.v[i]) {
+                    out.halfedges[3 * j + 2 - i] = 3 * nb.number + 2 - k;
+                    break;
+                }
+            }
+        }
+    }
+    if (!_hullChanged) {
+        return;
+    }
+    // take down the old hull, and go around the ghosts for the new one: a ghost (y, x, infinite) lies beyond the hull
+    // edge y -> x, and meets the next ghost across its edge x -> infinite
+    if (out.hull_start != delaunator::INVALID_INDEX) {
+        size_t v = out.hull_start;
+        do {
+            const auto next = out.hull_next[v];
+            out.hull_next[v] = out.hull_prev[v] = delaunator::INVALID_INDEX;
+            v = next;
+        } while (v != out.hull_start && v != delaunator::INVALID_INDEX);
+    }
+    out.hull_start = delaunator::INVALID_INDEX;
+    if (_ghost >= _tris.size() || !_tris[_ghost].live || !_tris[_ghost].isGhost()) {
+        const auto it = std::ranges::find_if(_tris, [](const Tri &tri) { return tri.live && tri.isGhost(); });
+        if (it == _tris.end()) {
+            return;
+        }
+        _ghost = static_cast<size_t>(it - _tris.begin());
+    }
+    size_t g = _ghost;
+    for (size_t step = 0; step < _tris.size(); ++step) {
+        const auto &ghost = _tris[g];
+        const auto j = static_cast<size_t>(std::ranges::find(ghost.v, infinite) - ghost.v.begin());
+        const auto y = ghost.v[(j + 1) % 3];
+        const auto x = ghost.v[(j + 2) % 3];
+        out.hull_next[y] = x;
+        out.hull_prev[x] = y;
+        out.hull_start = y;
+        g = ghost.n[(j + 2) % 3];
+        if (g == _ghost) {
+            break;
+        }
+    }
+}
+
+}   // namespace nvs::timbrespace
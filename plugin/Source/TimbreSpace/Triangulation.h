@@ -0,0 +1,139 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <array>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "../../delaunator-cpp/include/delaunator.hpp"
+
+namespace nvs::timbrespace {
+
+/**
+ * A 2D Delaunay triangulation, laid out like delaunator::Delaunator's result (which it can be made from), but owning
+ * its arrays, so that it can also come from an IncrementalDelaunay and live on in an immutable snapshot.
+ *
+ * Triangles are clockwise. Halfedge e runs from triangles[e] to triangles[e % 3 == 2 ? e - 2 : e + 1], and halfedges[e]
+ * is its twin in the neighboring triangle, or delaunator::INVALID_INDEX on the hull. The hull runs clockwise as well,
+ * from hull_start through hull_next (and back through hull_prev); both are indexed by vertex, and are INVALID_INDEX for
+ * vertices not on the hull. Vertices that duplicate another, or that an IncrementalDelaunay has removed, are in coords
+ * but in no triangle.
+ */
+struct Triangulation {
+    std::vector<double> coords;             // x0, y0, x1, y1, ...
+    std::vector<size_t> triangles;
+    std::vector<size_t> halfedges;
+    std::vector<size_t> hull_prev;
+    std::vector<size_t> hull_next;
+    size_t hull_start {delaunator::INVALID_INDEX};
+
+    Triangulation() = default;
+    explicit Triangulation(const delaunator::Delaunator &d);
+
+    size_t numVertices() const { return coords.size() / 2; }
+    size_t numTriangles() const { return triangles.size() / 3; }
+    size_t bytes() const {
+        return coords.capacity() * sizeof(double)
+             + (triangles.capacity() + halfedges.capacity() + hull_prev.capacity() + hull_next.capacity()) * sizeof(size_t);
+    }
+
+    // renumbers the vertices, and the triangles, in the order they come along a Hilbert curve through their bounding box
+    // (triangles by their centroid), so that a walk across the triangulation reads memory that is mostly close by
+    // rather than scattered in construction order. returns the vertices' former indices in their new order.
+    std::vector<size_t> renumberAlongHilbertCurve();
+};
+
+/**
+ * A Delaunay triangulation that can be updated point by point, so that a small change to the point set (e.g. the filter
+ * window sliding by a few ranks) costs a few local retriangulations instead of a full rebuild.
+ *
+ * Points are inserted Bowyer-Watson style: the triangles whose circumcircles contain the new point are cleared out and
+ * the hole is fanned from it. Removing a point clips its ring of neighbors into ears, each Delaunay among the ring. The
+ * outside of the hull is covered by "ghost" triangles sharing a vertex at infinity, so that points outside the hull
+ * need no special case; they are dropped when exporting.
+ *
+ * Vertices and triangles keep their numbers from one update to the next, so that the exported triangulation, and
+ * whatever is built over it, can be patched where it changed rather than made anew. A removed vertex's number (and a
+ * removed triangle's) may be taken by one added later; triangle numbers stay packed, the last triangle moving into any
+ * number left free.
+ *
+ * Plain floating point predicates are used, as in Delaunator. Should an update run into a configuration they cannot
+ * resolve consistently (or leave fewer than three non-collinear points), it says so, and the caller rebuilds.
+ */
+class IncrementalDelaunay
+{
+public:
+    // triangulates coords from scratch with Delaunator, which throws if they cannot be triangulated, and renumbers the
+    // result along a Hilbert curve (see Triangulation::renumberAlongHilbertCurve). returns the point of coords that
+    // each vertex is.
+    std::vector<size_t> rebuild(const std::vector<double> &coords);
+    // removes the given vertices and inserts the points of addedCoords (x0, y0, x1, y1, ...), returning the vertex each
+    // of those became. returns nullopt, leaving the triangulation to be rebuilt, if one of them fails.
+    std::optional<std::vector<size_t>> update(std::span<const size_t> removedVertices, std::span<const double> addedCoords);
+
+    bool isValid() const { return _valid; }
+    const Triangulation &triangulation() const { return _exported; }
+    // since the update before: the triangles whose vertices or neighbors changed, or that moved to another number,
+    // ascending; and whether the hull changed (or a triangle on it moved)
+    std::span<const size_t> changedTriangles() const { return _changed; }
+    bool hullChanged() const { return _hullChanged; }
+private:
+    static constexpr size_t none {delaunator::INVALID_INDEX};
+    static constexpr size_t infinite {delaunator::INVALID_INDEX - 1};   // the ghost triangles' shared vertex
+
+    struct Tri {
+        std::array<size_t, 3> v;    // counterclockwise; a ghost has one infinite vertex
+        std::array<size_t, 3> n;    // n[i]: the neighbor across the edge from v[i] to v[(i + 1) % 3]
+        bool live {true};
+        size_t number {none};       // in the exported triangulation; none for a ghost
+        bool isGhost() const { return v[0] == infinite || v[1] == infinite || v[2] == infinite; }
+    };
+    struct Vertex {
+        double x, y;
+        size_t tri {none};          // any live triangle incident to it, or none if it is not in the triangulation
+        bool live {true};
+    };
+    struct PositionHash {
+        size_t operator()(const std::pair<double, double> &p) const noexcept {
+            return std::hash<double>{}(p.first) * 0x9E3779B97F4A7C15ull ^ std::hash<double>{}(p.second);
+        }
+    };
+
+    std::vector<Tri> _tris;
+    std::vector<size_t> _freeTris;
+    std::vector<Vertex> _vertices;
+    std::vector<size_t> _freeVertices;
+    std::unordered_multimap<std::pair<double, double>, size_t, PositionHash> _verticesAt;
+    size_t _numRealTris {0};
+    size_t _hint {none};            // a live real triangle near the last change, to start locating from
+    bool _valid {false};
+
+    Triangulation _exported;
+    std::vector<size_t> _trisByNumber;  // the slot in _tris of each exported triangle; none for a number left free
+    std::vector<size_t> _freeNumbers;   // left free during the current update, to be taken again or packed away
+    std::vector<size_t> _changed;
+    bool _hullChanged {false};
+    size_t _ghost {none};               // some ghost triangle, to start going around the hull from
+
+    void assign(const Triangulation &t);
+    size_t addVertex(double x, double y);
+    bool insert(size_t vertex);
+    bool remove(size_t vertex);
+    void markChanged(size_t t);         // any triangle, whose exported edges (or the hull, for a ghost) need rewriting
+    void packNumbers();
+    void exportChanges(std::span<const size_t> addedVertices);     // into _exported
+
+    size_t newTri(const std::array<size_t, 3> &v, const std::array<size_t, 3> &n);
+    void freeTri(size_t t);
+    void relink(size_t t, size_t a, size_t b, size_t neighbor);    // sets t's neighbor across its edge b->a
+    size_t locate(double x, double y) const;        // a triangle in conflict with (x, y), or none
+    bool inConflict(const Tri &t, double x, double y) const;
+    double orient(size_t a, size_t b, size_t c) const;
+    double orient(size_t a, size_t b, double x, double y) const;
+    double inCircle(size_t a, size_t b, size_t c, double x, double y) const;
+};
+
+}   // namespace nvs::timbrespace
@@ -0,0 +1,60 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace nvs::timbrespace {
+
+/**
+ * Hands immutable snapshots from one writer thread to one reader thread, wait-free on both sides.
+ *
+ * Of the three slots, the writer owns one (back), the reader owns one (front), and the third (middle) is passed between
+ * them through a single atomic word. Publishing fills back and swaps it with middle; reading swaps front with middle
+ * only if something newer has been published since. Neither side ever waits on the other, and neither ever touches
+ * the slot the other owns: in particular, the writer only releases a snapshot when it overwrites its own back slot,
+ * which the reader gave up before the swap that handed it over, so it never frees one the reader may still be looking
+ * at. (A reader that keeps its own copy of the shared_ptr keeps that snapshot alive, as usual.)
+ *
+ * Every snapshot carries the generation it was published as, counting from 1; 0 means nothing has been published yet.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    struct Snapshot {
+        std::shared_ptr<const T> data {};
+        std::uint64_t generation {0};
+    };
+
+    // writer thread only
+    void publish(std::shared_ptr<const T> data) {
+        auto &back = _slots[_back];
+        back.data = std::move(data);      // releases what this slot last held, which the reader has let go of
+        back.generation = ++_published;
+        _back = _middle.exchange(_back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+    // reader thread only. the reference stays valid until this reader's next read().
+    const Snapshot &read() {
+        if (_middle.load(std::memory_order_relaxed) & freshBit) {
+            _front = _middle.exchange(_front, std::memory_order_acq_rel) & indexMask;
+        }
+        return _slots[_front];
+    }
+private:
+    static constexpr std::uint8_t indexMask {0b011};
+    static constexpr std::uint8_t freshBit {0b100};   // set by the writer, cleared by the reader
+
+    std::array<Snapshot, 3> _slots {};
+    std::atomic<std::uint8_t> _middle {1};
+    std::uint8_t _front {0};              // reader's
+    std::uint8_t _back {2};               // writer's
+    std::uint64_t _published {0};         // writer's
+    static_assert(std::atomic<std::uint8_t>::is_always_lock_free);
+};
+
+}   // namespace nvs::timbrespace
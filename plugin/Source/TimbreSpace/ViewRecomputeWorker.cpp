@@ -0,0 +1,82 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#include "ViewRecomputeWorker.h"
+#include "Analysis/Tracing.h"
+
+namespace nvs::timbrespace {
+
+ViewRecomputeWorker::ViewRecomputeWorker()
+:   juce::Thread("ViewRecomputeWorker")
+{}
+ViewRecomputeWorker::~ViewRecomputeWorker() {
+    signalThreadShouldExit();
+    _jobAvailable.signal();
+    stopThread(5000);
+}
+
+void ViewRecomputeWorker::post(const void *owner, Job job) {
+    {
+        const juce::ScopedLock sl(_lock);
+        if (const auto it = std::ranges::find(_pending, owner, &PendingJob::owner);
+            it != _pending.end())
+        {
+            it->job = std::move(job);
+        } else {
+            _pending.push_back({owner, std::move(job)});
+        }
+        if (_runningOwner == owner) {
+            _runningSuperseded.store(true, std::memory_order_relaxed);
+        }
+    }
+    _jobAvailable.signal();
+    if (!isThreadRunning()) {
+        startThread(juce::Thread::Priority::normal);
+    }
+}
+
+void ViewRecomputeWorker::cancel(const void *owner) {
+    const juce::ScopedLock sl(_lock);
+    std::erase_if(_pending, [owner](const PendingJob &p) { return p.owner == owner; });
+    while (_runningOwner == owner) {
+        _runningSuperseded.store(true, std::memory_order_relaxed);
+        const juce::ScopedUnlock su(_lock);
+        _jobFinished.wait(100);
+    }
+}
+
+void ViewRecomputeWorker::run() {
+    const analysis::ShouldExitFn shouldExit = [this] {
+        return threadShouldExit() || _runningSuperseded.load(std::memory_order_relaxed);
+    };
+    while (!threadShouldExit()) {
+        std::optional<PendingJob> next;
+        {
+            const juce::ScopedLock sl(_lock);
+            if (!_pending.empty()) {
+                next = std::move(_pending.front());
+                _pending.erase(_pending.begin());
+                _runningOwner = next->owner;
+                _runningSuperseded.store(false, std::memory_order_relaxed);
+            }
+        }
+        if (!next.has_value()) {
+            _jobAvailable.wait(-1);
+            continue;
+        }
+        try {
+            TSN_TRACE_SPAN("ViewRecomputeWorker job");
+            next->job(shouldExit);
+        } catch (const std::exception &e) {
+            DBG("ViewRecomputeWorker: job failed: " << e.what());
+        }
+        {
+            const juce::ScopedLock sl(_lock);
+            _runningOwner = nullptr;
+        }
+        _jobFinished.signal();
+    }
+}
+
+}   // namespace nvs::timbrespace
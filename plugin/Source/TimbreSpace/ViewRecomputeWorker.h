@@ -0,0 +1,48 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "../Analysis/RunLoopStatus.h"
+
+namespace nvs::timbrespace {
+
+/**
+ * Runs the view recomputes of TimbreSpace and TimbreSpacePointSelector off the message thread.
+ *
+ * Each owner has at most one job pending: posting replaces the one not yet started, and tells the one running (through
+ * its shouldExit) that it has been superseded, so a burst of parameter changes, e.g. a slider drag, costs one
+ * recompute for its latest values rather than one per tick. Jobs run one at a time, in the order their owners first
+ * posted them. A job receives everything it reads by value (or as immutable shared data) and publishes its result
+ * itself, typically through a TripleBuffer and an AsyncUpdater.
+ */
+class ViewRecomputeWorker final : private juce::Thread
+{
+public:
+    using Job = std::function<void(const analysis::ShouldExitFn &shouldExit)>;
+
+    ViewRecomputeWorker();
+    ~ViewRecomputeWorker() override;
+
+    void post(const void *owner, Job job);
+    // drops owner's pending job and waits for its running one to give up; call before owner is destroyed
+    void cancel(const void *owner);
+private:
+    void run() override;
+
+    struct PendingJob {
+        const void *owner;
+        Job job;
+    };
+    juce::CriticalSection _lock;
+    std::vector<PendingJob> _pending;       // at most one per owner
+    const void *_runningOwner {nullptr};
+    std::atomic<bool> _runningSuperseded {false};
+    juce::WaitableEvent _jobAvailable;
+    juce::WaitableEvent _jobFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ViewRecomputeWorker)
+};
+
+}   // namespace nvs::timbrespace
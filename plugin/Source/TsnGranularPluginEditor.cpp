@@ -11,7 +11,6 @@
 #include "Gui/SettingsWindow.h"
 #include "Gui/SegmentedWaveformComponent.h"
 #include "Gui/NavigatorPage.h"
-#include "Analysis/RunLoopStatus.h"
 
 //==============================================================================
 
@@ -63,10 +62,9 @@ TsnGranularAudioProcessorEditor::TsnGranularAudioProcessorEditor (TSNGranularAud
 #pragma message("need to fix this part based on the new changes. We don't want to do unecessary point calculations on construction, but do want to draw already-stored point data.")
 
 	auto &a = TSNaudioProcessor.getAnalyzer();
-	a.getStatus().addChangeListener(&timbreSpaceComponent);	// to tell timbre space comp to make progress bar visible
-	a.addListener(&timbreSpaceComponent);		// tell timbre space comp to hide progress bar if thread exits early
 	a.addChangeListener(&timbreSpaceComponent); // tell timbre space comp to hide progress bar when analysis successfully completes
     a.addChangeListener(waveformComponent.get());
+	TSNaudioProcessor.getEventExporter().addChangeListener(&timbreSpaceComponent);	// hides the progress bar when an export ends
 
     if (const auto x = dynamic_cast<juce::ActionListener*>(waveformComponent.get())) {
         auto &ts = TSNaudioProcessor.getTimbreSpace();
@@ -89,8 +87,6 @@ TsnGranularAudioProcessorEditor::~TsnGranularAudioProcessorEditor()
 	closeAllWindows();
 	
 	auto &a = TSNaudioProcessor.getAnalyzer();
-	a.getStatus().removeChangeListener(&timbreSpaceComponent);
-	a.removeListener(&timbreSpaceComponent);
 	a.removeChangeListener(&timbreSpaceComponent);
 	a.removeChangeListener(this);
     jassert (waveformComponent != nullptr);
@@ -99,6 +95,7 @@ TsnGranularAudioProcessorEditor::~TsnGranularAudioProcessorEditor()
         ts.removeActionListener(x);
     }
     a.removeChangeListener(waveformComponent.get());
+	TSNaudioProcessor.getEventExporter().removeChangeListener(&timbreSpaceComponent);
 }
 //==============================================================================
 void TsnGranularAudioProcessorEditor::closeAllWindows()
@@ -133,6 +130,7 @@ void TsnGranularAudioProcessorEditor::mouseDown(const juce::MouseEvent &) {}
 void TsnGranularAudioProcessorEditor::mouseDrag(const juce::MouseEvent &) {}
 //==============================================================================
 void TsnGranularAudioProcessorEditor::timerCallback() {
+    timbreSpaceComponent.pollAnalysisProgress();    // progress is sampled here rather than pushed by the analysis threads
     timbreSpaceComponent.repaint(); // EXPENSIVE
     jassert (waveformComponent != nullptr);
     waveformComponent->highlightOnsets(TSNaudioProcessor.getTsnGranularSynthesizer()->getTimbreSpacePointSelector().getCurrentPointIndices());
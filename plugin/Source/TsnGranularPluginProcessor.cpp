@@ -4,7 +4,9 @@
 #include "TsnGranularPluginEditor.h"
 #include "fmt/core.h"
 #include "Analysis/Settings.h"
+#include "Analysis/AnalysisFileFormat.h"
 #include "Analysis/OnsetAnalysis/OnsetProcessing.h"
+#include "Analysis/Tracing.h"
 
 //==============================================================================
 
@@ -20,6 +22,7 @@ TSNGranularAudioProcessor::TSNGranularAudioProcessor()
 	
 	juce::ValueTree settingsVT = apvts.state.getOrCreateChildWithName("Settings", nullptr);
 	nvs::analysis::initializeSettingsBranches(settingsVT, false);
+	nvs::analysis::ensureViewSettings(apvts.state);
 
     _analyzer.addChangeListener(this);
 
@@ -28,14 +31,19 @@ TSNGranularAudioProcessor::TSNGranularAudioProcessor()
 	// anything that uses _granularSynth in any way).
 }
 TSNGranularAudioProcessor::~TSNGranularAudioProcessor() {
+	_tsnGranularSynth->getTimbreSpace().onFeaturesMissing = nullptr;
 	_analyzer.removeChangeListener(&_tsnGranularSynth->getTimbreSpace());
     _analyzer.removeChangeListener(this);
+	nvs::trace::flushToConfiguredFile();
 }
 //==============================================================================
 void TSNGranularAudioProcessor::initSynth() {
     _granularSynth = std::make_unique<TSNGranularSynth>(apvts);
     _tsnGranularSynth = static_cast<TSNGranularSynth*>(_granularSynth.get());
 	_analyzer.addChangeListener(&_tsnGranularSynth->getTimbreSpace());
+	_tsnGranularSynth->getTimbreSpace().onFeaturesMissing = [this] {
+		_analyzer.prioritizeFeatures(getFeaturesInUse());
+	};
 }
 juce::AudioProcessorEditor* TSNGranularAudioProcessor::createEditor() {
     const auto ed = new TsnGranularAudioProcessorEditor (*this);
@@ -56,14 +64,20 @@ void TSNGranularAudioProcessor::setStateInformation (const void* data, int sizeI
 
 	writeToLog("setStateInformation fully successful\n");
 }
-void TSNGranularAudioProcessor::saveAnalysisToFile(const juce::String& filePath, std::function<void(bool)> resultCallback) const {
+void TSNGranularAudioProcessor::saveAnalysisToFile(const juce::String& filePath, std::function<void(bool)> resultCallback) {
+	if (auto const &timbreSpace = _tsnGranularSynth->getTimbreSpace(); timbreSpace.isProvisional() || !timbreSpace.hasAllFeatures()) {
+		// a provisional sketch would be saved under the full settings hash, and a lazy analysis still filling in
+		// features with zeros in their place
+		if (resultCallback) {
+			resultCallback(false);
+		}
+		return;
+	}
 	// inform plugin state of what the associated analysis file will be
 	auto fileInfo = apvts.state.getChildWithName("FileInfo");
 	if (!fileInfo.isValid()) return;
 	fileInfo.setProperty("analysisFile", filePath, nullptr);
 
-	juce::ValueTree analysisVT("super");
-
 	/* metadata needs:
      -audio sample absolute path (for loading audio file when analysis is imported)
      -audio file sample rate?
@@ -72,27 +86,16 @@ void TSNGranularAudioProcessor::saveAnalysisToFile(const juce::String& filePath,
      if the audio gets analyzed, but then is later edited, this will require new analysis)) -later: maybe the settings
      themselves, which would allow to load analysis file and populate the settings of the plugin instance?
     */
-    const auto tsTree = _tsnGranularSynth->getTimbreSpace().getTimbreSpaceTree();
-	auto timbreSpaceMetaDataTree = tsTree.getChildWithName(nvs::axiom::Metadata);
-	timbreSpaceMetaDataTree.setProperty(nvs::axiom::sampleFilePath, apvts.state.getProperty(nvs::axiom::sampleFilePath), nullptr);
-	timbreSpaceMetaDataTree.setProperty(nvs::axiom::sampleRate, apvts.state.getProperty(nvs::axiom::sampleRate), nullptr);
-	timbreSpaceMetaDataTree.setProperty(nvs::axiom::audioHash, sampleManagementGuts.getWaveformHash(), nullptr);
-	timbreSpaceMetaDataTree.setProperty(nvs::axiom::settingsHash, _analyzer.getSettingsHash(), nullptr);
-	analysisVT.addChild(tsTree, 1, nullptr);
+	const auto analysisVT = nvs::analysis::makeAnalysisFileTree(_tsnGranularSynth->getTimbreSpace().getTimbreSpaceTree(), {
+		.sampleFilePath = apvts.state.getProperty(nvs::axiom::sampleFilePath),
+		.sampleRate = apvts.state.getProperty(nvs::axiom::sampleRate),
+		.audioHash = sampleManagementGuts.getWaveformHash(),
+		.settingsHash = _analyzer.getSettingsHash()
+	});
 
     DBG(fmt::format("tree being SAVED: {}", nvs::util::valueTreeToXmlStringSafe(analysisVT).toStdString()));
-	bool success = [vt=analysisVT, filePath](bool useBinary){
-		juce::File const file(filePath);
-		if (useBinary){
-			return nvs::util::saveValueTreeToBinary(vt, file);
-		}
-		else {
-			return nvs::util::saveValueTreeToJSON(vt, file);
-		}
-	}(true);
-	juce::MessageManager::callAsync([resultCallback, success](){
-		resultCallback(success);
-	});
+	// serialization and disk write happen on the I/O worker; it deep-copies the tree before returning
+	_analysisFileWorker.requestSave(analysisVT, juce::File(filePath), true, std::move(resultCallback));
 }
 //==============================================================================
 void TSNGranularAudioProcessor::loadAudioFileAndUpdateState(juce::File const f, bool notifyEditor){
@@ -104,7 +107,12 @@ void TSNGranularAudioProcessor::loadAudioFileAndUpdateState(juce::File const f,
 		/* do nothing */
 		writeToLog(fmt::format("TSNGranularAudioProcessor already had valid analysis for {}\n", f.getFullPathName().toStdString()));
 	}
-	else if (!loadAnalysisFileFromState())	// try to load analysis from state; if it fails then do fresh analysis
+	else if (!loadAnalysisFileFromState([this](const bool loaded){
+		// try to load analysis from state; if it fails then do fresh analysis
+		if (!loaded && !_tsnGranularSynth->getTimbreSpace().hasValidAnalysisFor(sampleManagementGuts.getWaveformHash())) {
+			askForAnalysis();
+		}
+	}))
 	{
 		askForAnalysis();
 	}
@@ -112,9 +120,7 @@ void TSNGranularAudioProcessor::loadAudioFileAndUpdateState(juce::File const f,
 }
 
 void TSNGranularAudioProcessor::askForAnalysis(){
-	if (_analyzer.Thread::isThreadRunning()){
-		_analyzer.stopAnalysis();
-	}
+	++_analysisLoadGeneration;	// a fresh analysis supersedes any analysis file load still in flight
 	auto const buffer = sampleManagementGuts.getSampleBuffer();
 	if (!buffer.getNumChannels()){
 		writeToLog("TSN: askForAnalysis: buffer had no channels. Early exit.");
@@ -124,26 +130,30 @@ void TSNGranularAudioProcessor::askForAnalysis(){
 		writeToLog("TSN: askForAnalysis: buffer had no samples. Early exit.");
 		return;
 	}
-	_analyzer.updateStoredAudio(std::span(buffer.getReadPointer(0), static_cast<size_t>(buffer.getNumSamples())),
-		getSampleFilePath());
-	
 	auto settingsVT = apvts.state.getChildWithName("Settings");
 	auto const par = settingsVT.getParent();
 	jassert (par.getChildWithName("FileInfo").hasProperty("sampleRate"));
-	_analyzer.updateSettings(settingsVT, true);
-	
-	if (_analyzer.startThread(juce::Thread::Priority::high)){	// only entry point to analysis
-		writeToLog("analyzer onset thread started");
+
+	// only entry point to analysis. supersedes (and cancels) whatever the analyzer was doing
+	if (_analyzer.requestAnalysis(std::span(buffer.getReadPointer(0), static_cast<size_t>(buffer.getNumSamples())),
+								  getSampleFilePath(), settingsVT, getFeaturesInUse())){
+		writeToLog("analysis requested");
 	}
 }
+std::vector<nvs::analysis::Feature_e> TSNGranularAudioProcessor::getFeaturesInUse() const {
+	// the features currently on screen or filtering points: all a provisional or lazy analysis needs to be useful
+	auto features = _tsnGranularSynth->getTimbreSpace().getDimensionwiseFeatures();
+	features.push_back(static_cast<nvs::analysis::Feature_e>(apvts.getRawParameterValue(nvs::axiom::filtered_feature)->load()));
+	return features;
+}
 void TSNGranularAudioProcessor::changeListenerCallback (juce::ChangeBroadcaster *source) {
     if (source == &_analyzer) {
-        if (!_analyzer.onsetsReady()) {
+        const auto onsetsResult = _analyzer.shareOnsetAnalysis();   // null if not ready, or superseded by a newer request
+        if (onsetsResult == nullptr) {
             DBG("TSNGranularAudioProcessor: onsets not ready, returning\n");
             return;
         }
-        if (const auto onsetsResult = _analyzer.shareOnsetAnalysis();
-            onsetsResult->waveformHash == sampleManagementGuts.getWaveformHash())
+        if (onsetsResult->waveformHash == sampleManagementGuts.getWaveformHash())
         {
             _tsnGranularSynth->loadOnsets(onsetsResult);
         } else {
@@ -159,46 +169,50 @@ void TSNGranularAudioProcessor::writeEvents(){
 		DBG("TSNGranularAudioProcessor::writeEvents failed: shared onsets null, returning early\n");
 		return;
 	}
-
     auto settingsVT = apvts.state.getChildWithName(nvs::axiom::Settings);
-    _analyzer.updateSettings(settingsVT, true);
-
-	auto const buffer = sampleManagementGuts.getSampleBuffer();
-	auto const waveSpan = std::span(buffer.getReadPointer(0), static_cast<size_t>(buffer.getNumSamples()));
-	std::vector<float> wave(waveSpan.size());
-	wave.assign(waveSpan.begin(), waveSpan.end());
-	
-	// any reason to use getPropertyAsValue instead?
-
-	std::vector<float> onsetsTmp = sharedOnsets->onsets;
+    nvs::analysis::AnalyzerSettings settings;
+    if (!nvs::analysis::verifySettingsStructureWithAttemptedFix(settingsVT)
+        || !nvs::analysis::updateSettingsFromValueTree(settings, settingsVT))
+    {
+        DBG("TSNGranularAudioProcessor::writeEvents failed: invalid settings, returning early\n");
+        return;
+    }
 
     auto const par = settingsVT.getParent();
     const auto fileInfoTree = par.getChildWithName(nvs::axiom::FileInfo);
     jassert (fileInfoTree.hasProperty(nvs::axiom::sampleRate));
-
-    const auto sampleFilePath = [fileInfoTree, sharedOnsets]()-> std::string {
-        jassert (fileInfoTree.hasProperty(nvs::axiom::sampleFilePath));
-	    const juce::String sfp = fileInfoTree.getProperty(nvs::axiom::sampleFilePath);
-	    jassert(!sfp.isEmpty());
-	    if (sharedOnsets->audioFileAbsPath != sfp) {
-	        DBG("TSNGranularAudioProcessor::writeEvents failed: file path mismatch, returning early\n");
-	        return "";
-	    }
-        return sfp.toStdString();
-    }();
-    if (sampleFilePath == "") {
-        return; // file path mismatch
+    jassert (fileInfoTree.hasProperty(nvs::axiom::sampleFilePath));
+    const juce::String sampleFilePath = fileInfoTree.getProperty(nvs::axiom::sampleFilePath);
+    jassert(!sampleFilePath.isEmpty());
+    if (sharedOnsets->audioFileAbsPath != sampleFilePath) {
+        DBG("TSNGranularAudioProcessor::writeEvents failed: file path mismatch, returning early\n");
+        return;
     }
 
-    const float sr = fileInfoTree.getProperty(nvs::axiom::sampleRate);
-	nvs::analysis::denormalizeOnsets(onsetsTmp, nvs::analysis::getLengthInSeconds(wave.size(), sr));
-	
-	nvs::analysis::RunLoopStatus rls;
-    const nvs::analysis::ShouldExitFn shouldExitFn = [](){return false;};
-	nvs::analysis::writeEventsToWav(wave, onsetsTmp, sampleFilePath, _analyzer.getAnalyzer(), rls, shouldExitFn);
+	auto const buffer = sampleManagementGuts.getSampleBuffer();
+	// the one copy of the audio; the exporter streams every event's slice straight out of it
+	nvs::analysis::vecReal wave(buffer.getReadPointer(0), buffer.getReadPointer(0) + buffer.getNumSamples());
+	std::vector<float> onsets = sharedOnsets->onsets;
+    const double sr = fileInfoTree.getProperty(nvs::axiom::sampleRate);
+	nvs::analysis::denormalizeOnsets(onsets, nvs::analysis::getLengthInSeconds(wave.size(), sr));
+
+	const auto directory = nvs::analysis::EventExporter::getExportDirectory(sampleFilePath,
+	                                                                        nvs::util::hashValueTree(settingsVT));
+	writeToLog("writing events to " + directory.getFullPathName());
+	// supersedes (and cancels) an export still in progress
+	_eventExporter.requestExport({
+		.wave = std::move(wave),
+		.onsetsInSeconds = std::move(onsets),
+		.sampleRate = sr,
+		.fadeInSamps = settings.split.fadeInSamps,
+		.fadeOutSamps = settings.split.fadeOutSamps,
+		.directory = directory,
+		.filePrefix = juce::File(sampleFilePath.dropLastCharacters(4)).getFileName()
+	});
 }
 
 void TSNGranularAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+	_analysisExecutor->noteAudioCallback(isNonRealtime());	// lets background analysis (of every instance) back off
 	if (!_tsnGranularSynth->getTimbreSpace().hasValidAnalysisFor(sampleManagementGuts.getWaveformHash())) {
 		juce::ScopedNoDenormals noDenormals;	// probably not necessary at this point but also doesnt hurt
 		for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i){
@@ -218,8 +232,9 @@ void TSNGranularAudioProcessor::ensureSettingsStructure() {
         juce::ValueTree settingsVT = apvts.state.getOrCreateChildWithName(nvs::axiom::Settings, nullptr);
         nvs::analysis::initializeSettingsBranches(settingsVT);
     }
+    nvs::analysis::ensureViewSettings(apvts.state);
 }
-bool TSNGranularAudioProcessor::loadAnalysisFileFromState() {
+bool TSNGranularAudioProcessor::loadAnalysisFileFromState(std::function<void(bool)> onLoaded) {
     // TODO: Return more particular failure/success and handle each case. E.g. there could be auto-search in
     /// designated directory, manual find, and give up (just perform fresh analysis)
     const auto fileInfo = apvts.state.getChildWithName(nvs::axiom::FileInfo);
@@ -236,18 +251,27 @@ bool TSNGranularAudioProcessor::loadAnalysisFileFromState() {
 	    return false;
     }
     const juce::File analysisFile(analysisFilePath);
-    auto analysisFileInputStream = juce::FileInputStream(analysisFile);
-
-    if (analysisFileInputStream.failedToOpen()) {
-        writeToLog(fmt::format("failed to open {}; error message: {}",
-            analysisFilePath.toStdString(),
-            analysisFileInputStream.getStatus().getErrorMessage().toStdString()));
+    if (!analysisFile.existsAsFile()) {
+        writeToLog(fmt::format("analysis file {} does not exist", analysisFilePath.toStdString()));
         // TODO: Give popup opportunity for user to find the file
         return false;
     }
-
-    const auto analysisFileValueTree = juce::ValueTree::readFromStream(analysisFileInputStream);
-
+	// opening and parsing happen on the I/O worker; only the (cheap) hash check and tree swap come back here.
+	// a newer request supersedes this one, in which case its result is simply dropped.
+	const auto generation = ++_analysisLoadGeneration;
+	_analysisFileWorker.requestLoad(analysisFile, [this, generation, onLoaded = std::move(onLoaded)](const juce::ValueTree &loadedTree){
+		if (generation != _analysisLoadGeneration) {
+			writeToLog("analysis file load superseded, ignoring");
+			return;
+		}
+		const bool success = applyLoadedAnalysisTree(loadedTree);
+		if (onLoaded) {
+			onLoaded(success);
+		}
+	});
+	return true;
+}
+bool TSNGranularAudioProcessor::applyLoadedAnalysisTree(const juce::ValueTree &analysisFileValueTree) {
     if (const auto analysisFileTree = analysisFileValueTree.getChildWithName(nvs::axiom::TimbreAnalysis);
         analysisFileTree.isValid())
     {
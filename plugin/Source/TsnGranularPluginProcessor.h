@@ -4,6 +4,9 @@
 #pragma once
 
 #include "./Analysis/ThreadedAnalyzer.h"
+#include "./Analysis/AnalysisFileWorker.h"
+#include "./Analysis/AnalysisExecutor.h"
+#include "./Analysis/EventExporter.h"
 
 #include "./Synthesis/TSNPolyGrain.h"
 #include "./Synthesis/TSNGranularSynthesizer.h"
@@ -41,6 +44,9 @@ public:
 	ThreadedAnalyzer &getAnalyzer() {
 		return _analyzer;
 	}
+	nvs::analysis::EventExporter &getEventExporter() {
+		return _eventExporter;
+	}
 	[[deprecated("theory: the only valid reasons to get timbreSpace from here would be saving, writing, and validation. create helper methods instead.")]]
     TimbreSpace &getTimbreSpace() const { return _tsnGranularSynth->getTimbreSpace(); }
     TimbreSpacePointSelector &getTimbreSpacePointSelector() const { return _tsnGranularSynth->getTimbreSpacePointSelector(); }
@@ -50,8 +56,8 @@ public:
 		return _tsnGranularSynth;
 	}
 	//==============================================================================
-	void saveAnalysisToFile(const juce::String& filePath, std::function<void(bool)> resultCallback) const;
-	void writeEvents();
+	void saveAnalysisToFile(const juce::String& filePath, std::function<void(bool)> resultCallback);	// asynchronous; callback on message thread
+	void writeEvents();	// asynchronous; progress and completion through getEventExporter()
 	//==============================================================================
 protected:
     // SlicerGranularAudioProcessor
@@ -60,10 +66,16 @@ private:
 	TSNGranularAudioProcessor();
 	//==============================================================================
 	ThreadedAnalyzer _analyzer;
+	juce::SharedResourcePointer<nvs::analysis::AnalysisExecutor> _analysisExecutor;	// the same pool every instance uses
+	nvs::analysis::AnalysisFileWorker _analysisFileWorker;
+	nvs::analysis::EventExporter _eventExporter;
+	unsigned int _analysisLoadGeneration {0};	// message thread only; lets superseded loads be ignored
     TSNGranularSynth * _tsnGranularSynth {nullptr};    // gets initialized from subclass's _granularSynth unique_ptr
 	//==============================================================================
 	void ensureSettingsStructure();
-	bool loadAnalysisFileFromState();
+	std::vector<nvs::analysis::Feature_e> getFeaturesInUse() const;	// axes and filter
+	bool loadAnalysisFileFromState(std::function<void(bool)> onLoaded);	// false if nothing could be queued
+	bool applyLoadedAnalysisTree(const juce::ValueTree &analysisFileValueTree);
 	//==============================================================================
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TSNGranularAudioProcessor)
 };
@@ -0,0 +1,45 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+#pragma once
+#include "StringAxiom.h"
+
+// tsn-granular-only additions to nvs::axiom. StringAxiom.h is shared with slicer_granular, so strings that only
+// this plugin needs live here instead.
+namespace nvs::axiom {
+
+// analysis settings: feature storage
+inline constexpr auto featureStorage        = "featureStorage";
+inline constexpr auto float32               = "float32";
+inline constexpr auto int16                 = "int16";
+inline constexpr auto int8                  = "int8";
+
+// view settings: a sibling of Settings rather than a branch of it, so that the analysis settings hash (which keys
+// analysis caches and saved analyses) leaves them out
+inline constexpr auto ViewSettings          = "ViewSettings";
+// view settings: near-duplicate points collapsed before triangulation
+inline constexpr auto duplicateTolerance    = "duplicateTolerance";
+// view settings: features computed only as they are needed
+inline constexpr auto lazyFeatures          = "lazyFeatures";
+
+// analysis settings: segmentation by timbre change
+inline constexpr auto Bic                   = "BIC";
+
+// analysis settings: silence gate for uniform segmentation
+inline constexpr auto silenceGate           = "silenceGate";
+inline constexpr auto silenceGateThreshold  = "silenceGateThreshold";
+inline constexpr auto silenceGateHangover   = "silenceGateHangover";
+
+// analysis tree: quantized feature columns
+inline constexpr auto QuantizedMeasurements = "QuantizedMeasurements";
+inline constexpr auto QuantizedColumn       = "QuantizedColumn";
+inline constexpr auto quantBits             = "quantBits";
+inline constexpr auto quantNumEvents        = "quantNumEvents";
+inline constexpr auto quantFeature          = "quantFeature";
+inline constexpr auto quantStatistic        = "quantStatistic";
+inline constexpr auto quantScale            = "quantScale";
+inline constexpr auto quantOffset           = "quantOffset";
+inline constexpr auto quantData             = "quantData";
+
+}   // namespace nvs::axiom
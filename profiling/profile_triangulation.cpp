@@ -50,8 +50,32 @@ std::vector<Timbre5DPoint> generateRandomTargets(size_t numTargets, std::mt19937
     return targets;
 }
 
-// Build Delaunator triangulation from database
-delaunator::Delaunator buildTriangulation(const std::vector<Timbre5DPoint>& database) {
+// Generate random target points outside the database's [-1, 1] square, so outside its hull
+std::vector<Timbre5DPoint> generateOutsideTargets(size_t numTargets, std::mt19937& rng) {
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> radius(1.5f, 3.0f);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<Timbre5DPoint> targets;
+    targets.reserve(numTargets);
+
+    for (size_t i = 0; i < numTargets; ++i) {
+        const float a = angle(rng);
+        const float r = radius(rng);
+        Timbre5DPoint pt;
+        pt[0] = r * std::cos(a);
+        pt[1] = r * std::sin(a);
+        pt[2] = dist(rng);
+        pt[3] = dist(rng);
+        pt[4] = dist(rng);
+        targets.push_back(pt);
+    }
+
+    return targets;
+}
+
+// Build triangulation from database
+Triangulation buildTriangulation(const std::vector<Timbre5DPoint>& database) {
     std::vector<double> coords;
     coords.reserve(database.size() * 2);
 
@@ -61,7 +85,7 @@ delaunator::Delaunator buildTriangulation(const std::vector<Timbre5DPoint>& data
         coords.push_back(pt2d.y());
     }
 
-    return delaunator::Delaunator(coords);
+    return Triangulation(delaunator::Delaunator(coords));
 }
 
 struct BenchmarkResult {
@@ -76,7 +100,11 @@ struct BenchmarkResult {
 BenchmarkResult runBenchmark(const std::string& name,
                              const std::vector<Timbre5DPoint>& database,
                              const std::vector<Timbre5DPoint>& targets,
-                             const size_t startTriangle) {
+                             const size_t startTriangle,
+                             const bool useGrid = false,
+                             const bool useBarycentric = false,
+                             const bool useHilbert = false,
+                             const bool useHull = false) {
 
     std::cout << "Running benchmark: " << name << " (DB size: " << database.size()
               << ", Queries: " << targets.size() << ")" << std::endl;
@@ -89,10 +117,50 @@ BenchmarkResult runBenchmark(const std::string& name,
 
     std::cout << "  Triangulation build time: " << triTime << " ms" << std::endl;
 
+    // the walk indexes the database by vertex, so it follows the renumbering
+    std::vector<Timbre5DPoint> renumberedDatabase;
+    size_t walkStart = startTriangle;
+    if (useHilbert) {
+        const auto start = TrianglePoints::create(d, startTriangle);
+        auto renumberStart = high_resolution_clock::now();
+        const auto order = d.renumberAlongHilbertCurve();
+        renumberedDatabase.reserve(order.size());
+        for (const size_t i : order) {
+            renumberedDatabase.push_back(database[i]);
+        }
+        auto renumberEnd = high_resolution_clock::now();
+        std::cout << "  Hilbert renumbering time: " << duration_cast<microseconds>(renumberEnd - renumberStart).count() / 1000.0 << " ms" << std::endl;
+        // start from the same place as before renumbering, so that only the memory layout differs
+        const Timbre2DPoint startCentroid = (start->p0 + start->p1 + start->p2) / 3.f;
+        walkStart = straightWalk(d, startCentroid, 0).value_or(0);
+    }
+    const auto &db = useHilbert ? renumberedDatabase : database;
+
+    std::optional<TriangleGrid> grid;
+    if (useGrid) {
+        auto gridStart = high_resolution_clock::now();
+        grid.emplace(d);
+        auto gridEnd = high_resolution_clock::now();
+        std::cout << "  Grid build time: " << duration_cast<microseconds>(gridEnd - gridStart).count() / 1000.0 << " ms" << std::endl;
+    }
+    const TriangleGrid *gridPtr = grid ? &*grid : nullptr;
+
+    std::optional<BarycentricTransforms> barycentric;
+    if (useBarycentric) {
+        barycentric.emplace(d);
+    }
+    const BarycentricTransforms *barycentricPtr = barycentric ? &*barycentric : nullptr;
+
+    std::optional<HullIndex> hull;
+    if (useHull) {
+        hull.emplace(d);
+    }
+    const HullIndex *hullPtr = hull ? &*hull : nullptr;
+
     // Warm up
-    size_t startTriangleInternal = startTriangle;
+    size_t startTriangleInternal = walkStart;
     for (size_t i = 0; i < std::min(targets.size(), size_t(10)); ++i) {
-        auto result = findPointsTriangulationBased(targets[i], database, d, &startTriangleInternal);
+        auto result = findPointsTriangulationBased(targets[i], db, d, &startTriangleInternal, gridPtr, barycentricPtr, hullPtr);
     }
 
     // Actual benchmark
@@ -100,9 +168,9 @@ BenchmarkResult runBenchmark(const std::string& name,
     queryTimes.reserve(targets.size());
 
     for (const auto& target : targets) {
-        startTriangleInternal = startTriangle;
+        startTriangleInternal = walkStart;
         auto start = high_resolution_clock::now();
-        auto result = findPointsTriangulationBased(target, database, d, &startTriangleInternal);
+        auto result = findPointsTriangulationBased(target, db, d, &startTriangleInternal, gridPtr, barycentricPtr, hullPtr);
         auto end = high_resolution_clock::now();
 
         auto duration = duration_cast<nanoseconds>(end - start).count();
@@ -136,16 +204,16 @@ BenchmarkResult runBenchmark(const std::string& name,
 void printResults(const std::vector<BenchmarkResult>& results) {
     std::cout << "\n=== Benchmark Results ===" << std::endl;
     std::cout << std::fixed << std::setprecision(6);
-    std::cout << std::setw(30) << "Test Name"
+    std::cout << std::setw(34) << "Test Name"
               << std::setw(12) << "DB Size"
               << std::setw(12) << "Queries"
               << std::setw(15) << "Avg (ms)"
               << std::setw(15) << "Min (ms)"
               << std::setw(15) << "Max (ms)" << std::endl;
-    std::cout << std::string(99, '-') << std::endl;
+    std::cout << std::string(103, '-') << std::endl;
 
     for (const auto& r : results) {
-        std::cout << std::setw(30) << r.name
+        std::cout << std::setw(34) << r.name
                   << std::setw(12) << r.dbSize
                   << std::setw(12) << r.numQueries
                   << std::setw(15) << r.avgTimeMs
@@ -180,6 +248,15 @@ int main() {
         std::string testName = "DB_" + std::to_string(dbSize);
         auto result = runBenchmark(testName, database, targets, startTriangle);
         results.push_back(result);
+        results.push_back(runBenchmark(testName + "_grid", database, targets, startTriangle, true));
+        results.push_back(runBenchmark(testName + "_grid_barycentric", database, targets, startTriangle, true, true));
+        // before/after: the same walks over the triangulation renumbered along a Hilbert curve
+        results.push_back(runBenchmark(testName + "_hilbert", database, targets, startTriangle, false, false, true));
+        results.push_back(runBenchmark(testName + "_grid_barycentric_hilbert", database, targets, startTriangle, true, true, true));
+        // before/after for targets outside the hull: the nearest triangle by search, against the hull index
+        auto outsideTargets = generateOutsideTargets(numQueries, rng);
+        results.push_back(runBenchmark(testName + "_outside", database, outsideTargets, startTriangle, true, true));
+        results.push_back(runBenchmark(testName + "_outside_hull", database, outsideTargets, startTriangle, true, true, false, true));
     }
 
     printResults(results);
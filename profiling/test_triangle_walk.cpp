@@ -14,6 +14,7 @@
 #include "TimbreSpace/TimbreSpaceTriangulation.h"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <catch2/catch_approx.hpp>
 #include "catch2/catch_template_test_macros.hpp"
 
 using namespace nvs::timbrespace;
@@ -21,7 +22,7 @@ using Point2D = Timbre2DPoint;
 
 struct StraightWalk {
     static std::optional<size_t> walk(
-        const delaunator::Delaunator& d,
+        const Triangulation& d,
         const Point2D& p,
         size_t t)
     {
@@ -31,7 +32,7 @@ struct StraightWalk {
 
 struct HybridWalk {
     static std::optional<size_t> walk(
-        const delaunator::Delaunator& d,
+        const Triangulation& d,
         const Point2D& p,
         size_t t)
     {
@@ -48,7 +49,7 @@ TEMPLATE_TEST_CASE(
     REQUIRE(true);
 }
 
-delaunator::Delaunator buildDelaunator(const std::vector<Point2D>& points) {
+Triangulation buildDelaunator(const std::vector<Point2D>& points) {
     std::vector<double> coords;
     coords.reserve(points.size() * 2);
     for (const auto& p : points) {
@@ -56,7 +57,19 @@ delaunator::Delaunator buildDelaunator(const std::vector<Point2D>& points) {
         coords.push_back(p.y());
     }
 
-    return delaunator::Delaunator(coords);}
+    return Triangulation(delaunator::Delaunator(coords));}
+
+// count points spread uniformly over [-1, 1] x [-height, height]
+Triangulation randomTriangulation(const unsigned seed, const size_t count, const float height = 1.f) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<Point2D> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        points.emplace_back(dist(rng), height * dist(rng));
+    }
+    return buildDelaunator(points);
+}
 
 struct Test1Retval {
     size_t startTri;
@@ -742,4 +755,274 @@ TEST_CASE("rememberingStochasticWalk basic tests", "[stochasticWalk]") {
             }
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("clusterNearDuplicates", "[clusterNearDuplicates]") {
+    const std::vector<Timbre5DPoint> points {
+        Timbre5DPoint{0.101f, 0.101f, 0.5f, 0.5f, 0.5f},
+        Timbre5DPoint{0.900f, 0.100f, 0.5f, 0.5f, 0.5f},
+        Timbre5DPoint{0.103f, 0.104f, 0.5f, 0.5f, 0.5f},   // same cell as the first
+        Timbre5DPoint{0.102f, 0.102f, 0.9f, 0.5f, 0.5f},   // same 2D position, but far away in 5D
+    };
+
+    SECTION("zero tolerance keeps every point") {
+        const auto clusters = clusterNearDuplicates(points, 0.f);
+        REQUIRE(clusters.size() == points.size());
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            REQUIRE(clusters.members(c).size() == 1);
+            REQUIRE(clusters.members(c)[0] == c);
+        }
+    }
+    SECTION("points sharing a grid cell collapse to their centroid") {
+        const auto clusters = clusterNearDuplicates(points, 0.01f);
+        REQUIRE(clusters.size() == 3);
+        const auto first = clusters.members(0);
+        REQUIRE(std::vector(first.begin(), first.end()) == std::vector<size_t>{0, 2});
+        REQUIRE(clusters.centroids[0].x() == Catch::Approx(0.102f));
+        REQUIRE(clusters.members(1)[0] == 1);
+        REQUIRE(clusters.members(2)[0] == 3);
+        REQUIRE(clusters.memberIndices.size() == points.size());
+    }
+}
+TEST_CASE("IncrementalDelaunay matches a full rebuild", "[incrementalDelaunay]") {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<double> all;
+    for (size_t i = 0; i < 2 * 400; ++i) {
+        all.push_back(dist(rng));
+    }
+    // the triangles as sets of points, which is what two triangulations of the same points in general position share
+    const auto triangleSet = [](const Triangulation &t) {
+        std::set<std::array<double, 6>> out;
+        for (size_t i = 0; i < t.numTriangles(); ++i) {
+            std::array<std::pair<double, double>, 3> v;
+            for (size_t k = 0; k < 3; ++k) {
+                v[k] = {t.coords[2 * t.triangles[3 * i + k]], t.coords[2 * t.triangles[3 * i + k] + 1]};
+            }
+            std::ranges::sort(v);
+            out.insert({v[0].first, v[0].second, v[1].first, v[1].second, v[2].first, v[2].second});
+        }
+        return out;
+    };
+
+    IncrementalDelaunay incremental;
+    std::vector<size_t> vertexOfPoint(all.size() / 2, delaunator::INVALID_INDEX);
+    const auto pointOfVertex = incremental.rebuild(std::vector(all.begin(), all.begin() + 2 * 200));
+    for (size_t v = 0; v < pointOfVertex.size(); ++v) {
+        vertexOfPoint[pointOfVertex[v]] = v;
+    }
+    TriangleGrid grid(incremental.triangulation());
+    BarycentricTransforms barycentric(incremental.triangulation());
+    for (size_t start = 4; start <= 200; start += 4) {    // slide a window of 200 points along, 4 at a time
+        std::vector<size_t> removed;
+        for (size_t p = start - 4; p < start; ++p) {
+            removed.push_back(vertexOfPoint[p]);
+        }
+        const std::vector entering(all.begin() + 2 * (start + 196), all.begin() + 2 * (start + 200));
+        const Triangulation previous = incremental.triangulation();
+        const auto added = incremental.update(removed, entering);
+        REQUIRE(added.has_value());
+        REQUIRE(added->size() == 4);
+        for (size_t i = 0; i < added->size(); ++i) {
+            vertexOfPoint[start + 196 + i] = (*added)[i];
+        }
+        const auto &updated = incremental.triangulation();
+        for (size_t p = start; p < start + 200; ++p) {
+            REQUIRE(updated.coords[2 * vertexOfPoint[p]] == all[2 * p]);
+            REQUIRE(updated.coords[2 * vertexOfPoint[p] + 1] == all[2 * p + 1]);
+        }
+        const std::vector window(all.begin() + 2 * start, all.begin() + 2 * (start + 200));
+        const Triangulation rebuilt {delaunator::Delaunator(window)};
+        REQUIRE(triangleSet(updated) == triangleSet(rebuilt));
+
+        // the triangles not reported as changed are as they were, and the rest agree with their neighbors
+        const auto changed = incremental.changedTriangles();
+        for (size_t j = 0; j < updated.numTriangles(); ++j) {
+            if (std::ranges::binary_search(changed, j)) {
+                continue;
+            }
+            REQUIRE(j < previous.numTriangles());
+            for (size_t k = 0; k < 3; ++k) {
+                REQUIRE(updated.triangles[3 * j + k] == previous.triangles[3 * j + k]);
+                REQUIRE(updated.halfedges[3 * j + k] == previous.halfedges[3 * j + k]);
+            }
+        }
+        for (size_t e = 0; e < updated.halfedges.size(); ++e) {
+            if (const size_t twin = updated.halfedges[e]; twin != delaunator::INVALID_INDEX) {
+                REQUIRE(updated.halfedges[twin] == e);
+                REQUIRE(updated.triangles[twin] == updated.triangles[e % 3 == 2 ? e - 2 : e + 1]);
+            }
+        }
+        size_t hullLength = 0;
+        size_t v = updated.hull_start;
+        do {
+            v = updated.hull_next[v];
+            ++hullLength;
+        } while (v != updated.hull_start && hullLength <= window.size() / 2);
+        REQUIRE(hullLength == static_cast<size_t>(std::ranges::count(updated.halfedges, delaunator::INVALID_INDEX)));
+        if (!incremental.hullChanged()) {
+            REQUIRE(updated.hull_start == previous.hull_start);
+        }
+
+        // and what is built over it can be patched from the changed triangles alone
+        barycentric.update(updated, changed);
+        grid.update(updated, changed);
+        const BarycentricTransforms fresh(updated);
+        REQUIRE(barycentric.size() == updated.numTriangles());
+        for (size_t j = 0; j < updated.numTriangles(); ++j) {
+            const auto tri = TrianglePoints::create(updated, j);
+            const Point2D centroid = (tri->p0 + tri->p1 + tri->p2) / 3.f;
+            REQUIRE(barycentric.weights(j, centroid) == fresh.weights(j, centroid));
+            const auto near = grid.triangleNear(centroid);
+            REQUIRE(near.has_value());
+            REQUIRE(*near < updated.numTriangles());
+        }
+    }
+    // removing all but a couple of points leaves nothing to triangulate
+    std::vector<size_t> everything;
+    for (size_t p = 200; p < 400; ++p) {
+        everything.push_back(vertexOfPoint[p]);
+    }
+    REQUIRE_FALSE(incremental.update(everything, {}).has_value());
+    REQUIRE_FALSE(incremental.isValid());
+}
+TEST_CASE("TriangleGrid starts walks at the target", "[triangleGrid]") {
+    const auto d = randomTriangulation(11, 2000);
+    const TriangleGrid grid(d);
+
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<float> inner(-0.9f, 0.9f);
+    for (size_t i = 0; i < 500; ++i) {
+        const Point2D target(inner(rng), inner(rng));
+        const auto near = grid.triangleNear(target);
+        REQUIRE(near.has_value());
+        REQUIRE(*near < d.numTriangles());
+        // the cell is 2/256 wide, so the triangle it names is within a few triangles of the target
+        const auto found = straightWalk(d, target, *near);
+        REQUIRE(found.has_value());
+        const auto tri = TrianglePoints::create(d, *found);
+        REQUIRE(pointInTriangle(target, tri->p0, tri->p1, tri->p2));
+    }
+}
+TEST_CASE("BarycentricTransforms recover the weights a point was made from", "[barycentric]") {
+    const auto d = randomTriangulation(13, 300);
+    const BarycentricTransforms barycentric(d);
+    REQUIRE(barycentric.size() == d.numTriangles());
+
+    std::mt19937 rng(14);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (size_t t = 0; t < d.numTriangles(); ++t) {
+        const auto tri = TrianglePoints::create(d, t);
+        // a point inside, by weights of its own
+        float u = unit(rng), v = unit(rng);
+        if (u + v > 1.f) {
+            u = 1.f - u;
+            v = 1.f - v;
+        }
+        const Point2D inside = tri->p0 + u * (tri->p1 - tri->p0) + v * (tri->p2 - tri->p0);
+
+        REQUIRE(barycentric.contains(t, inside) == pointInTriangle(inside, tri->p0, tri->p1, tri->p2));
+        const std::array<float, 3> expected {1.f - u - v, u, v};
+        const auto weights = barycentric.weights(t, inside);
+        for (size_t k = 0; k < 3; ++k) {
+            REQUIRE(weights[k] == Catch::Approx(expected[k]).margin(1e-3));
+        }
+        // and one outside, beyond the first vertex
+        const Point2D outside = tri->p0 + 0.1f * (tri->p0 - tri->p1) + 0.1f * (tri->p0 - tri->p2);
+        REQUIRE_FALSE(barycentric.contains(t, outside));
+    }
+}
+TEST_CASE("Hilbert renumbering keeps the triangulation intact", "[hilbert]") {
+    const auto original = randomTriangulation(17, 1000);
+    auto renumbered = original;
+    const auto order = renumbered.renumberAlongHilbertCurve();
+
+    REQUIRE(order.size() == original.numVertices());
+    REQUIRE(renumbered.numTriangles() == original.numTriangles());
+    for (size_t v = 0; v < order.size(); ++v) {
+        REQUIRE(renumbered.coords[2 * v] == original.coords[2 * order[v]]);
+        REQUIRE(renumbered.coords[2 * v + 1] == original.coords[2 * order[v] + 1]);
+    }
+    const auto next = [](const size_t e) { return e % 3 == 2 ? e - 2 : e + 1; };
+    size_t hullEdges = 0;
+    for (size_t e = 0; e < renumbered.halfedges.size(); ++e) {
+        const size_t twin = renumbered.halfedges[e];
+        if (twin == delaunator::INVALID_INDEX) {
+            ++hullEdges;
+            // a hull edge runs from a hull vertex to the next one along the hull
+            REQUIRE(renumbered.hull_next[renumbered.triangles[e]] == renumbered.triangles[next(e)]);
+            continue;
+        }
+        REQUIRE(renumbered.halfedges[twin] == e);
+        REQUIRE(renumbered.triangles[twin] == renumbered.triangles[next(e)]);
+        REQUIRE(renumbered.triangles[next(twin)] == renumbered.triangles[e]);
+    }
+    size_t hullLength = 0;
+    size_t v = renumbered.hull_start;
+    do {
+        REQUIRE(renumbered.hull_prev[renumbered.hull_next[v]] == v);
+        v = renumbered.hull_next[v];
+        ++hullLength;
+    } while (v != renumbered.hull_start && hullLength <= order.size());
+    REQUIRE(hullLength == hullEdges);
+
+    // consecutive triangles now lie next to each other, where construction order scattered them
+    const auto meanStep = [](const Triangulation &t) {
+        const auto centroidOf = [&t](const size_t i) {
+            const auto tri = TrianglePoints::create(t, i);
+            return Point2D((tri->p0 + tri->p1 + tri->p2) / 3.f);
+        };
+        double total = 0.0;
+        Point2D previous = centroidOf(0);
+        for (size_t i = 1; i < t.numTriangles(); ++i) {
+            const Point2D centroid = centroidOf(i);
+            total += (centroid - previous).norm();
+            previous = centroid;
+        }
+        return total / static_cast<double>(t.numTriangles() - 1);
+    };
+    REQUIRE(meanStep(renumbered) < 0.5 * meanStep(original));
+}
+TEST_CASE("HullIndex projects outside targets onto the nearest hull edge", "[hullIndex]") {
+    std::mt19937 rng(19);
+    // a thin spread as well as a round one, for sharp hull corners that the ray from the center misses the nearest edge at
+    for (const float height : {1.0f, 0.05f}) {
+        const auto d = randomTriangulation(rng(), 500, height);
+        const HullIndex hull(d);
+        REQUIRE_FALSE(hull.empty());
+        REQUIRE(hull.size() == static_cast<size_t>(std::ranges::count(d.halfedges, delaunator::INVALID_INDEX)));
+
+        // the nearest point on the hull, by trying every hull edge
+        const auto nearestOnHull = [&d](const Point2D &p) {
+            float best = std::numeric_limits<float>::max();
+            for (size_t e = 0; e < d.halfedges.size(); ++e) {
+                if (d.halfedges[e] != delaunator::INVALID_INDEX) {
+                    continue;
+                }
+                const Point2D a = getPointFromVertex(d, d.triangles[e]);
+                const Point2D b = getPointFromVertex(d, d.triangles[e % 3 == 2 ? e - 2 : e + 1]);
+                const float s = std::clamp((p - a).dot(b - a) / (b - a).squaredNorm(), 0.f, 1.f);
+                best = std::min(best, (a + s * (b - a) - p).norm());
+            }
+            return best;
+        };
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        std::uniform_real_distribution<float> radius(1.5f, 4.0f);
+        for (size_t i = 0; i < 500; ++i) {
+            const float a = angle(rng), r = radius(rng);
+            const Point2D target(r * std::cos(a), r * std::sin(a));
+            const auto projection = hull.project(target);
+            REQUIRE(projection.has_value());
+            REQUIRE(projection->triangle < d.numTriangles());
+
+            Point2D projected(0.f, 0.f);
+            float total = 0.f;
+            for (size_t k = 0; k < 3; ++k) {
+                REQUIRE(projection->weights[k] >= 0.f);
+                total += projection->weights[k];
+                projected += projection->weights[k] * getPointFromVertex(d, d.triangles[3 * projection->triangle + k]);
+            }
+            REQUIRE(total == Catch::Approx(1.f).margin(1e-5));
+            REQUIRE((projected - target).norm() == Catch::Approx(nearestOnHull(target)).margin(1e-4));
+        }
+    }
+}
@@ -0,0 +1,218 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+// tsn-analysis-worker: child process that runs analysis on behalf of a plugin instance. see Analysis/RemoteAnalysis.h.
+
+#include <JuceHeader.h>
+#include "Analysis/ThreadedAnalyzer.h"
+#include "Analysis/AnalysisExecutor.h"
+#include "Analysis/RemoteAnalysis.h"
+#include "StringAxiom.h"
+#include "misc_util_juce.h"
+
+namespace {
+
+using namespace nvs::analysis;
+
+juce::File getCacheDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("tsn-granular")
+        .getChildFile("AnalysisCache");
+}
+
+/**
+ * Wraps an ordinary ThreadedAnalyzer. Requests arrive on the connection thread and are forwarded to the message thread,
+ * where results are polled and sent back tagged with the host's generation. Completed analyses are also written to an
+ * on-disk cache keyed by audio and settings hash, which every worker on the machine (i.e. every DAW process) consults
+ * before analysing.
+ */
+class AnalysisWorkerProcess final : public juce::ChildProcessWorker
+,                                   private juce::ChangeListener
+,                                   private juce::Timer
+{
+public:
+    AnalysisWorkerProcess() {
+        _analyzer.setUseOutOfProcessWorker(false);
+        _analyzer.addChangeListener(this);
+        // isolated from the host's audio threads, so the whole machine is fair game
+        _executor->setWorkerPriority(juce::Thread::Priority::normal);
+        _executor->setCoreBudget(juce::SystemStats::getNumCpus());
+    }
+    ~AnalysisWorkerProcess() override {
+        stopTimer();
+        _analyzer.removeChangeListener(this);
+    }
+
+    void handleMessageFromCoordinator(const juce::MemoryBlock &block) override {
+        auto message = remote::decode(block);
+        juce::MessageManager::callAsync([safeThis = juce::WeakReference<AnalysisWorkerProcess>(this), message] {
+            if (safeThis != nullptr) {
+                safeThis->handleMessage(message);
+            }
+        });
+    }
+    void handleConnectionLost() override {
+        juce::JUCEApplicationBase::quit();
+    }
+private:
+    void handleMessage(const juce::ValueTree &message) {
+        if (remote::isCancelRequest(message)) {
+            if (_active && remote::getGeneration(message) == _hostGeneration) {
+                _analyzer.stopAnalysis();
+                finish();
+            }
+        }
+        else if (const auto request = remote::readAnalysisRequest(message)) {
+            start(*request);
+        }
+    }
+
+    void start(const remote::AnalysisRequest &request) {
+        if (_active) {
+            _analyzer.stopAnalysis();
+            finish();
+        }
+        _hostGeneration = request.generation;
+        _audioFileAbsPath = request.audioFileAbsPath;
+        _active = true;
+        _onsetMessage = {};
+
+        const juce::MemoryMappedFile mapped(request.waveFile, juce::MemoryMappedFile::readOnly);
+        if (mapped.getData() == nullptr || mapped.getSize() < request.numSamples * sizeof(float)) {
+            finish("could not map audio from " + request.waveFile.getFullPathName());
+            return;
+        }
+        const auto *samples = static_cast<const float *>(mapped.getData());
+        const vecReal wave(samples, samples + request.numSamples);
+
+        auto tree = request.settingsAndFileInfo;
+        auto settingsTree = tree.getChildWithName(nvs::axiom::Settings);
+        if (!settingsTree.isValid() || !verifySettingsStructureWithAttemptedFix(settingsTree)) {
+            finish("invalid settings");
+            return;
+        }
+        _cacheFile = getCacheDirectory().getChildFile(juce::File::createLegalFileName(
+            nvs::util::hashAudioData(wave) + "-" + nvs::util::hashValueTree(settingsTree) + ".tsnc"));
+        if (sendFromCache()) {
+            return;
+        }
+        if (!_analyzer.requestAnalysis(wave, request.audioFileAbsPath, settingsTree)) {
+            finish("analysis request rejected");
+            return;
+        }
+        startTimerHz(10);
+    }
+
+    bool sendFromCache() {
+        if (!_cacheFile.existsAsFile()) {
+            return false;
+        }
+        juce::FileInputStream in(_cacheFile);
+        auto entry = juce::ValueTree::readFromStream(in);
+        if (entry.getNumChildren() != 2) {
+            _cacheFile.deleteFile();
+            return false;
+        }
+        for (auto child : entry) {
+            auto message = child.createCopy();
+            remote::setGeneration(message, _hostGeneration);
+            remote::setAudioFileAbsPath(message, _audioFileAbsPath);   // same audio may live at another path for this host
+            sendMessageToCoordinator(remote::encode(message));
+        }
+        finish();
+        return true;
+    }
+    void writeCache(const juce::ValueTree &timbreMessage) const {
+        if (!_onsetMessage.isValid()) {
+            return;
+        }
+        juce::ValueTree entry("CacheEntry");
+        entry.appendChild(_onsetMessage.createCopy(), nullptr);
+        entry.appendChild(timbreMessage.createCopy(), nullptr);
+        // write-then-rename, so another process never reads a half-written entry
+        if (getCacheDirectory().createDirectory().wasOk()) {
+            const juce::TemporaryFile tmp(_cacheFile);
+            if (juce::FileOutputStream out(tmp.getFile()); out.openedOk()) {
+                entry.writeToStream(out);
+                out.flush();
+            }
+            tmp.overwriteTargetFileWithTemporary();
+        }
+    }
+
+    void poll() {
+        if (!_active) {
+            return;
+        }
+        // sample idleness before looking for results, so a job finishing between the two checks can't lose its result
+        const bool wasIdle = _analyzer.isIdle();
+        if (!_onsetMessage.isValid()) {
+            if (const auto onsets = _analyzer.shareOnsetAnalysis()) {
+                auto tagged = *onsets;
+                tagged.generation = _hostGeneration;
+                _onsetMessage = remote::makeOnsetResult(tagged);
+                sendMessageToCoordinator(remote::encode(_onsetMessage));
+            }
+        }
+        if (auto timbre = _analyzer.stealTimbreSpaceRepresentation()) {
+            timbre->generation = _hostGeneration;
+            const auto message = remote::makeTimbreResult(*timbre);
+            sendMessageToCoordinator(remote::encode(message));
+            writeCache(message);
+            finish();
+            return;
+        }
+        if (wasIdle) {
+            finish();   // zero onsets, or the analysis threw: nothing more is coming
+            return;
+        }
+        sendMessageToCoordinator(remote::encode(remote::makeProgress(_hostGeneration, _analyzer.getStatus().sample())));
+    }
+    void finish(const juce::String &error = {}) {
+        stopTimer();
+        _active = false;
+        sendMessageToCoordinator(remote::encode(remote::makeFinished(_hostGeneration, error)));
+    }
+
+    void changeListenerCallback(juce::ChangeBroadcaster *) override { poll(); }
+    void timerCallback() override { poll(); }
+
+    juce::SharedResourcePointer<AnalysisExecutor> _executor;
+    ThreadedAnalyzer _analyzer;
+    std::uint64_t _hostGeneration {0};
+    juce::String _audioFileAbsPath {};
+    bool _active {false};
+    juce::ValueTree _onsetMessage {};
+    juce::File _cacheFile {};
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(AnalysisWorkerProcess)
+};
+
+class AnalysisWorkerApplication final : public juce::JUCEApplication {
+public:
+    const juce::String getApplicationName() override { return "tsn-analysis-worker"; }
+    const juce::String getApplicationVersion() override { return JUCE_APPLICATION_VERSION_STRING; }
+    bool moreThanOneInstanceAllowed() override { return true; }
+
+    void initialise(const juce::String &commandLine) override {
+        auto worker = std::make_unique<AnalysisWorkerProcess>();
+        if (!worker->initialiseFromCommandLine(commandLine, nvs::analysis::remote::commandLineUID)) {
+            // not launched by a plugin
+            std::cerr << "tsn-analysis-worker is started by the tsn-granular plugin; it is not meant to be run directly\n";
+            setApplicationReturnValue(1);
+            quit();
+            return;
+        }
+        _worker = std::move(worker);
+    }
+    void shutdown() override {
+        _worker.reset();
+    }
+private:
+    std::unique_ptr<AnalysisWorkerProcess> _worker;
+};
+
+}   // anonymous namespace
+
+START_JUCE_APPLICATION(AnalysisWorkerApplication)
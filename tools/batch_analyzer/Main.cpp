@@ -0,0 +1,414 @@
+//
+// Created by Nicholas Solem on 10/18/26.
+//
+
+// tsn-batch-analyze: analyses every audio file under a directory, without a plugin instance, and writes one .tsb
+// analysis file per sample (the same format the plugin saves and loads through FileInfo.analysisFile).
+
+#include <JuceHeader.h>
+#include "Analysis/Analyzer.h"
+#include "Analysis/AnalysisExecutor.h"
+#include "Analysis/AnalysisFileFormat.h"
+#include "Analysis/OnsetAnalysis/OnsetProcessing.h"
+#include "StringAxiom.h"
+#include "misc_util_juce.h"
+
+namespace {
+
+using namespace nvs::analysis;
+
+constexpr const char *usage =
+R"(usage: tsn-batch-analyze <input directory> <output directory> [options]
+
+Analyses every audio file under the input directory, writing <output directory>/<relative path>.tsb for each.
+
+options:
+  -j N                      number of files analysed at once (default: 1)
+  -t N                      analysis threads per file (default: physical cores / files at once)
+  --settings=FILE           plugin state or Settings tree (XML) to take the analysis settings from
+  --force                   re-analyse files whose analysis is already up to date
+  --report=FILE             per-file timing report (default: <output directory>/tsn-batch-report.csv)
+)";
+
+struct Options {
+    juce::File inputDir;
+    juce::File outputDir;
+    int concurrentFiles {1};
+    int threadsPerFile {0};
+    juce::File settingsFile {};
+    bool force {false};
+    juce::File reportFile {};
+};
+
+std::optional<Options> parseOptions(const juce::ArgumentList &args) {
+    Options options;
+    juce::StringArray positional;
+    for (int i = 0; i < args.size(); ++i) {
+        if (args[i].isShortOption('j') || args[i].isShortOption('t')) {
+            ++i;    // skip the option's value
+        }
+        else if (!args[i].isOption()) {
+            positional.add(args[i].text);
+        }
+    }
+    if (positional.size() != 2) {
+        return std::nullopt;
+    }
+    options.inputDir = juce::File::getCurrentWorkingDirectory().getChildFile(positional[0]);
+    options.outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(positional[1]);
+    if (args.containsOption("-j")) {
+        options.concurrentFiles = std::max(1, args.getValueForOption("-j").getIntValue());
+    }
+    options.threadsPerFile = args.containsOption("-t")
+        ? std::max(1, args.getValueForOption("-t").getIntValue())
+        : std::max(1, juce::SystemStats::getNumPhysicalCpus() / options.concurrentFiles);
+    if (args.containsOption("--settings")) {
+        options.settingsFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--settings"));
+    }
+    options.force = args.containsOption("--force");
+    options.reportFile = args.containsOption("--report")
+        ? juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--report"))
+        : options.outputDir.getChildFile("tsn-batch-report.csv");
+    return options;
+}
+
+// a root holding Settings and FileInfo, as the plugin state does; FileInfo gets each file's sample rate
+std::optional<juce::ValueTree> loadSettings(const juce::File &settingsFile) {
+    juce::ValueTree root("TsnBatchAnalysis");
+    juce::ValueTree settings(nvs::axiom::Settings);
+    if (settingsFile != juce::File{}) {
+        const auto xml = juce::parseXML(settingsFile);
+        if (xml == nullptr) {
+            std::cerr << "could not parse " << settingsFile.getFullPathName() << "\n";
+            return std::nullopt;
+        }
+        const auto loaded = juce::ValueTree::fromXml(*xml);
+        settings = loaded.hasType(nvs::axiom::Settings) ? loaded : loaded.getChildWithName(nvs::axiom::Settings);
+        if (!settings.isValid()) {
+            std::cerr << settingsFile.getFullPathName() << " contains no " << nvs::axiom::Settings << " tree\n";
+            return std::nullopt;
+        }
+        settings = settings.createCopy();
+    }
+    else {
+        initializeSettingsBranches(settings, false);
+    }
+    root.appendChild(settings, nullptr);
+    root.appendChild(juce::ValueTree(nvs::axiom::FileInfo).setProperty(nvs::axiom::sampleRate, 44100.0, nullptr), nullptr);
+    if (!verifySettingsStructureWithAttemptedFix(settings)) {
+        std::cerr << "invalid analysis settings\n";
+        return std::nullopt;
+    }
+    return root;
+}
+
+//=============================================================================================================================
+struct FileReport {
+    enum class Status { Analysed, UpToDate, NoOnsets, Failed, Cancelled };
+    juce::File source;
+    Status status {Status::Failed};
+    double audioSeconds {0.0};
+    size_t numEvents {0};
+    double readSeconds {0.0};
+    double onsetSeconds {0.0};
+    double timbreSeconds {0.0};
+    double writeSeconds {0.0};
+    double totalSeconds {0.0};
+    juce::String message {};
+
+    static const char *toString(const Status s) {
+        switch (s) {
+            case Status::Analysed:  return "analysed";
+            case Status::UpToDate:  return "up-to-date";
+            case Status::NoOnsets:  return "no-onsets";
+            case Status::Cancelled: return "cancelled";
+            case Status::Failed:
+            default:                return "failed";
+        }
+    }
+    static juce::String csvHeader() {
+        return "file,status,audio_s,events,read_s,onsets_s,timbre_s,write_s,total_s,message";
+    }
+    juce::String toCsvRow(const juce::File &inputDir) const {
+        const auto quoted = [](const juce::String &s){ return s.replace("\"", "\"\"").quoted(); };
+        juce::StringArray cols {
+            quoted(source.getRelativePathFrom(inputDir)), toString(status), juce::String(audioSeconds, 3),
+            juce::String(static_cast<juce::int64>(numEvents)), juce::String(readSeconds, 3), juce::String(onsetSeconds, 3),
+            juce::String(timbreSeconds, 3), juce::String(writeSeconds, 3), juce::String(totalSeconds, 3), quoted(message)
+        };
+        return cols.joinIntoString(",");
+    }
+};
+
+class Stopwatch {
+public:
+    double lap() {
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto elapsed = (now - _last) * 0.001;
+        _last = now;
+        return elapsed;
+    }
+private:
+    double _last {juce::Time::getMillisecondCounterHiRes()};
+};
+
+/**
+ * Shared by every file job: the settings, parsed once, and the report, written row by row as files finish so that an
+ * interrupted run still leaves a usable report behind.
+ */
+class BatchContext {
+public:
+    BatchContext(const Options &options, const juce::ValueTree &settingsRoot)
+    :   options(options)
+    {
+        auto settingsTree = settingsRoot.getChildWithName(nvs::axiom::Settings);
+        settingsHash = nvs::util::hashValueTree(settingsTree);
+        updateSettingsFromValueTree(settings, settingsTree);
+        settings.analysis.numThreads = options.threadsPerFile;
+        formatManager.registerBasicFormats();
+    }
+    bool openReport() {
+        options.reportFile.getParentDirectory().createDirectory();
+        options.reportFile.deleteFile();
+        _report = options.reportFile.createOutputStream();
+        if (_report == nullptr) {
+            return false;
+        }
+        _report->writeText(FileReport::csvHeader() + "\n", false, false, nullptr);
+        _report->flush();
+        return true;
+    }
+    void submit(const FileReport &report) {
+        const std::scoped_lock sl(_reportMutex);
+        ++_numFinished;
+        ++_statusCounts[report.status];
+        _report->writeText(report.toCsvRow(options.inputDir) + "\n", false, false, nullptr);
+        _report->flush();
+        std::cout << "[" << _numFinished << "/" << numFiles << "] " << report.source.getRelativePathFrom(options.inputDir)
+                  << ": " << FileReport::toString(report.status) << " (" << juce::String(report.totalSeconds, 2) << " s)";
+        if (report.message.isNotEmpty()) {
+            std::cout << ": " << report.message;
+        }
+        std::cout << std::endl;
+    }
+    int getCount(const FileReport::Status status) const {
+        const std::scoped_lock sl(_reportMutex);
+        const auto it = _statusCounts.find(status);
+        return it == _statusCounts.end() ? 0 : it->second;
+    }
+
+    const Options options;
+    juce::String settingsHash;
+    AnalyzerSettings settings;
+    juce::AudioFormatManager formatManager;
+    int numFiles {0};
+private:
+    mutable std::mutex _reportMutex;
+    std::unique_ptr<juce::FileOutputStream> _report;
+    int _numFinished {0};
+    std::map<FileReport::Status, int> _statusCounts;
+};
+
+//=============================================================================================================================
+class AnalyseFileJob final : public juce::ThreadPoolJob {
+public:
+    AnalyseFileJob(BatchContext &context, juce::File source)
+    :   juce::ThreadPoolJob("analyse " + source.getFileName())
+    ,   _context(context)
+    ,   _source(std::move(source))
+    // keep the audio file's extension, so that e.g. kick.wav and kick.aif don't share an analysis file
+    ,   _target(_context.options.outputDir.getChildFile(_source.getRelativePathFrom(_context.options.inputDir) + ".tsb"))
+    {}
+
+    JobStatus runJob() override {
+        FileReport report { .source = _source };
+        Stopwatch total;
+        try {
+            analyse(report);
+        } catch (const std::exception &e) {
+            report.status = FileReport::Status::Failed;
+            report.message = e.what();
+        } catch (...) {
+            report.status = FileReport::Status::Failed;
+            report.message = "unknown exception";
+        }
+        report.totalSeconds = total.lap();
+        _context.submit(report);
+        return jobHasFinished;
+    }
+private:
+    // resuming: an existing analysis is kept if it is newer than its audio and was made with the same settings
+    bool isUpToDate() const {
+        if (_context.options.force || !_target.existsAsFile()
+            || _target.getLastModificationTime() < _source.getLastModificationTime())
+        {
+            return false;
+        }
+        juce::FileInputStream in(_target);
+        if (!in.openedOk()) {
+            return false;
+        }
+        const auto md = getAnalysisFileMetadata(juce::ValueTree::readFromStream(in));
+        return md.isValid() && md.getProperty(nvs::axiom::settingsHash).toString() == _context.settingsHash;
+    }
+
+    void analyse(FileReport &report) {
+        if (isUpToDate()) {
+            report.status = FileReport::Status::UpToDate;
+            return;
+        }
+        Stopwatch sw;
+        const std::unique_ptr<juce::AudioFormatReader> reader(_context.formatManager.createReaderFor(_source));
+        if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0) {
+            report.message = "unreadable or empty audio file";
+            return;
+        }
+        if (reader->lengthInSamples > std::numeric_limits<int>::max()) {
+            report.message = "audio file too long";
+            return;
+        }
+        // like the plugin, analyse the first channel
+        const auto numSamples = static_cast<int>(reader->lengthInSamples);
+        juce::AudioBuffer<float> buffer(1, numSamples);
+        reader->read(&buffer, 0, numSamples, 0, true, false);
+        const vecReal wave(buffer.getReadPointer(0), buffer.getReadPointer(0) + numSamples);
+        const auto sampleRate = reader->sampleRate;
+        report.audioSeconds = static_cast<double>(numSamples) / sampleRate;
+        const auto audioHash = nvs::util::hashAudioData(wave);
+        report.readSeconds = sw.lap();
+
+        auto settings = _context.settings;
+        settings.analysis.sampleRate = sampleRate;
+        settings.info.sampleFilePath = _source.getFullPathName();
+        Analyzer analyzer;
+        analyzer.applySettings(settings, _context.settingsHash);
+
+        RunLoopStatus rls;
+        const ShouldExitFn cancelled = [this]{ return shouldExit(); };
+
+        // the same onset post-processing as ThreadedAnalyzer::runJob, so files match what the plugin would produce
+        FeatureContainer<vecReal> frameTimbres;     // filled only by Bic segmentation
+        std::vector<size_t> silentEvents;           // only by Uniform segmentation with the silence gate on
+        const auto onsetsOpt = analyzer.calculateOnsetsInSeconds(wave, rls, cancelled, &frameTimbres, &silentEvents);
+        if (shouldExit()) {
+            report.status = FileReport::Status::Cancelled;
+            return;
+        }
+        if (!onsetsOpt.has_value() || onsetsOpt->empty()) {
+            report.status = FileReport::Status::NoOnsets;
+            return;
+        }
+        auto onsets = *onsetsOpt;
+        const auto lengthInSeconds = getLengthInSeconds(wave.size(), analyzer.getAnalyzedFileSampleRate());
+        filterOnsets(onsets, lengthInSeconds);
+        forceMinimumOnsets(onsets, 4, lengthInSeconds);
+        if (onsets.size() != onsetsOpt->size()) {
+            silentEvents.clear();
+        }
+        auto normalizedOnsets = onsets;
+        normalizeOnsets(normalizedOnsets, lengthInSeconds);
+        report.onsetSeconds = sw.lap();
+
+        const auto events = analyzer.splitIntoEvents(wave, onsets, silentEvents, rls, cancelled);
+        if (!events.has_value()) {
+            report.status = FileReport::Status::Cancelled;
+            return;
+        }
+        const auto timbreSpace = analyzer.calculateOnsetwiseTimbreSpace(wave, onsets, *events, rls, cancelled, allDescriptorGroups(),
+                                                                        frameTimbres.features[0].empty() ? nullptr : &frameTimbres);
+        if (!timbreSpace.has_value()) {
+            report.status = shouldExit() ? FileReport::Status::Cancelled : FileReport::Status::Failed;
+            return;
+        }
+        report.numEvents = timbreSpace->size();
+        report.timbreSeconds = sw.lap();
+
+        const auto tsTree = timbreSpaceReprToVT(*timbreSpace, normalizedOnsets, audioHash, _source.getFullPathName(),
+                                                settings.analysis.featureStorage);
+        const auto analysisVT = makeAnalysisFileTree(tsTree, {
+            .sampleFilePath = _source.getFullPathName(),
+            .sampleRate = sampleRate,
+            .audioHash = audioHash,
+            .settingsHash = _context.settingsHash
+        });
+        // write-then-rename: an interrupted run must not leave a truncated file that a resumed run would trust
+        if (!_target.getParentDirectory().createDirectory().wasOk()) {
+            report.message = "could not create " + _target.getParentDirectory().getFullPathName();
+            return;
+        }
+        const juce::TemporaryFile tmp(_target);
+        if (!nvs::util::saveValueTreeToBinary(analysisVT, tmp.getFile()) || !tmp.overwriteTargetFileWithTemporary()) {
+            report.message = "could not write " + _target.getFullPathName();
+            return;
+        }
+        report.writeSeconds = sw.lap();
+        report.status = FileReport::Status::Analysed;
+    }
+
+    BatchContext &_context;
+    const juce::File _source;
+    const juce::File _target;
+};
+
+}   // anonymous namespace
+
+//=============================================================================================================================
+int main(const int argc, char *argv[]) {
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const juce::ArgumentList args(argc, argv);
+    if (args.containsOption("--help|-h")) {
+        std::cout << usage;
+        return 0;
+    }
+    const auto options = parseOptions(args);
+    if (!options.has_value()) {
+        std::cerr << usage;
+        return 1;
+    }
+    if (!options->inputDir.isDirectory()) {
+        std::cerr << options->inputDir.getFullPathName() << " is not a directory\n";
+        return 1;
+    }
+    const auto settingsRoot = loadSettings(options->settingsFile);
+    if (!settingsRoot.has_value()) {
+        return 1;
+    }
+
+    BatchContext context(*options, *settingsRoot);
+    auto files = options->inputDir.findChildFiles(juce::File::findFiles, true,
+                                                  context.formatManager.getWildcardForAllFormats());
+    files.sort();
+    context.numFiles = files.size();
+    if (!context.openReport()) {
+        std::cerr << "could not write " << options->reportFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // every file's events go through the one process-wide executor: files at once x threads per file
+    const juce::SharedResourcePointer<AnalysisExecutor> executor;
+    executor->setWorkerPriority(juce::Thread::Priority::normal);
+    executor->setCoreBudget(options->concurrentFiles * options->threadsPerFile);
+    // hold the Essentia runtime for the whole run, rather than starting and stopping it with each file's Analyzer
+    const nvs::ess::EssentiaInitializer essentia;
+
+    std::cout << "analysing " << files.size() << " files, " << options->concurrentFiles << " at a time with "
+              << options->threadsPerFile << " threads each" << std::endl;
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    {
+        juce::ThreadPool pool(juce::ThreadPoolOptions{}
+            .withThreadName("tsn-batch-analyze")
+            .withNumberOfThreads(options->concurrentFiles));
+        for (const auto &f : files) {
+            pool.addJob(new AnalyseFileJob(context, f), true);
+        }
+        while (pool.getNumJobs() > 0) {
+            juce::Thread::sleep(100);
+        }
+    }
+    using Status = FileReport::Status;
+    std::cout << "done in " << juce::String((juce::Time::getMillisecondCounterHiRes() - start) * 0.001, 1) << " s: "
+              << context.getCount(Status::Analysed) << " analysed, " << context.getCount(Status::UpToDate) << " up to date, "
+              << context.getCount(Status::NoOnsets) << " without onsets, " << context.getCount(Status::Failed) << " failed\n"
+              << "report: " << options->reportFile.getFullPathName() << std::endl;
+    return context.getCount(Status::Failed) > 0 ? 2 : 0;
+}